@@ -0,0 +1,130 @@
+// Measures running a batch of commands one after the other using command_manager::run_command(),
+// compared to starting them all using command_manager::run_command_async() on a thread_pool.
+// The "wait" command blocks for a while, like a command waiting for I/O, and the "add" command
+// does almost nothing, which shows the overhead of scheduling a command.
+//
+// Usage: async_commands_benchmark [commands] [threads]
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ookii/subcommand.h>
+#include <ookii/thread_pool.h>
+
+class wait_command : public ookii::command
+{
+public:
+    wait_command(builder_type &builder)
+    {
+        builder.add_argument(_milliseconds, "Milliseconds").positional().required();
+    }
+
+    int run() override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{_milliseconds});
+        return 1;
+    }
+
+    static std::string name()
+    {
+        return "wait";
+    }
+
+private:
+    int _milliseconds{};
+};
+
+class add_command : public ookii::async_command
+{
+public:
+    add_command(builder_type &builder)
+    {
+        builder
+            .add_argument(_left, "Left").positional().required()
+            .add_argument(_right, "Right").positional().required();
+    }
+
+    ookii::task<int> run_async() override
+    {
+        co_return _left + _right;
+    }
+
+    static std::string name()
+    {
+        return "add";
+    }
+
+private:
+    int _left{};
+    int _right{};
+};
+
+template<typename RunFunc>
+void run(const char *name, long commands, RunFunc run_batch)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto total = run_batch();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (elapsed.count() * 1e6) / commands << " us/command (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long commands = 200;
+    size_t threads = 16;
+    if (argc > 1)
+    {
+        commands = std::stol(argv[1]);
+    }
+
+    if (argc > 2)
+    {
+        threads = std::stoul(argv[2]);
+    }
+
+    ookii::command_manager manager{"benchmark"};
+    manager
+        .add_command<wait_command>()
+        .add_command<add_command>();
+
+    const char *wait_args[] = { "wait", "2" };
+    const char *add_args[] = { "add", "1", "2" };
+    ookii::thread_pool pool{threads};
+    for (auto args : { std::span<const char *const>{wait_args}, std::span<const char *const>{add_args} })
+    {
+        std::string prefix{args[0]};
+        run((prefix + " run_command").c_str(), commands, [&]()
+            {
+                long total = 0;
+                for (long i = 0; i < commands; ++i)
+                {
+                    total += manager.run_command(args).value_or(0);
+                }
+
+                return total;
+            });
+
+        run((prefix + " run_command_async").c_str(), commands, [&]()
+            {
+                std::vector<ookii::task<std::optional<int>>> tasks;
+                tasks.reserve(commands);
+                for (long i = 0; i < commands; ++i)
+                {
+                    tasks.push_back(manager.run_command_async(pool, args));
+                    tasks.back().start();
+                }
+
+                long total = 0;
+                for (auto &task : tasks)
+                {
+                    total += task.get().value_or(0);
+                }
+
+                return total;
+            });
+    }
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+// The thin client used by the command_host benchmark. It only includes command_host.h and never
+// creates a command manager, so its startup cost is what a real client executable would pay.
+#include <cstdlib>
+#include <ookii/command_host.h>
+
+int main(int argc, char *argv[])
+{
+    auto socket_path = std::getenv("OOKII_HOST_BENCHMARK_SOCKET");
+    if (socket_path == nullptr)
+    {
+        return 1;
+    }
+
+    return ookii::run_hosted_command(socket_path, argc, argv).value_or(1);
+}
@@ -0,0 +1,127 @@
+// Measures the latency of running a command by starting a new process for every invocation,
+// compared to sending it to a command_host, both from the thin client executable and from the
+// benchmark process itself.
+//
+// Usage: command_host_benchmark [iterations]
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <spawn.h>
+#include <ookii/command_host.h>
+
+class value_command : public ookii::command
+{
+public:
+    value_command(builder_type &builder)
+    {
+        builder.add_argument(_value, "Value").required();
+    }
+
+    int run() override
+    {
+        std::cout << "Value: " << _value << std::endl;
+        return _value;
+    }
+
+private:
+    int _value{};
+};
+
+ookii::command_manager create_manager()
+{
+    ookii::command_manager manager{"benchmark"};
+    for (int i = 0; i < 50; ++i)
+    {
+        manager.add_command<value_command>("command" + std::to_string(i));
+    }
+
+    return manager;
+}
+
+// Starts an executable with the command's arguments, and returns its exit code. The mode, if not
+// null, is inserted before the arguments.
+int spawn(const char *path, const char *mode, int output)
+{
+    const char *args[] = { path, mode, "command25", "-Value", "5", nullptr };
+    auto argv = args;
+    if (mode == nullptr)
+    {
+        args[1] = path;
+        ++argv;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, output, STDOUT_FILENO);
+    pid_t pid;
+    auto result = posix_spawn(&pid, path, &actions, nullptr, const_cast<char *const *>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (result != 0)
+    {
+        return -1;
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+template<typename RunFunc>
+void run(const char *name, long iterations, RunFunc run_once)
+{
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        total += run_once();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (elapsed.count() * 1e6) / iterations << " us/run (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    // When started by the benchmark, the first argument after the executable name selects the
+    // mode; the rest are the arguments for the command.
+    if (argc > 1 && std::strcmp(argv[1], "--direct") == 0)
+    {
+        return create_manager().run_command(argc - 1, argv + 1).value_or(1);
+    }
+
+    long iterations = 500;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    // The client finds the socket using an environment variable.
+    auto socket_path = std::filesystem::temp_directory_path() / ("ookii_host_benchmark_" + std::to_string(getpid()) + ".sock");
+    setenv("OOKII_HOST_BENCHMARK_SOCKET", socket_path.c_str(), 1);
+    auto manager = create_manager();
+    int null_output = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    auto in_process_client = [&]()
+    {
+        const char *args[] = { "benchmark", "command25", "-Value", "5" };
+        return ookii::run_hosted_command(socket_path, 4, args, STDIN_FILENO, null_output, null_output).value_or(-1);
+    };
+
+    run("exec", iterations, [&]() { return spawn(argv[0], "--direct", null_output); });
+    for (bool isolate : { false, true })
+    {
+        ookii::command_host host{manager, socket_path};
+        host.isolate_commands(isolate);
+        std::thread runner{[&host]() { host.run(); }};
+        std::cout << (isolate ? "Forking for every command:" : "Running commands in the host process:") << std::endl;
+        run("  exec client", iterations, [&]() { return spawn(OOKII_HOST_CLIENT, nullptr, null_output); });
+        run("  in-process client", iterations, in_process_client);
+        host.stop();
+        runner.join();
+    }
+
+    close(null_output);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Measures the throughput of split_command_line for command lines with little quoting and with
+// heavy quoting and escaping, compared to splitting into a vector of separately allocated strings.
+//
+// Usage: command_line_split_benchmark [iterations]
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ookii/string_helper.h>
+
+std::string create_plain_line()
+{
+    std::string result = "deploy";
+    for (int i = 0; i < 20; ++i)
+    {
+        result += " -Option" + std::to_string(i) + " value" + std::to_string(i);
+    }
+
+    return result;
+}
+
+std::string create_quoted_line()
+{
+    std::string result = "deploy";
+    for (int i = 0; i < 20; ++i)
+    {
+        result += " -Option" + std::to_string(i) + " \"value with \\\"quotes\\\" and \\$dollar " + std::to_string(i) +
+            "\" 'single quoted text' escaped\\ space\\ " + std::to_string(i);
+    }
+
+    return result;
+}
+
+// Splits on white space only, allocating a string for every argument. This is the approach the
+// splitter replaces, and is included for comparison.
+std::vector<std::string> split_naive(std::string_view line)
+{
+    std::vector<std::string> result;
+    std::string current;
+    for (auto ch : line)
+    {
+        if (ch == ' ')
+        {
+            if (!current.empty())
+            {
+                result.push_back(std::move(current));
+                current.clear();
+            }
+        }
+        else
+        {
+            current.push_back(ch);
+        }
+    }
+
+    if (!current.empty())
+    {
+        result.push_back(std::move(current));
+    }
+
+    return result;
+}
+
+template<typename SplitFunc>
+void run(const char *name, const std::string &line, long iterations, SplitFunc split)
+{
+    size_t tokens = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        tokens += split(line);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto megabytes = (static_cast<double>(line.size()) * iterations) / (1024.0 * 1024.0);
+    std::cout << name << ": " << megabytes / elapsed.count() << " MB/s, "
+        << (elapsed.count() * 1e9) / iterations << " ns/line (" << tokens / iterations << " tokens)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = 1'000'000;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    auto split = [](const std::string &line)
+    {
+        return ookii::split_command_line(std::string_view{line})->size();
+    };
+
+    auto naive = [](const std::string &line)
+    {
+        return split_naive(line).size();
+    };
+
+    auto plain = create_plain_line();
+    auto quoted = create_quoted_line();
+    run("Plain, split_command_line", plain, iterations, split);
+    run("Plain, vector<string>", plain, iterations, naive);
+    run("Quoted, split_command_line", quoted, iterations, split);
+    run("Quoted, vector<string> (no quote handling)", quoted, iterations, naive);
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Measures running a script of commands that each wait for a while, like commands waiting for
+// I/O, and write some output. The script is run one line at a time using
+// command_manager::run_command(), and using command_manager::run_script() with an executor that
+// runs everything on the calling thread, and with a thread_pool. Every line ends with '&', so
+// run_script() may run the commands concurrently.
+//
+// Usage: command_script_benchmark [lines] [threads]
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <ookii/subcommand.h>
+#include <ookii/thread_pool.h>
+
+class process_command : public ookii::command
+{
+public:
+    process_command(builder_type &builder)
+    {
+        builder
+            .add_argument(_name, "Name").positional().required()
+            .add_argument(_milliseconds, "Milliseconds").default_value(2);
+    }
+
+    int run() override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{_milliseconds});
+        std::cout << "Processed " << _name << '.' << std::endl;
+        return 0;
+    }
+
+    static std::string name()
+    {
+        return "process";
+    }
+
+private:
+    std::string _name;
+    int _milliseconds{};
+};
+
+struct inline_executor
+{
+    template<typename Func>
+    void execute(Func &&func)
+    {
+        func();
+    }
+};
+
+// Discards all output, and counts the characters so the output can be compared.
+class counting_streambuf : public std::streambuf
+{
+public:
+    size_t count{};
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        ++count;
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize size) override
+    {
+        count += static_cast<size_t>(size);
+        return size;
+    }
+};
+
+template<typename RunFunc>
+void run(const char *name, long lines, RunFunc run_script)
+{
+    counting_streambuf output;
+    auto old_buffer = std::cout.rdbuf(&output);
+    auto start = std::chrono::steady_clock::now();
+    auto result = run_script();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout.rdbuf(old_buffer);
+    std::cout << name << ": " << (elapsed.count() * 1e6) / lines << " us/line (exit code " << result << ", "
+        << output.count << " characters)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long lines = 200;
+    size_t threads = 16;
+    if (argc > 1)
+    {
+        lines = std::stol(argv[1]);
+    }
+
+    if (argc > 2)
+    {
+        threads = std::stoul(argv[2]);
+    }
+
+    std::string script;
+    for (long i = 0; i < lines; ++i)
+    {
+        script += "process 'item " + std::to_string(i) + "' &\n";
+    }
+
+    ookii::command_manager manager{"benchmark"};
+    manager.add_command<process_command>();
+    run("run_command", lines, [&]()
+        {
+            std::istringstream input{script};
+            std::string line;
+            int result = 0;
+            while (std::getline(input, line))
+            {
+                auto tokens = ookii::split_command_line(std::string_view{line});
+                auto args = tokens->args();
+                result = std::max(result, manager.run_command(args.first(args.size() - 1)).value_or(1));
+            }
+
+            return result;
+        });
+
+    run("run_script (inline)", lines, [&]()
+        {
+            std::istringstream input{script};
+            inline_executor executor;
+            return manager.run_script(executor, input).value_or(1);
+        });
+
+    ookii::thread_pool pool{threads};
+    run("run_script (thread_pool)", lines, [&]()
+        {
+            std::istringstream input{script};
+            return manager.run_script(pool, input).value_or(1);
+        });
+
+    return 0;
+}
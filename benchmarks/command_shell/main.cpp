@@ -0,0 +1,131 @@
+// Measures the cost of running the same command lines repeatedly in one process, using
+// command_manager::run_command() for every line compared to a command_shell, which keeps the
+// parser of each command after its first use.
+//
+// Usage: command_shell_benchmark [iterations]
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ookii/command_shell.h>
+
+class copy_command : public ookii::command
+{
+public:
+    copy_command(builder_type &builder)
+    {
+        builder
+            .add_argument(_source, "Source").required().positional()
+            .add_argument(_destination, "Destination").required().positional()
+            .add_argument(_buffer_size, "BufferSize").default_value(4096)
+            .add_argument(_overwrite, "Overwrite")
+            .add_argument(_verbose, "Verbose")
+            .add_multi_value_argument(_exclude, "Exclude");
+    }
+
+    int run() override
+    {
+        return static_cast<int>(_source.size() + _destination.size() + _exclude.size()) + _buffer_size + _overwrite;
+    }
+
+    static std::string name()
+    {
+        return "copy";
+    }
+
+private:
+    std::string _source;
+    std::string _destination;
+    int _buffer_size{};
+    bool _overwrite{};
+    bool _verbose{};
+    std::vector<std::string> _exclude;
+};
+
+class list_command : public ookii::command
+{
+public:
+    list_command(builder_type &builder)
+    {
+        builder
+            .add_argument(_path, "Path").positional()
+            .add_argument(_recursive, "Recursive")
+            .add_argument(_pattern, "Pattern");
+    }
+
+    int run() override
+    {
+        return static_cast<int>(_path.size() + _pattern.size()) + _recursive;
+    }
+
+    static std::string name()
+    {
+        return "list";
+    }
+
+private:
+    std::string _path{"."};
+    bool _recursive{};
+    std::string _pattern;
+};
+
+const char *const c_lines[] = {
+    "copy 'source file.txt' dest.txt -BufferSize 8192 -Exclude '*.tmp' -Exclude '*.bak'",
+    "list /home/user -Recursive -Pattern '*.cpp'",
+    "copy a.txt b.txt -Overwrite",
+    "list",
+};
+
+ookii::command_manager create_manager()
+{
+    ookii::command_manager manager{"benchmark"};
+    manager
+        .add_command<copy_command>()
+        .add_command<list_command>();
+
+    return manager;
+}
+
+template<typename RunFunc>
+void run(const char *name, long iterations, RunFunc run_line)
+{
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        for (auto line : c_lines)
+        {
+            total += run_line(line).value_or(0);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto lines = iterations * static_cast<long>(std::size(c_lines));
+    std::cout << name << ": " << (elapsed.count() * 1e6) / lines << " us/line (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = 20'000;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    auto manager = create_manager();
+    run("run_command", iterations, [&](const char *line)
+        {
+            auto tokens = ookii::split_command_line(std::string_view{line});
+            return manager.run_command(tokens->args());
+        });
+
+    ookii::command_shell shell{manager};
+    shell.max_history(0);
+    run("command_shell", iterations, [&](const char *line)
+        {
+            return shell.run_line(line);
+        });
+
+    return 0;
+}
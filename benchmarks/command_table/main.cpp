@@ -0,0 +1,101 @@
+// Measures the cost of registering a large number of subcommands and creating one of them, using
+// add_command() for every command compared to a static table passed to add_command_table().
+//
+// Usage: command_table_benchmark [iterations]
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <ookii/subcommand.h>
+
+constexpr size_t c_command_count = 400;
+
+template<size_t N>
+class numbered_command : public ookii::command
+{
+public:
+    numbered_command(builder_type &builder)
+    {
+        builder.add_argument(_value, "Value");
+    }
+
+    int run() override
+    {
+        return _value;
+    }
+
+    // Names are zero padded so the table order matches the numbering.
+    static constexpr std::array<char, 10> name_chars{'c', 'o', 'm', 'm', 'a', 'n', 'd',
+        static_cast<char>('0' + N / 100), static_cast<char>('0' + N / 10 % 10), static_cast<char>('0' + N % 10)};
+
+    static constexpr std::string_view name_view{name_chars.data(), name_chars.size()};
+
+    static std::string name()
+    {
+        return std::string{name_view};
+    }
+
+    static std::string description()
+    {
+        return "Runs command number " + std::to_string(N) + ".";
+    }
+
+private:
+    int _value{};
+};
+
+template<size_t... N>
+void add_all_commands(ookii::command_manager &manager, std::index_sequence<N...>)
+{
+    (manager.add_command<numbered_command<N>>(), ...);
+}
+
+template<size_t... N>
+constexpr auto create_table(std::index_sequence<N...>)
+{
+    using entry = ookii::command_table_entry<char>;
+    return std::array<entry, sizeof...(N)>{
+        entry::create<numbered_command<N>>(numbered_command<N>::name_view, "Runs a numbered command.")...
+    };
+}
+
+static constexpr auto c_table = create_table(std::make_index_sequence<c_command_count>{});
+
+template<typename SetupFunc>
+void run(const char *name, long iterations, SetupFunc setup)
+{
+    const char *args[] = { "command200", "-Value", "5" };
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        ookii::command_manager manager{"benchmark"};
+        setup(manager);
+        total += manager.run_command(args).value_or(0);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (elapsed.count() * 1e6) / iterations << " us/run (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = 2'000;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    run("add_command", iterations, [](auto &manager)
+        {
+            add_all_commands(manager, std::make_index_sequence<c_command_count>{});
+        });
+
+    run("add_command_table", iterations, [](auto &manager)
+        {
+            manager.add_command_table(c_table);
+        });
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Measures the cost of parsing a typical command line using the generated create_builder() method,
+// compared to the parse_direct() method generated by New-Parser.ps1 with -DirectParse.
+//
+// Usage: direct_parse_benchmark [iterations]
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ookii/command_line_generated.h>
+
+struct arguments
+{
+    std::string source;
+    std::string destination;
+    int count{1};
+    std::vector<std::string> tags;
+    bool verbose{};
+
+    OOKII_GENERATED_DIRECT_METHODS(arguments);
+};
+
+// The following two methods are the same as what New-Parser.ps1 generates with -DirectParse.
+ookii::basic_parser_builder<char> arguments::create_builder(std::basic_string<char> command_name, ookii::basic_localized_string_provider<char> *string_provider, const std::locale &locale)
+{
+    ookii::basic_parser_builder<char> builder{command_name, string_provider};
+    builder
+        .locale(locale)
+        .add_argument(this->source, "source").required().positional()
+        .add_argument(this->destination, "destination").required().positional()
+        .add_argument(this->count, "count").default_value(1)
+        .add_multi_value_argument(this->tags, "tags").alias("t")
+        .add_argument(this->verbose, "verbose").alias("v")
+    ;
+
+    return builder;
+}
+
+bool arguments::parse_direct(std::span<const char *const> args, const std::locale &locale)
+{
+    enum class argument_id : size_t
+    {
+        source,
+        destination,
+        count,
+        tags,
+        verbose,
+    };
+
+    using argument_info = ookii::details::direct_argument;
+    static constexpr argument_info arguments[] = {
+        argument_info::create<decltype(arguments::source)>(argument_info::required | argument_info::positional),
+        argument_info::create<decltype(arguments::destination)>(argument_info::required | argument_info::positional),
+        argument_info::create<decltype(arguments::count)>(argument_info::has_default),
+        argument_info::create_multi_value<decltype(arguments::tags)>(argument_info::none),
+        argument_info::create<decltype(arguments::verbose)>(argument_info::none),
+    };
+
+    static constexpr std::array<argument_id, 2> positional{ argument_id::source, argument_id::destination };
+    ookii::details::direct_parser<char, argument_id, std::size(arguments)> parser{arguments, positional, ookii::details::direct_default_prefixes<char>(), locale};
+    this->tags.clear();
+    auto find = [&parser](std::basic_string_view<char> name) -> std::optional<argument_id>
+    {
+        switch (name.size())
+        {
+        case 1:
+            if (parser.name_equals(name, "t"))
+                return argument_id::tags;
+            if (parser.name_equals(name, "v"))
+                return argument_id::verbose;
+            break;
+        case 4:
+            if (parser.name_equals(name, "tags"))
+                return argument_id::tags;
+            break;
+        case 5:
+            if (parser.name_equals(name, "count"))
+                return argument_id::count;
+            break;
+        case 6:
+            if (parser.name_equals(name, "source"))
+                return argument_id::source;
+            break;
+        case 7:
+            if (parser.name_equals(name, "verbose"))
+                return argument_id::verbose;
+            break;
+        case 11:
+            if (parser.name_equals(name, "destination"))
+                return argument_id::destination;
+            break;
+        }
+
+        return {};
+    };
+
+    auto set = [this, &locale](argument_id id, std::optional<std::basic_string_view<char>> value)
+    {
+        switch (id)
+        {
+        case argument_id::source:
+            return ookii::details::direct_set_value(this->source, value, locale);
+        case argument_id::destination:
+            return ookii::details::direct_set_value(this->destination, value, locale);
+        case argument_id::count:
+            return ookii::details::direct_set_value(this->count, value, locale);
+        case argument_id::tags:
+            return ookii::details::direct_add_value(this->tags, value, locale);
+        case argument_id::verbose:
+            return ookii::details::direct_set_value(this->verbose, value, locale);
+        }
+
+        return false;
+    };
+
+    auto set_default = [this](argument_id id)
+    {
+        switch (id)
+        {
+        case argument_id::count:
+            this->count = 1;
+            break;
+        default:
+            break;
+        }
+    };
+
+    return parser.parse(args, find, set, set_default);
+}
+
+template<typename ParseFunc>
+void run(const char *name, long iterations, ParseFunc parse)
+{
+    const char *args[] = { "benchmark", "input.txt", "output.txt", "-Count", "5", "-t", "a", "-t", "b", "-Verbose" };
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        total += parse(static_cast<int>(std::size(args)), args);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (elapsed.count() * 1e6) / iterations << " us/run (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = 100'000;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    run("create_builder", iterations, [](int count, const char *const args[])
+        {
+            arguments result{};
+            auto parser = result.create_builder("benchmark").build();
+            return parser.parse(count, args) ? result.count : 0;
+        });
+
+    run("parse_direct", iterations, [](int count, const char *const args[])
+        {
+            arguments result{};
+            return result.parse_direct(std::span{args + 1, static_cast<size_t>(count - 1)}, {}) ? result.count : 0;
+        });
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Measures the throughput of the line_wrapping_ostream when writing large amounts of text, for
+// both usage-help style text (short paragraphs with changing indentation and colors) and generic
+// log output (long lines that need to be wrapped).
+//
+// Usage: line_wrapping_benchmark [megabytes]
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <ookii/line_wrapping_stream.h>
+
+// Stream buffer that discards its output, so only the cost of wrapping is measured.
+class null_streambuf : public std::streambuf
+{
+protected:
+    int_type overflow(int_type ch) override
+    {
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char_type *, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+std::string create_help_text()
+{
+    std::string result;
+    for (int i = 0; i < 50; ++i)
+    {
+        result += "    \x1b[32m-Argument";
+        result += std::to_string(i);
+        result += " <string>\x1b[0m\n";
+        result += "        Description of the argument, which is long enough that it will need to be wrapped "
+            "at least once or twice when written to a console with a typical width.\n\n";
+    }
+
+    return result;
+}
+
+std::string create_log_text()
+{
+    std::string result;
+    for (int i = 0; i < 50; ++i)
+    {
+        result += "2024-01-01T12:00:00.000Z INFO [worker-";
+        result += std::to_string(i);
+        result += "] Processed request /api/items?id=12345&filter=all in 12ms; status=200 bytes=4096 "
+            "user-agent=\"Mozilla/5.0 (X11; Linux x86_64)\" upstream=10.0.0.1:8080\n";
+    }
+
+    return result;
+}
+
+template<typename WriteFunc>
+void run(const char *name, size_t total_bytes, size_t chunk_size, WriteFunc write)
+{
+    null_streambuf target;
+    std::ostream target_stream{&target};
+    ookii::line_wrapping_ostream stream{target_stream, 80};
+    auto start = std::chrono::steady_clock::now();
+    size_t written = 0;
+    while (written < total_bytes)
+    {
+        write(stream);
+        written += chunk_size;
+    }
+
+    stream.flush(true);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (written / (1024.0 * 1024.0)) / elapsed.count() << " MB/s" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t megabytes = 64;
+    if (argc > 1)
+    {
+        megabytes = std::stoul(argv[1]);
+    }
+
+    auto total_bytes = megabytes * 1024 * 1024;
+    auto help = create_help_text();
+    auto log = create_log_text();
+    run("Usage help", total_bytes, help.size(), [&help](auto &stream)
+        {
+            stream << ookii::set_indent(8) << help << ookii::reset_indent;
+        });
+
+    run("Log output", total_bytes, log.size(), [&log](auto &stream)
+        {
+            stream << ookii::set_indent(4) << log;
+        });
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Measures the cost of running one command in a tree of nested commands, with 10 parent commands
+// at each of the first two levels and 10 leaf commands under each of those, compared to a single
+// level with the same number of commands.
+//
+// Usage: nested_commands_benchmark [iterations]
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <ookii/subcommand.h>
+
+constexpr int c_branch_count = 10;
+
+class leaf_command : public ookii::command
+{
+public:
+    leaf_command(builder_type &builder)
+    {
+        builder.add_argument(_value, "Value");
+    }
+
+    int run() override
+    {
+        return _value;
+    }
+
+private:
+    int _value{};
+};
+
+void add_leaves(ookii::command_manager &manager, const std::string &prefix)
+{
+    for (int i = 0; i < c_branch_count; ++i)
+    {
+        manager.add_command<leaf_command>(prefix + "leaf" + std::to_string(i));
+    }
+}
+
+template<typename SetupFunc>
+void run(const char *name, long iterations, std::span<const char *const> args, SetupFunc setup)
+{
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+    {
+        ookii::command_manager manager{"benchmark"};
+        setup(manager);
+        total += manager.run_command(args).value_or(0);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << (elapsed.count() * 1e6) / iterations << " us/run (checksum " << total << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = 2'000;
+    if (argc > 1)
+    {
+        iterations = std::stol(argv[1]);
+    }
+
+    const char *flat_args[] = { "group5_section5_leaf5", "-Value", "5" };
+    run("flat", iterations, flat_args, [](auto &manager)
+        {
+            for (int group = 0; group < c_branch_count; ++group)
+            {
+                for (int section = 0; section < c_branch_count; ++section)
+                {
+                    add_leaves(manager, "group" + std::to_string(group) + "_section" + std::to_string(section) + "_");
+                }
+            }
+        });
+
+    const char *nested_args[] = { "group5", "section5", "leaf5", "-Value", "5" };
+    run("nested", iterations, nested_args, [](auto &manager)
+        {
+            for (int group = 0; group < c_branch_count; ++group)
+            {
+                manager.add_parent_command("group" + std::to_string(group), {}, [](ookii::command_manager &sections)
+                    {
+                        for (int section = 0; section < c_branch_count; ++section)
+                        {
+                            sections.add_parent_command("section" + std::to_string(section), {}, [](ookii::command_manager &leaves)
+                                {
+                                    add_leaves(leaves, {});
+                                });
+                        }
+                    });
+            }
+        });
+
+    return 0;
+}
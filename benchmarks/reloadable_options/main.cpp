@@ -0,0 +1,108 @@
+// Measures the read-side overhead of basic_reloadable_options, compared to reading a plain
+// struct, while another thread keeps publishing new snapshots.
+//
+// Usage: reloadable_options_benchmark [threads] [reads_per_thread]
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ookii/reloadable_options.h>
+
+struct options
+{
+    int value{};
+    int other{};
+};
+
+ookii::command_line_parser create_parser(options &o)
+{
+    return ookii::parser_builder{"benchmark"}
+        .add_argument(o.value, "Value").environment_variable("OOKII_BENCHMARK_VALUE")
+        .add_argument(o.other, "Other")
+        .build();
+}
+
+template<typename ReadFunc>
+void run(const char *name, int thread_count, long reads, ReadFunc read)
+{
+    std::atomic<long long> checksum{};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back([&]()
+            {
+                auto reader = read();
+                long long sum = 0;
+                for (long j = 0; j < reads; ++j)
+                {
+                    sum += reader();
+                }
+
+                checksum += sum;
+            });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / reads << " ns/read (checksum " << checksum.load() << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int thread_count = 4;
+    long reads = 10'000'000;
+    if (argc > 1)
+    {
+        thread_count = std::stoi(argv[1]);
+    }
+
+    if (argc > 2)
+    {
+        reads = std::stol(argv[2]);
+    }
+
+    ookii::reloadable_options<options> reloadable{create_parser, {"-Other", "1"}};
+    if (!reloadable.reload())
+    {
+        std::cerr << "Parsing failed." << std::endl;
+        return 1;
+    }
+
+    // Publish a new snapshot roughly every millisecond while the readers are running.
+    std::atomic<bool> done{};
+    std::thread writer{[&]()
+        {
+            while (!done.load())
+            {
+                (void)reloadable.reload();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }};
+
+    options plain{1, 1};
+    run("Plain struct", thread_count, reads, [&plain]()
+        {
+            return [&plain]() { return static_cast<volatile const int &>(plain.other); };
+        });
+
+    run("reader::get()", thread_count, reads, [&reloadable]()
+        {
+            return [reader = decltype(reloadable)::reader{reloadable}]() mutable { return reader->other; };
+        });
+
+    run("current()", thread_count, reads, [&reloadable]()
+        {
+            return [&reloadable]() { return reloadable.current()->other; };
+        });
+
+    done = true;
+    writer.join();
+    return 0;
+}
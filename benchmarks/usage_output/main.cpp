@@ -0,0 +1,56 @@
+// Measures how long it takes to write the usage help for a parser with many arguments to the
+// standard output, using std::cout (the default) and using fd_streambuf to write to the file
+// descriptor directly. Run it with the standard output redirected, for example to /dev/null;
+// the results are written to the standard error stream.
+//
+// Usage: usage_output_benchmark [iterations] [arguments]
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ookii/command_line.h>
+
+template<typename CreateWriter>
+void run(const char *name, ookii::command_line_parser &parser, int iterations, CreateWriter create_writer)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto writer = create_writer();
+        parser.write_usage(writer.get());
+    }
+
+    std::cout.flush();
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << name << ": " << elapsed / iterations << " us per usage help" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 1000;
+    int argument_count = argc > 2 ? std::stoi(argv[2]) : 200;
+    std::vector<std::string> values(static_cast<size_t>(argument_count));
+    ookii::parser_builder builder{"benchmark"};
+    builder.description("Benchmark application with a large number of arguments.");
+    for (int i = 0; i < argument_count; ++i)
+    {
+        builder.add_argument(values[static_cast<size_t>(i)], "Argument" + std::to_string(i))
+            .description("Description of the argument, which is long enough that it will need to be wrapped "
+                "at least once when written to a console with a typical width.");
+    }
+
+    auto parser = builder.build();
+
+    run("std::cout", parser, iterations, []()
+        {
+            return std::make_unique<ookii::usage_writer>(false);
+        });
+
+    // File descriptors 1 and 2 are the standard output and error streams.
+    run("fd_streambuf", parser, iterations, []()
+        {
+            return std::make_unique<ookii::usage_writer>(1, 2, false);
+        });
+
+    return 0;
+}
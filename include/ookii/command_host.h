@@ -0,0 +1,766 @@
+//! \file command_host.h
+//! \brief Provides the ookii::command_host class and the ookii::run_hosted_command() function.
+//!
+//! This header is only available on Linux and other POSIX platforms that provide `accept4()`,
+//! because it uses Unix domain sockets. Unlike the other headers, it's not included by
+//! command_line.h.
+#ifndef OOKII_COMMAND_HOST_H_
+#define OOKII_COMMAND_HOST_H_
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "command_shell.h"
+#include "scope_helper.h"
+
+extern char **environ;
+
+namespace ookii
+{
+    namespace details
+    {
+        // The number of file descriptors sent with every request: standard input, output and
+        // error.
+        constexpr size_t c_host_fd_count = 3;
+
+        // Requests larger than this are rejected before the body is allocated. Linux limits the
+        // arguments and environment of a process to a quarter of the stack size, so this is well
+        // above anything a client can be started with.
+        constexpr std::uint32_t c_max_host_request_size = 16 * 1024 * 1024;
+
+        // A request starts with this header, followed by the working directory, the arguments and
+        // the environment variables, each terminated by a NUL character.
+        struct host_request_header
+        {
+            std::uint32_t size;
+            std::uint32_t arg_count;
+            std::uint32_t env_count;
+        };
+
+        class unique_fd
+        {
+        public:
+            unique_fd() = default;
+
+            explicit unique_fd(int fd) noexcept
+                : _fd{fd}
+            {
+            }
+
+            unique_fd(unique_fd &&other) noexcept
+                : _fd{std::exchange(other._fd, -1)}
+            {
+            }
+
+            unique_fd &operator=(unique_fd &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset(std::exchange(other._fd, -1));
+                }
+
+                return *this;
+            }
+
+            ~unique_fd()
+            {
+                reset();
+            }
+
+            int get() const noexcept
+            {
+                return _fd;
+            }
+
+            void reset(int fd = -1) noexcept
+            {
+                if (_fd >= 0)
+                {
+                    close(_fd);
+                }
+
+                _fd = fd;
+            }
+
+        private:
+            int _fd{-1};
+        };
+
+        inline sockaddr_un make_socket_address(const std::filesystem::path &path)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (path.native().size() >= sizeof(address.sun_path))
+            {
+                throw std::invalid_argument("The socket path is too long.");
+            }
+
+            std::memcpy(address.sun_path, path.c_str(), path.native().size());
+            return address;
+        }
+
+        // Unlike write_fd(), this doesn't raise SIGPIPE if the other side closed the socket.
+        inline bool send_all(int socket, const void *data, size_t size) noexcept
+        {
+            auto current = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                auto count = send(socket, current, size, MSG_NOSIGNAL);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (count <= 0)
+                {
+                    return false;
+                }
+
+                current += count;
+                size -= static_cast<size_t>(count);
+            }
+
+            return true;
+        }
+
+        inline bool read_all(int fd, void *data, size_t size) noexcept
+        {
+            auto current = static_cast<char *>(data);
+            while (size > 0)
+            {
+                auto count = read(fd, current, size);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (count <= 0)
+                {
+                    return false;
+                }
+
+                current += count;
+                size -= static_cast<size_t>(count);
+            }
+
+            return true;
+        }
+
+        // Sends the request header with the file descriptors attached.
+        inline bool send_with_fds(int socket, const host_request_header &header, const int (&fds)[c_host_fd_count]) noexcept
+        {
+            iovec data{const_cast<host_request_header *>(&header), sizeof(header)};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))]{};
+            msghdr message{};
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            auto control_header = CMSG_FIRSTHDR(&message);
+            control_header->cmsg_level = SOL_SOCKET;
+            control_header->cmsg_type = SCM_RIGHTS;
+            control_header->cmsg_len = CMSG_LEN(sizeof(fds));
+            std::memcpy(CMSG_DATA(control_header), fds, sizeof(fds));
+            ssize_t result;
+            while ((result = sendmsg(socket, &message, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+            {
+            }
+
+            return result == static_cast<ssize_t>(sizeof(header));
+        }
+
+        // Receives the request header and the file descriptors attached to it.
+        inline bool receive_with_fds(int socket, host_request_header &header, unique_fd (&fds)[c_host_fd_count]) noexcept
+        {
+            iovec data{&header, sizeof(header)};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * c_host_fd_count)]{};
+            msghdr message{};
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            ssize_t result;
+            while ((result = recvmsg(socket, &message, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+            {
+            }
+
+            auto control_header = CMSG_FIRSTHDR(&message);
+            if (control_header != nullptr && control_header->cmsg_level == SOL_SOCKET &&
+                control_header->cmsg_type == SCM_RIGHTS)
+            {
+                auto count = (control_header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < count && i < c_host_fd_count; ++i)
+                {
+                    int fd;
+                    std::memcpy(&fd, CMSG_DATA(control_header) + i * sizeof(int), sizeof(int));
+
+                    // If the host was started without standard streams, a received descriptor
+                    // could be replaced when the streams are redirected, so move it out of the way.
+                    if (fd < static_cast<int>(c_host_fd_count))
+                    {
+                        int moved = fcntl(fd, F_DUPFD_CLOEXEC, static_cast<int>(c_host_fd_count));
+                        close(fd);
+                        fd = moved;
+                    }
+
+                    fds[i].reset(fd);
+                }
+            }
+
+            if (result <= 0)
+            {
+                return false;
+            }
+
+            // The header is small, but may still arrive in more than one part.
+            auto received = static_cast<size_t>(result);
+            return received == sizeof(header) ||
+                read_all(socket, reinterpret_cast<char *>(&header) + received, sizeof(header) - received);
+        }
+
+        inline void append_strings(std::string &buffer, const char *const *values, std::uint32_t &count)
+        {
+            for (count = 0; values[count] != nullptr; ++count)
+            {
+                buffer.append(values[count]);
+                buffer.push_back('\0');
+            }
+        }
+
+        // Splits the request body into NUL-terminated strings, which point into the body.
+        inline bool split_request(std::string &body, const host_request_header &header, std::vector<char *> &strings)
+        {
+            size_t expected = static_cast<size_t>(header.arg_count) + header.env_count + 1;
+            strings.reserve(expected);
+            for (size_t start = 0; start < body.size(); )
+            {
+                auto end = body.find('\0', start);
+                if (end == std::string::npos)
+                {
+                    return false;
+                }
+
+                strings.push_back(body.data() + start);
+                start = end + 1;
+            }
+
+            return strings.size() == expected;
+        }
+    }
+
+    //! \brief Runs commands from a basic_command_manager on behalf of client processes, using a
+    //!        Unix domain socket.
+    //!
+    //! \warning This class is only available on Linux and other POSIX platforms that provide
+    //!          `accept4()`.
+    //!
+    //! Scripts that invoke the same application many times spend much of their time starting the
+    //! process: loading shared libraries, initializing static state, and registering commands.
+    //! A command host does this work once. It's a long-running process that listens on a Unix
+    //! domain socket, and the application's executable becomes a thin client that uses the
+    //! run_hosted_command() function to send its arguments to the host.
+    //!
+    //! The client sends its arguments, environment variables and working directory, as well as
+    //! its standard input, output and error file descriptors. For every request, the host changes
+    //! to the client's working directory and environment, replaces its own standard streams with
+    //! the client's, and runs the command. Because the command writes directly to the client's
+    //! file descriptors, output is not copied through the host, and console features such as the
+    //! line width still work. Finally, the exit code is sent back to the client.
+    //!
+    //! By default, commands run in the host process, one at a time, using a basic_command_shell.
+    //! This means the command object and its parser are created the first time a command is used,
+    //! and reused by later requests for the same command, as described for basic_command_shell.
+    //! The state of the host process is restored after every command. The cached console width
+    //! and terminal capabilities, and the error and end-of-file state of the standard input, are
+    //! reset before and after every command, so they reflect the streams of the current client.
+    //!
+    //! If commands depend on global state, or can't be trusted not to crash, use
+    //! isolate_commands() to run every command in a new process created using `fork()` instead.
+    //! Commands are then isolated from each other and from the host, just like they are when the
+    //! application is started normally, but the new process already contains everything the host
+    //! initialized. Call basic_command_manager::commands() before run() to make sure commands from a
+    //! table added using basic_command_manager::add_command_table() are already loaded, if desired.
+    //!
+    //! A client that doesn't send its whole request within the time set using request_timeout()
+    //! is disconnected, so it can't stop the host from accepting other requests.
+    //!
+    //! Anyone who can connect to the socket can run commands as the user running the host, so
+    //! the socket is created with permissions that only allow the owner to connect. Make sure
+    //! the socket is in a directory that other users cannot write to.
+    //!
+    //! This class only supports `char`, because the arguments are passed as is.
+    class command_host
+    {
+    public:
+        //! \brief The type of the function that runs a command.
+        using command_function = std::function<int(int argc, const char *const argv[])>;
+
+        //! \brief Initializes a new instance of the command_host class that runs commands using
+        //!        a basic_command_manager.
+        //!
+        //! The first argument sent by the client is assumed to be the application name, like
+        //! with basic_command_manager::run_command(). The remaining arguments are passed to
+        //! basic_command_shell::run_command(), so the parser for each command is only created
+        //! once. If the command could not be created, the exit code is 1.
+        //!
+        //! \param manager The basic_command_manager to use. This reference must remain valid as
+        //!        long as the command_host exists.
+        //! \param socket_path The path of the socket to listen on. If a file with that name exists,
+        //!        it's removed.
+        //! \exception std::invalid_argument The socket path is too long.
+        //! \exception std::system_error Creating the socket failed.
+        command_host(const basic_command_manager<char> &manager, const std::filesystem::path &socket_path)
+            : command_host{[this](int argc, const char *const argv[])
+                {
+                    std::span<const char *const> args;
+                    if (argc > 0)
+                    {
+                        args = {argv + 1, static_cast<size_t>(argc - 1)};
+                    }
+
+                    return _shell->run_command(args).value_or(1);
+                }, socket_path}
+        {
+            _shell.emplace(manager);
+        }
+
+        //! \brief Initializes a new instance of the command_host class that runs commands using
+        //!        a custom function.
+        //!
+        //! \param function A function that runs a command using the specified arguments, and
+        //!        returns the exit code. The first argument is the client's application name.
+        //! \param socket_path The path of the socket to listen on. If a file with that name exists,
+        //!        it's removed.
+        //! \exception std::invalid_argument The socket path is too long.
+        //! \exception std::system_error Creating the socket failed.
+        command_host(command_function function, const std::filesystem::path &socket_path)
+            : _function{std::move(function)},
+              _socket_path{socket_path}
+        {
+            auto address = details::make_socket_address(socket_path);
+            int stop_pipe[2];
+            if (pipe(stop_pipe) != 0)
+            {
+                throw_last_error("pipe");
+            }
+
+            _stop_read.reset(stop_pipe[0]);
+            _stop_write.reset(stop_pipe[1]);
+            fcntl(_stop_read.get(), F_SETFD, FD_CLOEXEC);
+            fcntl(_stop_write.get(), F_SETFD, FD_CLOEXEC);
+            _socket.reset(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+            if (_socket.get() < 0)
+            {
+                throw_last_error("socket");
+            }
+
+            unlink(socket_path.c_str());
+            if (bind(_socket.get(), reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+            {
+                throw_last_error("bind");
+            }
+
+            // Connections are only possible after listen(), so there's no window where other
+            // users could connect.
+            if (chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(_socket.get(), SOMAXCONN) != 0)
+            {
+                auto error = errno;
+                unlink(socket_path.c_str());
+                throw std::system_error{error, std::generic_category(), "listen"};
+            }
+        }
+
+        command_host(const command_host &) = delete;
+        command_host &operator=(const command_host &) = delete;
+
+        //! \brief Closes the socket and removes the socket file.
+        ~command_host()
+        {
+            _socket.reset();
+            unlink(_socket_path.c_str());
+        }
+
+        //! \brief Accepts and runs commands until stop() is called.
+        //!
+        //! Unless isolate_commands() is set to `true`, every command runs on the calling thread,
+        //! and this method waits for it to finish before accepting the next one. Otherwise, every
+        //! command runs in a separate process, and this method doesn't wait for it.
+        //!
+        //! \exception std::system_error Accepting a connection or creating a process failed.
+        void run()
+        {
+            pollfd poll_info[2]{{_socket.get(), POLLIN, 0}, {_stop_read.get(), POLLIN, 0}};
+            while (!_stopped.load())
+            {
+                reap_processes();
+
+                // Wake up regularly to clean up processes that have finished.
+                auto result = poll(poll_info, 2, 1000);
+                if (result < 0 && errno != EINTR)
+                {
+                    throw_last_error("poll");
+                }
+
+                if (result <= 0 || (poll_info[0].revents & POLLIN) == 0)
+                {
+                    continue;
+                }
+
+                details::unique_fd connection{accept4(_socket.get(), nullptr, nullptr, SOCK_CLOEXEC)};
+                if (connection.get() < 0)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN)
+                    {
+                        continue;
+                    }
+
+                    throw_last_error("accept");
+                }
+
+                // Don't let a client that stops sending block the host.
+                set_timeout(connection.get());
+                if (!_isolate_commands)
+                {
+                    run_request(connection.get(), true);
+                    continue;
+                }
+
+                // Make sure nothing buffered by the host is written again by the new process.
+                flush_standard_streams();
+                auto pid = fork();
+                if (pid < 0)
+                {
+                    throw_last_error("fork");
+                }
+
+                if (pid == 0)
+                {
+                    _socket.reset();
+                    _exit(run_request(connection.get(), false));
+                }
+
+                _processes.push_back(pid);
+            }
+        }
+
+        //! \brief Makes run() return.
+        //!
+        //! This method can be called from any thread, or from a signal handler. Commands that are
+        //! still running are not stopped. Once this method was called, run() returns immediately,
+        //! so a command_host can't be restarted.
+        void stop() noexcept
+        {
+            _stopped.store(true);
+            char value = 0;
+            [[maybe_unused]] auto result = write(_stop_write.get(), &value, 1);
+        }
+
+        //! \brief Sets a value that indicates whether every command runs in a separate process.
+        //!
+        //! By default, commands run on the thread that called run(), one at a time, and share the
+        //! state of the host: a command that changes global state affects all later commands, and
+        //! a command that calls `exit()` or crashes stops the host. The standard streams, working
+        //! directory and environment variables of the host process are replaced while the command
+        //! runs, and restored afterwards, which also affects any other threads in the host.
+        //!
+        //! If this is set to `true`, every command instead runs in a new process created using
+        //! `fork()`. This costs more per command, and the cached parsers can't be reused, because
+        //! they are created in the new process.
+        //!
+        //! \param value `true` to run every command in a separate process; otherwise, `false`.
+        //! \return A reference to the command_host.
+        command_host &isolate_commands(bool value) noexcept
+        {
+            _isolate_commands = value;
+            return *this;
+        }
+
+        //! \brief Gets a value that indicates whether every command runs in a separate process.
+        bool isolate_commands() const noexcept
+        {
+            return _isolate_commands;
+        }
+
+        //! \brief Sets the time the host waits for a client to send its request.
+        //!
+        //! If a client connects but doesn't send its whole request within this time, the connection
+        //! is closed without running a command. The timeout applies to each read from the socket,
+        //! not to the command itself. The default is five seconds, and zero means no timeout.
+        //!
+        //! \param timeout The timeout.
+        //! \return A reference to the command_host.
+        command_host &request_timeout(std::chrono::milliseconds timeout) noexcept
+        {
+            _request_timeout = timeout;
+            return *this;
+        }
+
+        //! \brief Gets the time the host waits for a client to send its request.
+        std::chrono::milliseconds request_timeout() const noexcept
+        {
+            return _request_timeout;
+        }
+
+        //! \brief Gets the path of the socket.
+        const std::filesystem::path &socket_path() const noexcept
+        {
+            return _socket_path;
+        }
+
+    private:
+        [[noreturn]] static void throw_last_error(const char *what)
+        {
+            throw std::system_error{errno, std::generic_category(), what};
+        }
+
+        // Only waits for the processes started by this class, so other child processes of the
+        // application are not affected.
+        void reap_processes() noexcept
+        {
+            std::erase_if(_processes, [](pid_t pid)
+                {
+                    return waitpid(pid, nullptr, WNOHANG) != 0;
+                });
+        }
+
+        void set_timeout(int connection) const noexcept
+        {
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(_request_timeout);
+            auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(_request_timeout - seconds);
+            timeval timeout{static_cast<time_t>(seconds.count()), static_cast<suseconds_t>(microseconds.count())};
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+
+        static void flush_standard_streams()
+        {
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(nullptr);
+        }
+
+        // The caches for the console width and the terminal capabilities, and the end-of-file
+        // state of the standard input, belong to the streams that were just replaced.
+        static void reset_console_state() noexcept
+        {
+            console_width_cache::invalidate();
+            vt::capability_cache::reset(standard_stream::output);
+            vt::capability_cache::reset(standard_stream::error);
+            clearerr(stdin);
+            console_stream<char>::cin().clear();
+        }
+
+        // Reads a request and runs the command. The return value is the exit status for the new
+        // process if commands are isolated, not the exit code of the command. If restore is true,
+        // the standard streams, working directory and environment are restored afterwards.
+        int run_request(int connection, bool restore) noexcept
+        {
+            try
+            {
+                details::host_request_header header;
+                details::unique_fd fds[details::c_host_fd_count];
+                if (!details::receive_with_fds(connection, header, fds))
+                {
+                    return 1;
+                }
+
+                if (header.size > details::c_max_host_request_size)
+                {
+                    return 1;
+                }
+
+                std::string body(header.size, '\0');
+                std::vector<char *> strings;
+                if (!details::read_all(connection, body.data(), body.size()) ||
+                    !details::split_request(body, header, strings))
+                {
+                    return 1;
+                }
+
+                // These must outlive restoring the state, so environ never points to freed memory.
+                auto args = strings.begin() + 1;
+                std::vector<const char *> argv{args, args + header.arg_count};
+                argv.push_back(nullptr);
+                std::vector<char *> env{args + header.arg_count, strings.end()};
+                env.push_back(nullptr);
+
+                std::int32_t exit_code;
+                {
+                    details::unique_fd saved_fds[details::c_host_fd_count];
+                    details::unique_fd saved_directory;
+                    auto saved_environment = environ;
+                    details::scope_exit restore_state;
+                    if (restore)
+                    {
+                        for (int i = 0; i < static_cast<int>(details::c_host_fd_count); ++i)
+                        {
+                            saved_fds[i].reset(fcntl(i, F_DUPFD_CLOEXEC, static_cast<int>(details::c_host_fd_count)));
+                        }
+
+                        saved_directory.reset(open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+                        restore_state.reset([&]()
+                            {
+                                flush_standard_streams();
+                                for (int i = 0; i < static_cast<int>(details::c_host_fd_count); ++i)
+                                {
+                                    if (saved_fds[i].get() >= 0)
+                                    {
+                                        dup2(saved_fds[i].get(), i);
+                                    }
+                                }
+
+                                if (saved_directory.get() >= 0)
+                                {
+                                    [[maybe_unused]] auto result = fchdir(saved_directory.get());
+                                }
+
+                                environ = saved_environment;
+                                reset_console_state();
+                            });
+                    }
+
+                    for (int i = 0; i < static_cast<int>(details::c_host_fd_count); ++i)
+                    {
+                        if (fds[i].get() >= 0)
+                        {
+                            dup2(fds[i].get(), i);
+                        }
+                    }
+
+                    if (chdir(strings[0]) != 0)
+                    {
+                        return 1;
+                    }
+
+                    environ = env.data();
+                    reset_console_state();
+                    exit_code = _function(static_cast<int>(header.arg_count), argv.data());
+
+                    // All output must be written before the client gets the exit code.
+                    flush_standard_streams();
+                }
+
+                // The state of the host is restored before the client gets the exit code, so
+                // nothing the client does next can see the state of the command.
+                details::send_all(connection, &exit_code, sizeof(exit_code));
+                return 0;
+            }
+            catch (...)
+            {
+                return 1;
+            }
+        }
+
+        command_function _function;
+        std::optional<basic_command_shell<char>> _shell;
+        std::filesystem::path _socket_path;
+        details::unique_fd _socket;
+        details::unique_fd _stop_read;
+        details::unique_fd _stop_write;
+        std::vector<pid_t> _processes;
+        std::atomic<bool> _stopped{};
+        std::chrono::milliseconds _request_timeout{std::chrono::seconds{5}};
+        bool _isolate_commands{};
+    };
+
+    //! \brief Runs a command using a command_host.
+    //!
+    //! \warning This function is only available on Linux and other POSIX platforms that provide
+    //!          `accept4()`.
+    //!
+    //! This function sends the arguments, the environment variables and working directory of the
+    //! current process, and the specified file descriptors to the command_host listening on the
+    //! specified socket, and waits until the command finishes.
+    //!
+    //! Typically, this is used in the `main()` function of a client executable, which falls back to
+    //! running the command itself if the host isn't running:
+    //!
+    //! ```
+    //! int main(int argc, char *argv[])
+    //! {
+    //!     if (auto exit_code = ookii::run_hosted_command("/run/user/1000/my_app.sock", argc, argv))
+    //!     {
+    //!         return *exit_code;
+    //!     }
+    //!
+    //!     return create_manager().run_command(argc, argv).value_or(1);
+    //! }
+    //! ```
+    //!
+    //! \param socket_path The path of the socket the command_host is listening on.
+    //! \param argc The number of arguments.
+    //! \param argv The arguments. The first argument is the application name.
+    //! \param input The file descriptor to use as the command's standard input.
+    //! \param output The file descriptor to use as the command's standard output.
+    //! \param error The file descriptor to use as the command's standard error.
+    //! \return The exit code of the command; -1 if the connection was lost before the command
+    //!         finished, for example because it crashed; or `std::nullopt` if the host could not be
+    //!         reached, in which case the command did not run.
+    inline std::optional<int> run_hosted_command(const std::filesystem::path &socket_path, int argc, const char *const argv[],
+        int input = STDIN_FILENO, int output = STDOUT_FILENO, int error = STDERR_FILENO)
+    {
+        auto address = details::make_socket_address(socket_path);
+        details::unique_fd connection{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (connection.get() < 0 || connect(connection.get(), reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            return {};
+        }
+
+        std::error_code ec;
+        auto cwd = std::filesystem::current_path(ec);
+        if (ec)
+        {
+            return {};
+        }
+
+        std::string body{cwd.native()};
+        body.push_back('\0');
+        details::host_request_header header{};
+        std::vector<const char *> args{argv, argv + argc};
+        args.push_back(nullptr);
+        details::append_strings(body, args.data(), header.arg_count);
+        details::append_strings(body, environ, header.env_count);
+        header.size = static_cast<std::uint32_t>(body.size());
+        const int fds[details::c_host_fd_count]{input, output, error};
+        if (!details::send_with_fds(connection.get(), header, fds))
+        {
+            return {};
+        }
+
+        // The command can't run until the host has the whole request.
+        if (!details::send_all(connection.get(), body.data(), body.size()))
+        {
+            return {};
+        }
+
+        std::int32_t exit_code;
+        if (!details::read_all(connection.get(), &exit_code, sizeof(exit_code)))
+        {
+            return -1;
+        }
+
+        return exit_code;
+    }
+}
+
+#endif
@@ -8,8 +8,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <fstream>
 #include <functional>
+#include <iostream>
 #include "command_line_switch.h"
+#include "config_file.h"
+#include "parse_result.h"
 #include "parsing_mode.h"
 
 namespace ookii
@@ -33,6 +38,8 @@ namespace ookii
             string_type name;
             string_type value_description;
             string_type description;
+            string_type environment_variable;
+            string_type value_file_prefix;
             std::optional<size_t> position;
             std::vector<string_type> aliases;
             std::vector<CharType> short_aliases;
@@ -58,6 +65,17 @@ namespace ookii
             converter_type converter;
         };
 
+        template<typename T, typename Element, typename CharType, typename Traits>
+        struct multi_value_argument_storage : public typed_argument_storage<T, Element, CharType, Traits>
+        {
+            using sink_type = std::function<bool(Element &&)>;
+
+            using typed_argument_storage<T, Element, CharType, Traits>::typed_argument_storage;
+
+            std::optional<char> stream_delimiter;
+            sink_type sink;
+        };
+
         template<typename T, typename CharType, typename Traits, typename Alloc>
         struct action_argument_storage
         {
@@ -84,6 +102,12 @@ namespace ookii
         {
             using type = T;
         };
+
+        template<typename T>
+        struct is_string_view : public std::false_type {};
+
+        template<typename CharType, typename Traits>
+        struct is_string_view<std::basic_string_view<CharType, Traits>> : public std::true_type {};
     }
 
     //! \brief The result of attempting to set a value for an argument.
@@ -94,7 +118,27 @@ namespace ookii
         //! \brief There was an error converting the value to the element type of the argument.
         error,
         //! \brief The operation was successful, but has requested that parsing will be cancelled.
-        cancel
+        cancel,
+        //! \brief The value referred to a file that could not be read.
+        file_error,
+        //! \brief One of the limits set on the basic_parser_builder was exceeded.
+        limit_exceeded
+    };
+
+    //! \brief Indicates where the value of an argument came from.
+    enum class value_source
+    {
+        //! \brief The argument has no value, or its value was not changed by the last call to
+        //!        basic_command_line_parser::parse().
+        none,
+        //! \brief The value was supplied on the command line.
+        command_line,
+        //! \brief The value was read from the argument's environment variable.
+        environment,
+        //! \brief The value was read from a configuration file.
+        config_file,
+        //! \brief The argument was not supplied, and its default value was used.
+        default_value
     };
 
     //! \brief Abstract base class for regular and multi-value arguments.
@@ -292,6 +336,37 @@ namespace ookii
             return _has_value;
         }
 
+        //! \brief Gets a value that indicates where the value of the argument came from on the
+        //!        last invocation of basic_command_line_parser::parse().
+        //!
+        //! Values read from an environment variable or a configuration file are treated the same
+        //! as values supplied on the command line, so has_value() returns `true` for them. Use
+        //! this method to tell them apart.
+        value_source source() const noexcept
+        {
+            return _source;
+        }
+
+        //! \brief Gets the name of the environment variable that can supply a value for this
+        //!        argument, or an empty string if there is none.
+        //!
+        //! This value can be set using the basic_parser_builder::argument_builder_common::environment_variable()
+        //! method.
+        const string_type &environment_variable() const noexcept
+        {
+            return _storage.environment_variable;
+        }
+
+        //! \brief Gets the prefix that indicates a value should be read from a file, or an empty
+        //!        string if values can't be read from a file.
+        //!
+        //! This value can be set using the basic_parser_builder::argument_builder_common::allow_value_from_file()
+        //! method.
+        const string_type &value_file_prefix() const noexcept
+        {
+            return _storage.value_file_prefix;
+        }
+
         //! \brief Gets a value that indicates whether the argument is a switch, which means it
         //!        can be supplied without a value.
         //! 
@@ -307,6 +382,20 @@ namespace ookii
             return false;
         }
 
+        //! \brief Gets a value that indicates whether the argument's value refers to the string
+        //!        it was converted from, rather than holding a copy.
+        //!
+        //! This is `true` for arguments whose element type is `std::basic_string_view`. Their
+        //! values point into the strings passed to basic_command_line_parser::parse(), so those
+        //! strings must remain valid for as long as the values are used. Values read from an
+        //! environment variable or a configuration file, or from temporary strings returned by
+        //! the iterator passed to parse(), are copied into storage owned by the parser, which is
+        //! kept until the next call to parse() or until the parser is destroyed.
+        virtual bool refers_to_input() const noexcept
+        {
+            return false;
+        }
+
         //! \brief Resets the argument to indicate it hasn't been set.
         //!
         //! The reset() method is called on all arguments before parsing. After the call, the
@@ -316,6 +405,26 @@ namespace ookii
         virtual void reset()
         {
             _has_value = false;
+            _source = value_source::none;
+        }
+
+        //! \brief Stores a copy of the current value of the variable holding the argument's value,
+        //!        so it can be restored using restore_initial_value().
+        //!
+        //! This is used to reuse a parser and its variables for more than one parse operation,
+        //! without values from a previous operation remaining in arguments that weren't supplied
+        //! and have no default value. The default implementation does nothing.
+        virtual void capture_initial_value()
+        {
+        }
+
+        //! \brief Restores the variable holding the argument's value to the value stored by
+        //!        capture_initial_value().
+        //!
+        //! If capture_initial_value() was not called, this does nothing. The default
+        //! implementation does nothing.
+        virtual void restore_initial_value()
+        {
         }
 
         //! \brief Sets the argument to the specified value.
@@ -413,7 +522,10 @@ namespace ookii
         }
 
     private:
+        friend parser_type;
+
         storage_type _storage;
+        value_source _source{};
         bool _has_value{};
     };
 
@@ -473,6 +585,12 @@ namespace ookii
             return details::is_switch<T>::value;
         }
 
+        //! \copydoc base_type::refers_to_input()
+        bool refers_to_input() const noexcept override
+        {
+            return details::is_string_view<element_type>::value;
+        }
+
         //! \copydoc base_type::set_value()
         set_value_result set_value(string_view_type value, parser_type &parser) override
         {
@@ -522,6 +640,26 @@ namespace ookii
             return _storage.default_value.has_value();
         }
 
+        //! \copydoc base_type::capture_initial_value()
+        //!
+        //! The value is only stored if the argument's type is copy assignable.
+        void capture_initial_value() override
+        {
+            if constexpr (std::is_copy_assignable_v<value_type>)
+            {
+                _initial_value = _storage.value;
+            }
+        }
+
+        //! \copydoc base_type::restore_initial_value()
+        void restore_initial_value() override
+        {
+            if (_initial_value)
+            {
+                _storage.value = *_initial_value;
+            }
+        }
+
     private:
         template<typename T2 = T>
         std::enable_if_t<details::is_switch<T2>::value, set_value_result> set_switch_value_core()
@@ -538,6 +676,7 @@ namespace ookii
         }
 
         typed_storage_type _storage;
+        std::optional<value_type> _initial_value;
     };
 
     //! \brief Class that provides information about arguments that are not multi-value arguments.
@@ -564,7 +703,7 @@ namespace ookii
         //! \copydoc base_type::string_view_type
         using string_view_type = typename base_type::string_view_type;
         //! \copydoc base_type::storage_type
-        using typed_storage_type = details::typed_argument_storage<T, element_type, CharType, Traits>;
+        using typed_storage_type = details::multi_value_argument_storage<T, element_type, CharType, Traits>;
         //! \copydoc base_type::parser_type
         using parser_type = typename base_type::parser_type;
 
@@ -588,6 +727,12 @@ namespace ookii
             return details::is_switch<element_type>::value;
         }
 
+        //! \copydoc base_type::refers_to_input()
+        bool refers_to_input() const noexcept override
+        {
+            return details::is_string_view<element_type>::value;
+        }
+
         //! \copydoc base_type::is_multi_value()
         //!
         //! This method always returns `true`.
@@ -605,28 +750,49 @@ namespace ookii
             return this->base_storage().multi_value_separator;
         }
 
+        //! \brief Gets the character that separates the values read from a stream, or std::nullopt
+        //!        if the argument's values are not read from a stream.
+        //!
+        //! The delimiter can be specified using basic_parser_builder::multi_value_argument_builder::values_from_stream().
+        std::optional<char> stream_delimiter() const noexcept
+        {
+            return _storage.stream_delimiter;
+        }
+
         //! \copydoc base_type::reset()
         void reset() override
         {
             base_type::reset();
             _storage.value.clear();
+            _value_count = 0;
         }
 
         //! \copydoc base_type::set_value()
+        //!
+        //! If the argument's values are read from a stream, \a value is the path of a file, or
+        //! "-" to read from the standard input stream, and all the values in the stream are added.
         set_value_result set_value(string_view_type value, parser_type &parser) override
         {
-            for (auto element : tokenize{value, separator()})
+            if (_storage.stream_delimiter)
             {
-                std::optional<element_type> converted;
-                if (_storage.converter)
-                    converted = _storage.converter(element, parser.locale());
-                else
-                    converted = lexical_convert<element_type, CharType, Traits, Alloc>::from_string(element, parser.locale());
+                auto result = read_value_stream(value, parser);
+                if (result == set_value_result::success)
+                {
+                    base_type::set_value();
+                }
 
-                if (!converted)
-                    return set_value_result::error;
+                return result;
+            }
+
+            // The number of values is checked before any of them are converted.
+            auto count = separator() == 0 ? 1 : static_cast<size_t>(std::count(value.begin(), value.end(), separator())) + 1;
+            if (parser.check_value_count(_value_count + count) != parse_error::none)
+                return set_value_result::limit_exceeded;
 
-                _storage.value.push_back(std::move(*converted));
+            for (auto element : tokenize{value, separator()})
+            {
+                if (!add_value(element, parser))
+                    return set_value_result::error;
             }
 
             base_type::set_value();
@@ -634,9 +800,9 @@ namespace ookii
         }
 
         //! \copydoc base_type::set_switch_value()
-        set_value_result set_switch_value([[maybe_unused]] parser_type &parser) override
+        set_value_result set_switch_value(parser_type &parser) override
         {
-            return set_switch_value_core();
+            return set_switch_value_core(parser);
         }
 
         //! \copydoc base_type::apply_default_value()
@@ -666,21 +832,93 @@ namespace ookii
         }
 
     private:
+        bool add_value(string_view_type value, parser_type &parser)
+        {
+            ++_value_count;
+            std::optional<element_type> converted;
+            if (_storage.converter)
+                converted = _storage.converter(value, parser.locale());
+            else
+                converted = lexical_convert<element_type, CharType, Traits, Alloc>::from_string(value, parser.locale());
+
+            if (!converted)
+                return false;
+
+            if (_storage.sink)
+                return _storage.sink(std::move(*converted));
+
+            _storage.value.push_back(std::move(*converted));
+            return true;
+        }
+
+        set_value_result read_value_stream(string_view_type path, parser_type &parser)
+        {
+            std::ifstream file;
+            std::streambuf *stream;
+            if (path.size() == 1 && path[0] == '-')
+            {
+                stream = std::cin.rdbuf();
+            }
+            else
+            {
+                file.open(std::filesystem::path{path}, std::ios::binary);
+                if (!file)
+                {
+                    return set_value_result::file_error;
+                }
+
+                stream = file.rdbuf();
+            }
+
+            auto limit_exceeded = false;
+            auto success = details::for_each_delimited_value(*stream, *_storage.stream_delimiter, parser.value_length_budget(), [&](std::string_view value)
+            {
+                if (parser.check_value_count(_value_count + 1) != parse_error::none ||
+                    parser.check_value_limits(value.size()) != parse_error::none)
+                {
+                    limit_exceeded = true;
+                    return false;
+                }
+
+                if constexpr (std::is_same_v<CharType, char>)
+                {
+                    return add_value(string_view_type{value.data(), value.size()}, parser);
+                }
+                else
+                {
+                    auto converted = string_convert<CharType, Traits, Alloc>::from_bytes(value, parser.locale());
+                    return add_value(converted, parser);
+                }
+            });
+
+            if (limit_exceeded)
+                return set_value_result::limit_exceeded;
+
+            return success ? set_value_result::success : set_value_result::error;
+        }
+
         template<typename T2 = element_type>
-        std::enable_if_t<details::is_switch<T2>::value, set_value_result> set_switch_value_core()
+        std::enable_if_t<details::is_switch<T2>::value, set_value_result> set_switch_value_core(parser_type &parser)
         {
+            if (parser.check_value_count(_value_count + 1) != parse_error::none)
+                return set_value_result::limit_exceeded;
+
+            ++_value_count;
             _storage.value.push_back(true);
             base_type::set_value();
             return set_value_result::success;
         }
 
         template<typename T2 = element_type>
-        std::enable_if_t<!details::is_switch<T2>::value, set_value_result> set_switch_value_core()
+        std::enable_if_t<!details::is_switch<T2>::value, set_value_result> set_switch_value_core(parser_type &)
         {
             return set_value_result::error;
         }
 
         typed_storage_type _storage;
+
+        // Counts the values added since the last reset, including those passed to a sink.
+        size_t _value_count{};
     };
 
     //! \brief Class that provides information about action arguments.
@@ -79,10 +79,14 @@ namespace ookii
         using parser_type = basic_command_line_parser<CharType, Traits, Alloc>;
         //! \copydoc parser_type::string_type
         using string_type = typename parser_type::string_type;
+        //! \copydoc parser_type::string_view_type
+        using string_view_type = typename parser_type::string_view_type;
         //! \copydoc parser_type::argument_base_type
         using argument_base_type = typename parser_type::argument_base_type;
         //! \copydoc parser_type::string_provider_type
         using string_provider_type = typename parser_type::string_provider_type;
+        //! \brief The specialized type of basic_usage_cache_key used.
+        using usage_cache_key_type = typename parser_type::usage_cache_type::key_type;
         //! \brief The function type used by the add_version_argument function.
         using version_function = std::function<void()>;
 
@@ -417,6 +421,62 @@ namespace ookii
                 this->storage().cancel_parsing = true;
                 return *static_cast<BuilderType*>(this);
             }
+
+            //! \brief Sets the name of an environment variable that can supply the argument's value.
+            //! \param name The name of the environment variable.
+            //!
+            //! If the argument is not supplied on the command line, and the environment variable
+            //! is set, its value is used as if the argument had been supplied. The value is
+            //! converted the same way as a value from the command line, and an invalid value
+            //! causes parse_error::invalid_value. For a switch argument, an empty value sets the
+            //! switch.
+            //!
+            //! For a multi-value argument, the value is used as a single value, unless a separator
+            //! was set using multi_value_argument_builder::separator().
+            //!
+            //! An environment variable takes precedence over a configuration file specified
+            //! using basic_parser_builder::config_file().
+            BuilderType &environment_variable(string_type name)
+            {
+                this->storage().environment_variable = name;
+                return *static_cast<BuilderType*>(this);
+            }
+
+            //! \brief Allows the argument's value to be read from a file.
+            //! \param prefix The prefix that indicates a value is the path of a file. Defaults to
+            //!        "@".
+            //!
+            //! If a value for this argument starts with \a prefix, the rest of the value is used
+            //! as the path of a file, and the contents of that file are converted as the
+            //! argument's value. This can be used for large values, like certificates or JSON
+            //! documents, that are inconvenient to supply on the command line.
+            //!
+            //! The file is memory mapped rather than read into a string, and the mapping stays
+            //! valid until the next call to basic_command_line_parser::parse(), or until the
+            //! parser is destroyed. For an argument whose type is `std::basic_string_view`, the
+            //! value refers directly to the mapped file, so the file must not be truncated while
+            //! the value is in use. If the character type is not `char`, the contents are
+            //! converted using the parser's locale, and the value refers to a converted copy.
+            //!
+            //! If the file can't be opened, parsing fails with parse_error::unreadable_value_file.
+            //! The size of the file counts towards basic_parser_builder::max_value_length() and
+            //! basic_parser_builder::max_total_value_length().
+            //!
+            //! \warning Any file the process can read can be used this way, so don't use this
+            //!          for an argument whose value can come from untrusted input, such as a
+            //!          request from another user, unless that input is checked first.
+            //!
+            //! \exception std::invalid_argument \a prefix is empty.
+            BuilderType &allow_value_from_file(string_type prefix = string_type(1, '@'))
+            {
+                if (prefix.empty())
+                {
+                    throw std::invalid_argument("prefix");
+                }
+
+                this->storage().value_file_prefix = prefix;
+                return *static_cast<BuilderType*>(this);
+            }
         };
 
         //! \brief Specifies options for a regular or multi-value argument under construction.
@@ -491,6 +551,13 @@ namespace ookii
                 return *static_cast<BuilderType*>(this);
             }
 
+        protected:
+            //! \brief Provides access to the argument's type-specific options storage.
+            typed_storage_type &typed_storage() noexcept
+            {
+                return _typed_storage;
+            }
+
         private:
             virtual std::unique_ptr<argument_base_type> to_argument(parser_type &parser) override
             {
@@ -520,8 +587,12 @@ namespace ookii
         class multi_value_argument_builder final : public typed_argument_builder<multi_value_argument_type<T>, multi_value_argument_builder<T>>
         {
             using base_type = typed_argument_builder<multi_value_argument_type<T>, multi_value_argument_builder<T>>;
+            using element_type = typename multi_value_argument_type<T>::element_type;
             
         public:
+            //! \brief The type of a function that receives the values read from a stream.
+            using sink_type = typename multi_value_argument_type<T>::typed_storage_type::sink_type;
+
             using base_type::base_type;
 
             //! \brief Specifies a separator that separates multiple values in a single argument
@@ -542,6 +613,54 @@ namespace ookii
                 this->storage().multi_value_separator = separator;
                 return *this;
             }
+
+            //! \brief Indicates that the argument's values are the paths of streams that contain
+            //!        the actual values.
+            //! \param delimiter The character that separates the values in the stream. Use '\n'
+            //!        for one value per line, or '\0' for the output of e.g. `find -print0`.
+            //!
+            //! Every value supplied for this argument is treated as the path of a file, or "-" to
+            //! read from the standard input stream, and all the values in that stream are
+            //! converted and added to the container. For example, `--files-from -` reads a list of
+            //! files from the standard input. Empty values are skipped, and with '\n' as the
+            //! delimiter, a '\r' at the end of a line is removed.
+            //!
+            //! To use the values read from a stream in addition to values supplied directly, bind
+            //! both this argument and a regular multi-value argument to the same container.
+            //!
+            //! The stream is read in large blocks, and values are converted straight from the
+            //! block without allocating a string for each value if the character type is `char`.
+            //! If the file can't be opened, parsing fails with parse_error::unreadable_value_file.
+            //!
+            //! Because the values would refer to a buffer that is reused, this overload can't be
+            //! used if the element type is `std::basic_string_view`; use the overload that takes
+            //! a sink instead.
+            multi_value_argument_builder &values_from_stream(char delimiter = '\n')
+            {
+                static_assert(!details::is_string_view<element_type>::value,
+                    "Values read from a stream can't be stored as string views; use a sink instead.");
+
+                this->typed_storage().stream_delimiter = delimiter;
+                return *this;
+            }
+
+            //! \brief Indicates that the argument's values are the paths of streams that contain
+            //!        the actual values, which are passed to a function instead of being stored.
+            //! \param sink A function with the signature `bool(T &&value)` that is called for
+            //!        every value read from the stream. Return `false` to stop reading, in which
+            //!        case parsing fails with parse_error::invalid_value.
+            //! \param delimiter The character that separates the values in the stream.
+            //!
+            //! This works the same as values_from_stream(char), except the container is left
+            //! empty, so the memory used doesn't depend on the number of values in the stream. If
+            //! the element type is `std::basic_string_view`, the value is only valid during the
+            //! call to \a sink.
+            multi_value_argument_builder &values_from_stream(sink_type sink, char delimiter = '\n')
+            {
+                this->typed_storage().stream_delimiter = delimiter;
+                this->typed_storage().sink = std::move(sink);
+                return *this;
+            }
         };
 
         //! \brief Specifies options for an action argument.
@@ -868,7 +987,13 @@ namespace ookii
                 }
             }
 
-            return parser_type{_arguments, std::move(_storage), _options};
+            parser_type parser{_arguments, std::move(_storage), _options};
+            for (auto &[key, usage] : _prerendered_usage)
+            {
+                parser.usage_cache().store_static(std::move(key), usage);
+            }
+
+            return parser;
         }
 
         //! \brief Sets a value that indicates whether argument names are case sensitive.
@@ -1001,6 +1126,73 @@ namespace ookii
             return *this;
         }
 
+        //! \brief Sets the maximum number of arguments that the command line may contain.
+        //! \param count The maximum number of arguments, or zero for no limit.
+        //! \return A reference to this basic_parser_builder.
+        //!
+        //! This, and the other limits, can be used to protect against resource exhaustion when
+        //! parsing command lines from an untrusted source. Every item in the range passed to
+        //! basic_command_line_parser::parse() counts, including argument names and values. If
+        //! the limit is exceeded, parsing fails with parse_error::too_many_tokens before the
+        //! next argument is processed.
+        //!
+        //! The default value is zero.
+        basic_parser_builder &max_token_count(size_t count) noexcept
+        {
+            _storage.max_token_count = count;
+            return *this;
+        }
+
+        //! \brief Sets the maximum length of a single argument value.
+        //! \param length The maximum length, in characters, or zero for no limit.
+        //! \return A reference to this basic_parser_builder.
+        //!
+        //! The length is checked before the value is converted, and applies to values from any
+        //! source. For a multi-value argument with a separator, it applies to the value before
+        //! it's split. For a file used with argument_builder_common::allow_value_from_file(),
+        //! the size of the file in bytes is checked, and for values read from a stream using
+        //! multi_value_argument_builder::values_from_stream(), each value is checked, and a
+        //! value that is too long is not read completely. If the limit is exceeded, parsing
+        //! fails with parse_error::value_too_long.
+        //!
+        //! The default value is zero.
+        basic_parser_builder &max_value_length(size_t length) noexcept
+        {
+            _storage.max_value_length = length;
+            return *this;
+        }
+
+        //! \brief Sets the maximum number of values that a multi-value argument may have.
+        //! \param count The maximum number of values, or zero for no limit.
+        //! \return A reference to this basic_parser_builder.
+        //!
+        //! The count is checked before a value is converted, including values in a single
+        //! argument that uses a separator, and values read from a stream. If the limit is
+        //! exceeded, parsing fails with parse_error::too_many_values.
+        //!
+        //! The default value is zero.
+        basic_parser_builder &max_value_count(size_t count) noexcept
+        {
+            _storage.max_value_count = count;
+            return *this;
+        }
+
+        //! \brief Sets the maximum combined length of all values that are converted during a
+        //!        single call to basic_command_line_parser::parse().
+        //! \param length The maximum combined length, in characters, or zero for no limit.
+        //! \return A reference to this basic_parser_builder.
+        //!
+        //! Each value is added to the total before it's converted, the same way as for
+        //! max_value_length(). If the limit is exceeded, parsing fails with
+        //! parse_error::total_value_length_exceeded.
+        //!
+        //! The default value is zero.
+        basic_parser_builder &max_total_value_length(size_t length) noexcept
+        {
+            _storage.max_total_value_length = length;
+            return *this;
+        }
+
         //! \brief Sets the character used to separate argument names and values.
         //! \param separator The haracter used to separate argument names and values.
         //! \return A reference to this basic_parser_builder.
@@ -1066,6 +1258,55 @@ namespace ookii
             return *this;
         }
 
+        //! \brief Adds usage help that was rendered ahead of time to the usage cache of the parser.
+        //!
+        //! This is used by code generated by the New-Parser.ps1 script, so that usage help can be
+        //! written without formatting it at runtime. The text is only used by a basic_usage_writer
+        //! whose basic_usage_writer::use_usage_cache field is `true`, and only if its output
+        //! matches the name, line width, color setting, usage_help_request and locale of \a key.
+        //!
+        //! The text is not copied, so it must outlive the parser; the generated code uses string
+        //! literals.
+        //!
+        //! \param key The key identifying the usage help.
+        //! \param usage The rendered usage help.
+        //! \return A reference to this basic_parser_builder.
+        basic_parser_builder &prerendered_usage(usage_cache_key_type key, string_view_type usage)
+        {
+            _prerendered_usage.emplace_back(std::move(key), usage);
+            return *this;
+        }
+
+        //! \brief Adds a configuration file that can supply values for arguments.
+        //! \param path The path of the file.
+        //! \return A reference to this basic_parser_builder.
+        //!
+        //! The file is read every time basic_command_line_parser::parse() is called. Each line
+        //! has the form `name=value`, where the name is the name or an alias of an argument.
+        //! White space around the name and value is ignored, as are empty lines and lines starting
+        //! with `#` or `;`. A line with only a name and no `=` character sets a switch argument.
+        //!
+        //! Values from the file are only used for arguments that were not supplied on the command
+        //! line or by their environment variable (see
+        //! basic_parser_builder::argument_builder_common::environment_variable()), and are
+        //! converted the same way as values from the command line. Multi-value arguments can be
+        //! listed more than once.
+        //!
+        //! This method can be called multiple times. The files are read in the order they were
+        //! added, and an argument set by an earlier file is not changed by a later one, so add
+        //! the most specific file first.
+        //!
+        //! A file that does not exist or can't be read is skipped. A name that doesn't match any
+        //! argument causes parse_error::unknown_argument.
+        //!
+        //! On platforms that support it, the file is memory mapped, and for `char` the values are
+        //! passed to the argument's converter without being copied.
+        basic_parser_builder &config_file(std::filesystem::path path)
+        {
+            _storage.config_files.push_back(std::move(path));
+            return *this;
+        }
+
     private:
         size_t get_next_position() noexcept
         {
@@ -1078,6 +1319,7 @@ namespace ookii
         
         creation_options_type _options{};
         parser_storage_type _storage;
+        std::vector<std::pair<usage_cache_key_type, string_view_type>> _prerendered_usage;
 
         static constexpr auto c_default_long_prefix = literal_cast<CharType>("--");
     };
@@ -25,23 +25,47 @@
 //! parse() method, which will parse the arguments and handle errors. The New-Parser.ps1 script
 //! generates the definition of the build() method; the parse() method is defined by this macro.
 //! 
+//! If no basic_usage_writer is passed to the parse() method and usage help was embedded using the
+//! `-UsageCachePath` parameter of New-Parser.ps1, it uses one with the
+//! basic_usage_writer::use_usage_cache field set to `true`, so that the embedded usage help can be
+//! used.
+//!
+//! If the type has a parse_direct() method, declared using OOKII_GENERATED_DIRECT_METHODS_EX, the
+//! parse() method calls it first, and only builds a parser if it returns `false`.
+//! 
 //! \param type The type of the struct or class that contains the arguments.
 //! \param char_type The character type to use for strings.
 #define OOKII_GENERATED_METHODS_EX(type, char_type) \
     static ::std::optional<type> parse(int argc, const char_type* const argv[], ::ookii::basic_usage_writer<char_type> *usage = nullptr, \
         ::ookii::basic_localized_string_provider<char_type> *string_provider = nullptr, const std::locale &locale = {}) \
     { \
-        auto name = ::ookii::basic_command_line_parser<char_type>::get_executable_name(argc, argv); \
-        type args{}; \
-        auto parser = args.create_builder(name, string_provider, locale).build(); \
-        if (parser.parse(argc, argv, usage)) \
-        { \
-            return args; \
-        } \
-        return {}; \
+        return ::ookii::details::parse_generated<type, char_type>(argc, argv, usage, string_provider, locale); \
     } \
     OOKII_DECLARE_CREATE_BUILDER_METHOD_EX(char_type)
 
+//! \brief A macro to declare the parse_direct() method that the New-Parser.ps1 script will
+//!        generate when using the `-DirectParse` parameter, using the specified character type.
+//!
+//! \param char_type The character type to use for strings.
+#define OOKII_DECLARE_PARSE_DIRECT_METHOD_EX(char_type) \
+    bool parse_direct(::std::span<const char_type *const> args, const ::std::locale &locale)
+
+//! \brief A macro to declare the methods that a struct used with the `-DirectParse` parameter of
+//! New-Parser.ps1 must have, using the specified character type.
+//!
+//! This declares the same methods as OOKII_GENERATED_METHODS_EX, and a parse_direct() method,
+//! whose definition is generated by New-Parser.ps1. The parse_direct() method parses the
+//! arguments without creating a basic_command_line_parser, using code generated for the specific
+//! arguments. It only handles command lines that parse successfully; if it returns `false`, the
+//! parse() method builds a parser and parses the arguments again, which handles errors and usage
+//! help as normal.
+//!
+//! \param type The type of the struct or class that contains the arguments.
+//! \param char_type The character type to use for strings.
+#define OOKII_GENERATED_DIRECT_METHODS_EX(type, char_type) \
+    OOKII_GENERATED_METHODS_EX(type, char_type); \
+    OOKII_DECLARE_PARSE_DIRECT_METHOD_EX(char_type)
+
 //! \brief A macro to declare the static build() method that the New-Parser.ps1 script will
 //!        generate, using the specified character type.
 //! 
@@ -63,6 +87,14 @@
 //! \param type The type of the struct or class that contains the arguments.
 #define OOKII_GENERATED_METHODS(type) OOKII_GENERATED_METHODS_EX(type, ookii::details::default_char_type)
 
+//! \brief A macro to declare the methods that a struct used with the `-DirectParse` parameter of
+//! New-Parser.ps1 must have, using the default character type.
+//!
+//! The default character type is `wchar_t` if _UNICODE is defined; otherwise, it's `char`.
+//!
+//! \param type The type of the struct or class that contains the arguments.
+#define OOKII_GENERATED_DIRECT_METHODS(type) OOKII_GENERATED_DIRECT_METHODS_EX(type, ookii::details::default_char_type)
+
 namespace ookii
 {
     //! \brief Function that registers all the subcommands generated by New-Subcommand.ps1.
@@ -84,4 +116,317 @@ namespace ookii
         const std::locale& locale = {});
 }
 
+namespace ookii::details
+{
+    // Implements the parse() method declared by OOKII_GENERATED_METHODS_EX. This is a template so
+    // the check for a parse_direct() method is only done once the type is complete, and the call
+    // isn't compiled for types that don't have one.
+    template<typename T, typename CharType>
+    std::optional<T> parse_generated(int argc, const CharType *const argv[], basic_usage_writer<CharType> *usage,
+        basic_localized_string_provider<CharType> *string_provider, const std::locale &locale)
+    {
+        if constexpr (requires (T &value) { value.parse_direct(std::span<const CharType *const>{}, locale); })
+        {
+            T direct_args{};
+            if (argc > 0 && direct_args.parse_direct(std::span{argv + 1, static_cast<size_t>(argc - 1)}, locale))
+            {
+                return direct_args;
+            }
+        }
+
+        auto name = basic_command_line_parser<CharType>::get_executable_name(argc, argv);
+        T args{};
+        auto parser = args.create_builder(name, string_provider, locale).build();
+        std::optional<basic_usage_writer<CharType>> default_usage;
+        if (usage == nullptr)
+        {
+            usage = &default_usage.emplace();
+            usage->use_usage_cache = parser.usage_cache().size() > 0;
+        }
+
+        if (parser.parse(argc, argv, usage))
+        {
+            return args;
+        }
+
+        return {};
+    }
+
+    // Describes an argument for a parse_direct() method generated by New-Parser.ps1.
+    struct direct_argument
+    {
+        static constexpr unsigned none = 0;
+        static constexpr unsigned required = 1;
+        static constexpr unsigned positional = 2;
+        static constexpr unsigned multi_value = 4;
+        static constexpr unsigned cancel_parsing = 8;
+        static constexpr unsigned has_default = 16;
+
+        unsigned flags;
+        bool switch_argument;
+
+        template<typename T>
+        static constexpr direct_argument create(unsigned flags) noexcept
+        {
+            return {flags, is_switch<T>::value};
+        }
+
+        template<typename T>
+        static constexpr direct_argument create_multi_value(unsigned flags) noexcept
+        {
+            return {flags | multi_value, is_switch<typename T::value_type>::value};
+        }
+
+        constexpr bool has(unsigned flag) const noexcept
+        {
+            return (flags & flag) != 0;
+        }
+    };
+
+    template<typename CharType, typename Traits = std::char_traits<CharType>>
+    std::span<const std::basic_string_view<CharType, Traits>> direct_default_prefixes() noexcept
+    {
+        static constexpr auto dash = literal_cast<CharType>("-");
+#ifdef _WIN32
+        static constexpr auto slash = literal_cast<CharType>("/");
+        static constexpr std::basic_string_view<CharType, Traits> prefixes[] = { {dash.data(), 1}, {slash.data(), 1} };
+#else
+        static constexpr std::basic_string_view<CharType, Traits> prefixes[] = { {dash.data(), 1} };
+#endif
+        return prefixes;
+    }
+
+    // Sets an argument's value for a parse_direct() method, using the same conversion as the
+    // command_line_argument class. A missing value means the argument is a switch.
+    template<typename T, typename CharType, typename Traits>
+    bool direct_set_value(T &target, std::optional<std::basic_string_view<CharType, Traits>> value, const std::locale &loc)
+    {
+        if (!value)
+        {
+            if constexpr (is_switch<T>::value)
+            {
+                target = true;
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        using value_type = typename element_type<T>::type;
+        auto converted = lexical_convert<value_type, CharType, Traits>::from_string(*value, loc);
+        if (!converted)
+        {
+            return false;
+        }
+
+        target = std::move(*converted);
+        return true;
+    }
+
+    // Adds a value to a multi-value argument for a parse_direct() method, using the same
+    // conversion as the multi_value_command_line_argument class.
+    template<typename T, typename CharType, typename Traits>
+    bool direct_add_value(T &target, std::optional<std::basic_string_view<CharType, Traits>> value, const std::locale &loc)
+    {
+        using value_type = typename T::value_type;
+        if (!value)
+        {
+            if constexpr (is_switch<value_type>::value)
+            {
+                target.push_back(true);
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        auto converted = lexical_convert<value_type, CharType, Traits>::from_string(*value, loc);
+        if (!converted)
+        {
+            return false;
+        }
+
+        target.push_back(std::move(*converted));
+        return true;
+    }
+
+    // Parses arguments for a parse_direct() method generated by New-Parser.ps1, following the same
+    // rules as basic_command_line_parser in the default parsing mode. The generated code provides
+    // the functions that look up names and set values, so no parser or arguments are created.
+    //
+    // This only handles command lines that parse successfully; it returns false as soon as
+    // anything happens that the full parser would report, such as an unknown argument, an invalid
+    // value, or an argument that cancels parsing. The arguments may have been partially set in
+    // that case, so the caller must parse them again using a new instance.
+    template<typename CharType, typename Id, size_t Count, typename Traits = std::char_traits<CharType>>
+    class direct_parser
+    {
+    public:
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+
+        direct_parser(std::span<const direct_argument, Count> arguments, std::span<const Id> positional,
+            std::span<const string_view_type> prefixes, const std::locale &loc)
+            : _arguments{arguments},
+              _positional{positional},
+              _prefixes{prefixes},
+              _locale{loc},
+              _ctype{std::use_facet<std::ctype<CharType>>(loc)}
+        {
+        }
+
+        // Options that are changed from their defaults by the generated code. The prefixes must
+        // be sorted by descending length.
+        CharType argument_value_separator{':'};
+        bool allow_white_space_separator{true};
+        bool allow_duplicate_arguments{};
+        bool case_sensitive{};
+
+        // Compares an argument name, using the parser's case sensitivity.
+        bool name_equals(string_view_type name, string_view_type expected) const noexcept
+        {
+            if (case_sensitive)
+            {
+                return name == expected;
+            }
+
+            return std::equal(name.begin(), name.end(), expected.begin(), expected.end(), [this](CharType left, CharType right)
+                {
+                    return _ctype.toupper(left) == _ctype.toupper(right);
+                });
+        }
+
+        // Find is called with a name and returns std::optional<Id>, Set is called with an Id and
+        // std::optional<string_view_type> and returns bool, and SetDefault is called with the Id
+        // of every argument that has a default value but wasn't set.
+        template<typename Find, typename Set, typename SetDefault>
+        bool parse(std::span<const CharType *const> args, Find find, Set set, SetDefault set_default)
+        {
+            std::array<bool, Count> has_value{};
+            size_t position = 0;
+            for (auto current = args.begin(); current != args.end(); ++current)
+            {
+                string_view_type arg{*current};
+                auto stripped = check_prefix(arg);
+                if (stripped)
+                {
+                    auto [name, value] = split_once(*stripped, argument_value_separator);
+                    auto id = find(name);
+                    if (!id)
+                    {
+                        return false;
+                    }
+
+                    if (!value && !_arguments[index(*id)].switch_argument)
+                    {
+                        auto value_it = current;
+                        if (!allow_white_space_separator || ++value_it == args.end() || check_prefix(string_view_type{*value_it}))
+                        {
+                            return false;
+                        }
+
+                        current = value_it;
+                        value = string_view_type{*current};
+                    }
+
+                    if (!set_value(*id, value, has_value, set))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    while (position < _positional.size() &&
+                        !_arguments[index(_positional[position])].has(direct_argument::multi_value) &&
+                        has_value[index(_positional[position])])
+                    {
+                        ++position;
+                    }
+
+                    if (position >= _positional.size() || !set_value(_positional[position], arg, has_value, set))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < Count; ++i)
+            {
+                if (!has_value[i])
+                {
+                    if (_arguments[i].has(direct_argument::required))
+                    {
+                        return false;
+                    }
+
+                    if (_arguments[i].has(direct_argument::has_default))
+                    {
+                        set_default(static_cast<Id>(i));
+                    }
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        static constexpr size_t index(Id id) noexcept
+        {
+            return static_cast<size_t>(id);
+        }
+
+        std::optional<string_view_type> check_prefix(string_view_type argument) const
+        {
+            // Same as basic_command_line_parser: a '-' followed by a digit is a negative number.
+            if (argument.length() >= 2 && argument[0] == '-' && std::isdigit(argument[1], _locale))
+            {
+                return {};
+            }
+
+            for (auto prefix : _prefixes)
+            {
+                if (argument.starts_with(prefix))
+                {
+                    if (argument.size() == 1 && argument[0] == '-')
+                    {
+                        return {};
+                    }
+
+                    return argument.substr(prefix.size());
+                }
+            }
+
+            return {};
+        }
+
+        template<typename Set>
+        bool set_value(Id id, std::optional<string_view_type> value, std::array<bool, Count> &has_value, Set &set)
+        {
+            const auto &argument = _arguments[index(id)];
+            if (!allow_duplicate_arguments && !argument.has(direct_argument::multi_value) && has_value[index(id)])
+            {
+                return false;
+            }
+
+            // The full parser shows usage help when parsing is cancelled.
+            if (argument.has(direct_argument::cancel_parsing) || !set(id, value))
+            {
+                return false;
+            }
+
+            has_value[index(id)] = true;
+            return true;
+        }
+
+        std::span<const direct_argument, Count> _arguments;
+        std::span<const Id> _positional;
+        std::span<const string_view_type> _prefixes;
+        const std::locale &_locale;
+        const std::ctype<CharType> &_ctype;
+    };
+}
+
 #endif
\ No newline at end of file
@@ -8,9 +8,13 @@
 
 #pragma once
 
+#include <array>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <filesystem>
 #include "command_line_argument.h"
+#include "config_file.h"
 #include "usage_writer.h"
 #include "parse_result.h"
 #include "range_helper.h"
@@ -43,12 +47,17 @@ namespace ookii
             string_type command_name;
             string_type description;
             std::vector<string_type> prefixes;
+            std::vector<std::filesystem::path> config_files;
             string_type long_prefix;
             std::locale locale;
             const string_provider_type *string_provider;
             parsing_mode mode{};
             CharType argument_value_separator{':'};
             usage_help_request show_usage_on_error{};
+            size_t max_token_count{};
+            size_t max_value_length{};
+            size_t max_value_count{};
+            size_t max_total_value_length{};
             bool allow_white_space_separator{true};
             bool allow_duplicate_arguments{false};
         };
@@ -61,6 +70,17 @@ namespace ookii
             bool case_sensitive{};
             bool automatic_help_argument{true};
         };
+
+        // Lazily computed argument orders for each description_list_sort_mode. This is kept in a
+        // separate allocation so the parser remains movable.
+        template<typename ArgumentType>
+        struct description_order_cache
+        {
+            static constexpr size_t mode_count = static_cast<size_t>(description_list_sort_mode::alphabetical_short_name_descending) + 1;
+
+            std::array<std::once_flag, mode_count> flags;
+            std::array<std::vector<const ArgumentType *>, mode_count> orders;
+        };
     }
 
     //! \brief Value to be returned from the callback passed to the basic_command_line_parser::on_parsed()
@@ -104,6 +124,10 @@ namespace ookii
     template<typename CharType = details::default_char_type, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
     class basic_command_line_parser
     {
+        // Multi-value arguments check the limits for the values they read from a stream.
+        template<typename T, typename C, typename Tr, typename A>
+        friend class multi_value_command_line_argument;
+
     public:
         //! \brief The specialized type of command_line_argument_base used.
         using argument_base_type = command_line_argument_base<CharType, Traits, Alloc>;
@@ -115,6 +139,8 @@ namespace ookii
         using result_type = parse_result<CharType, Traits, Alloc>;
         //! \brief The specialized type of basic_usage_writer used.
         using usage_writer_type = basic_usage_writer<CharType, Traits, Alloc>;
+        //! \brief The specialized type of basic_usage_cache used.
+        using usage_cache_type = basic_usage_cache<CharType, Traits, Alloc>;
         //! \brief The specialized type of parser parameter storage used. For internal use.
         using storage_type = details::parser_storage<CharType, Traits, Alloc>;
         //! \brief The specialized type of parser creation options used. For internal use.
@@ -277,6 +303,40 @@ namespace ookii
             return _storage.allow_duplicate_arguments;
         }
 
+        //! \brief Gets the maximum number of arguments on the command line, or zero if there is no
+        //!        limit.
+        //!
+        //! This value is set by basic_parser_builder::max_token_count()
+        size_t max_token_count() const noexcept
+        {
+            return _storage.max_token_count;
+        }
+
+        //! \brief Gets the maximum length of a single value, or zero if there is no limit.
+        //!
+        //! This value is set by basic_parser_builder::max_value_length()
+        size_t max_value_length() const noexcept
+        {
+            return _storage.max_value_length;
+        }
+
+        //! \brief Gets the maximum number of values of a multi-value argument, or zero if there is
+        //!        no limit.
+        //!
+        //! This value is set by basic_parser_builder::max_value_count()
+        size_t max_value_count() const noexcept
+        {
+            return _storage.max_value_count;
+        }
+
+        //! \brief Gets the maximum combined length of all values, or zero if there is no limit.
+        //!
+        //! This value is set by basic_parser_builder::max_total_value_length()
+        size_t max_total_value_length() const noexcept
+        {
+            return _storage.max_total_value_length;
+        }
+
         //! Indicates the non-whitespace separator used to separaet argument names and values.
         //!
         //! This value is set by basic_parser_builder::argument_value_separator()
@@ -366,6 +426,49 @@ namespace ookii
             return _arguments.size();
         }
 
+        //! \brief Gets all the arguments sorted in the specified description list order.
+        //!
+        //! The order for each mode is determined the first time it is requested, and is then
+        //! cached for the lifetime of the parser, so the basic_usage_writer doesn't need to sort
+        //! the arguments again every time usage help is written. This method can safely be called
+        //! from multiple threads simultaneously.
+        //!
+        //! \param order The order in which to return the arguments.
+        //! \exception std::logic_error The value of \a order is not valid.
+        const std::vector<const argument_base_type *> &arguments_in_order(description_list_sort_mode order) const
+        {
+            auto index = static_cast<size_t>(order);
+            if (index >= _description_orders->mode_count)
+            {
+                throw std::logic_error("Invalid sort mode.");
+            }
+
+            std::call_once(_description_orders->flags[index], [this, order, index]()
+                {
+                    auto &result = _description_orders->orders[index];
+                    result.reserve(_arguments.size());
+                    std::transform(_arguments.begin(), _arguments.end(), std::back_inserter(result),
+                        [](const auto &arg) -> const argument_base_type * { return arg.get(); });
+
+                    if (order != description_list_sort_mode::usage_order)
+                    {
+                        std::sort(result.begin(), result.end(), get_sort_function(order));
+                    }
+                });
+
+            return _description_orders->orders[index];
+        }
+
+        //! \brief Gets the cache used to store rendered usage help for this parser.
+        //!
+        //! The cache is only used by a basic_usage_writer whose basic_usage_writer::use_usage_cache
+        //! field is `true`. Use basic_usage_cache::save() and basic_usage_cache::load() to keep the
+        //! rendered usage help between runs of the application.
+        usage_cache_type &usage_cache() const noexcept
+        {
+            return *_usage_cache;
+        }
+
         //! \brief Gets the comparer used for argument names.
         //!
         //! If the mode() method returns parsing_mode::long_short, this is the argument comparer
@@ -498,6 +601,29 @@ namespace ookii
             return _help_argument;
         }
 
+        //! \brief Stores a copy of the current values of the variables of all arguments, so they
+        //!        can be restored using restore_initial_values().
+        //!
+        //! Call this once, before the first call to parse(), when a parser will be used more
+        //! than once. Parsers that are used only once don't need to keep these copies.
+        void capture_initial_values()
+        {
+            for (auto &arg : _arguments)
+                arg->capture_initial_value();
+        }
+
+        //! \brief Restores the variables of all arguments to the values stored by
+        //!        capture_initial_values().
+        //!
+        //! Call this before parse() when a parser is used more than once, so values from a
+        //! previous operation don't remain in arguments that weren't supplied and have no default
+        //! value. The containers of multi-value arguments are always cleared by parse().
+        void restore_initial_values()
+        {
+            for (auto &arg : _arguments)
+                arg->restore_initial_value();
+        }
+
         //! \brief Parses the arguments in the range specified by the iterators.
         //!
         //! \warning The range indicated by begin, end should *not* include the application name.
@@ -515,17 +641,27 @@ namespace ookii
             for (auto &arg : _arguments)
                 arg->reset();
 
+            _retained_values.clear();
+            _value_files.clear();
+            _total_value_length = 0;
             size_t position = 0;
+            size_t token_count = 0;
             for (auto current = begin; current != end; ++current)
             {
-                auto arg = *current;
+                // Checked before the token is used, since the iterator may create a new string.
+                if (_storage.max_token_count != 0 && ++token_count > _storage.max_token_count)
+                {
+                    return create_result(parse_error::too_many_tokens);
+                }
+
+                auto arg = stable_view(*current);
                 auto prefix = check_prefix(arg);
                 if (prefix)
                 {
                     auto [without_prefix, is_short] = *prefix;
 
                     // Current is updated if parsing used the next argument for a value.
-                    auto result = parse_named_argument(without_prefix, is_short, current, end);
+                    auto result = parse_named_argument(without_prefix, is_short, current, end, token_count);
                     if (!result)
                     {
                         return result;
@@ -555,6 +691,18 @@ namespace ookii
                 }
             }
 
+            auto result = apply_environment_values();
+            if (!result)
+            {
+                return result;
+            }
+
+            result = apply_config_files();
+            if (!result)
+            {
+                return result;
+            }
+
             for (const auto &arg : _arguments)
             {
                 if (arg->is_required())
@@ -567,6 +715,10 @@ namespace ookii
                 else
                 {
                     arg->apply_default_value();
+                    if (!arg->has_value() && arg->has_default_value())
+                    {
+                        arg->_source = value_source::default_value;
+                    }
                 }
             }
 
@@ -955,6 +1107,11 @@ namespace ookii
                 auto stripped = strip_prefix(argument, string_view_type{prefix.prefix});
                 if (stripped)
                 {
+                    // A single "-", which often indicates the standard input, is a value. Other
+                    // prefixes on their own, including "--", are still an error.
+                    if (stripped->empty() && argument.length() == 1 && argument[0] == '-')
+                        return {};
+
                     return make_tuple(*stripped, prefix.is_short);
                 }
             }
@@ -963,7 +1120,7 @@ namespace ookii
         }
 
         template<typename Iterator>
-        result_type parse_named_argument(string_view_type arg_string, bool is_short, Iterator &current, Iterator end)
+        result_type parse_named_argument(string_view_type arg_string, bool is_short, Iterator &current, Iterator end, size_t &token_count)
         {
             auto [name, value] = split_once(arg_string, _storage.argument_value_separator);
             if (is_short && name.length() > 1)
@@ -985,8 +1142,13 @@ namespace ookii
                     return create_result(parse_error::missing_value, arg->name());
                 }
 
+                if (_storage.max_token_count != 0 && ++token_count > _storage.max_token_count)
+                {
+                    return create_result(parse_error::too_many_tokens);
+                }
+
                 current = value_it;
-                value = *current;
+                value = stable_view(*current);
             }
 
             return set_argument_value(*arg, value);
@@ -1028,7 +1190,142 @@ namespace ookii
             return get_argument(name);
         }
 
-        result_type set_argument_value(argument_base_type &arg, std::optional<string_view_type> value)
+        result_type apply_environment_values()
+        {
+            for (const auto &arg : _arguments)
+            {
+                if (arg->has_value() || arg->environment_variable().empty())
+                {
+                    continue;
+                }
+
+                auto value = get_environment_value(arg->environment_variable());
+                if (!value)
+                {
+                    continue;
+                }
+
+                // An empty value just sets a switch argument.
+                std::optional<string_view_type> arg_value;
+                if (!value->empty() || !arg->is_switch())
+                {
+                    if (arg->refers_to_input())
+                    {
+                        arg_value = _retained_values.emplace_back(std::move(*value));
+                    }
+                    else
+                    {
+                        arg_value = *value;
+                    }
+                }
+
+                auto result = set_argument_value(*arg, arg_value, value_source::environment);
+                if (!result)
+                {
+                    return result;
+                }
+            }
+
+            return create_result(parse_error::none);
+        }
+
+        std::optional<string_type> get_environment_value(const string_type &name) const
+        {
+            // Environment variable names are expected to be ASCII, so the name is simply
+            // narrowed.
+            std::string narrow_name;
+            narrow_name.reserve(name.size());
+            for (auto ch : name)
+            {
+                narrow_name.push_back(static_cast<char>(ch));
+            }
+
+            auto value = details::get_environment_variable(narrow_name.c_str());
+            if (!value)
+            {
+                return {};
+            }
+
+            return string_convert<CharType, Traits, Alloc>::from_bytes(*value, _storage.locale);
+        }
+
+        result_type apply_config_files()
+        {
+            for (const auto &path : _storage.config_files)
+            {
+                details::config_file_contents<CharType, Traits, Alloc> contents;
+                if (!contents.read(path, _storage.locale))
+                {
+                    continue;
+                }
+
+                // Arguments that already have a value, including ones set by an earlier file, are
+                // not changed. This is determined up front so multi-value arguments can be listed
+                // more than once in the same file.
+                std::vector<const argument_base_type *> existing;
+                for (const auto &arg : _arguments)
+                {
+                    if (arg->has_value())
+                    {
+                        existing.push_back(arg.get());
+                    }
+                }
+
+                std::sort(existing.begin(), existing.end());
+                for (const auto &entry : contents.entries())
+                {
+                    auto arg = get_argument(entry.key);
+                    if (arg == nullptr)
+                    {
+                        return create_result(parse_error::unknown_argument, string_type{entry.key});
+                    }
+
+                    if (std::binary_search(existing.begin(), existing.end(), arg))
+                    {
+                        continue;
+                    }
+
+                    if (!entry.value && !arg->is_switch())
+                    {
+                        return create_result(parse_error::missing_value, arg->name());
+                    }
+
+                    // The file is unmapped after parsing, and could change while it's mapped, so
+                    // values that refer to their input get a copy.
+                    auto value = entry.value;
+                    if (value && arg->refers_to_input())
+                    {
+                        value = _retained_values.emplace_back(*value);
+                    }
+
+                    auto result = set_argument_value(*arg, value, value_source::config_file);
+                    if (!result)
+                    {
+                        return result;
+                    }
+                }
+            }
+
+            return create_result(parse_error::none);
+        }
+
+        // Returns a view of an argument from the range passed to parse(). If the iterator returned
+        // a temporary string, it's kept until the next parse so values can refer to it.
+        template<typename T>
+        string_view_type stable_view(T &&token)
+        {
+            if constexpr (std::is_same_v<std::remove_cvref_t<T>, string_type> && !std::is_lvalue_reference_v<T>)
+            {
+                return _retained_values.emplace_back(std::move(token));
+            }
+            else
+            {
+                return string_view_type{token};
+            }
+        }
+
+        result_type set_argument_value(argument_base_type &arg, std::optional<string_view_type> value,
+            value_source source = value_source::command_line)
         {
             if (!_storage.allow_duplicate_arguments && !arg.is_multi_value() && arg.has_value())
                 return create_result(parse_error::duplicate_argument, arg.name());
@@ -1041,16 +1338,119 @@ namespace ookii
             }
             else 
             {
-                result = arg.set_value(*value, *this);
-                if (result == set_value_result::error)
+                parse_error error;
+                if (!arg.value_file_prefix().empty() && value->starts_with(arg.value_file_prefix()))
                 {
-                    return create_result(parse_error::invalid_value, arg.name());
+                    error = read_value_file(value->substr(arg.value_file_prefix().size()), *value);
                 }
+                else
+                {
+                    error = check_value_limits(value->size());
+                }
+
+                if (error != parse_error::none)
+                {
+                    return create_result(error, arg.name());
+                }
+
+                result = arg.set_value(*value, *this);
             }
 
+            if (result == set_value_result::error)
+            {
+                return create_result(parse_error::invalid_value, arg.name());
+            }
+            else if (result == set_value_result::file_error)
+            {
+                return create_result(parse_error::unreadable_value_file, arg.name());
+            }
+            else if (result == set_value_result::limit_exceeded)
+            {
+                return create_result(_limit_error, arg.name());
+            }
+
+            arg._source = source;
             return post_process_argument(arg, value, result);
         }
 
+        // Maps a file whose contents are used as an argument's value, and replaces the value with
+        // them. The mapping is kept until the next parse so values can refer to it. The limits
+        // apply to the size of the file, before it's converted.
+        parse_error read_value_file(string_view_type path, string_view_type &value)
+        {
+            auto file = details::mapped_file::open(std::filesystem::path{path});
+            if (!file)
+            {
+                return parse_error::unreadable_value_file;
+            }
+
+            auto error = check_value_limits(file->contents().size());
+            if (error != parse_error::none)
+            {
+                return error;
+            }
+
+            auto contents = _value_files.emplace_back(std::move(*file)).contents();
+            if constexpr (std::is_same_v<CharType, char>)
+            {
+                value = string_view_type{contents.data(), contents.size()};
+            }
+            else
+            {
+                value = _retained_values.emplace_back(string_convert<CharType, Traits, Alloc>::from_bytes(contents, _storage.locale));
+            }
+
+            return parse_error::none;
+        }
+
+        // Checks the length of a value against the limits before it's converted, and adds it to
+        // the total. The error is also stored, so arguments that check their own values can
+        // report it using set_value_result::limit_exceeded.
+        parse_error check_value_limits(size_t length) noexcept
+        {
+            _limit_error = parse_error::none;
+            _total_value_length += length;
+            if (_storage.max_value_length != 0 && length > _storage.max_value_length)
+            {
+                _limit_error = parse_error::value_too_long;
+            }
+            else if (_storage.max_total_value_length != 0 && _total_value_length > _storage.max_total_value_length)
+            {
+                _limit_error = parse_error::total_value_length_exceeded;
+            }
+
+            return _limit_error;
+        }
+
+        // Gets the maximum length a value read from a stream can have before it's known to exceed
+        // the limits, or zero if there is no limit, so the stream doesn't have to be read
+        // completely to reject a value.
+        size_t value_length_budget() const noexcept
+        {
+            auto budget = _storage.max_value_length;
+            if (_storage.max_total_value_length != 0)
+            {
+                // At least one, since zero means there's no limit.
+                auto remaining = _total_value_length < _storage.max_total_value_length
+                    ? _storage.max_total_value_length - _total_value_length
+                    : 1;
+
+                budget = budget == 0 ? remaining : std::min(budget, remaining);
+            }
+
+            return budget;
+        }
+
+        // Checks the number of values of a multi-value argument before a new value is converted.
+        parse_error check_value_count(size_t count) noexcept
+        {
+            _limit_error = _storage.max_value_count != 0 && count > _storage.max_value_count
+                ? parse_error::too_many_values
+                : parse_error::none;
+
+            return _limit_error;
+        }
+
         result_type post_process_argument(argument_base_type &arg, std::optional<string_view_type> value, set_value_result result)
         {
             auto action = on_parsed_action::none;
@@ -1082,6 +1482,40 @@ namespace ookii
             return {*_storage.string_provider, error, arg_name};
         }
 
+        std::function<bool(const argument_base_type *, const argument_base_type *)> get_sort_function(description_list_sort_mode order) const
+        {
+            auto comparer = argument_comparer();
+            switch (order)
+            {
+            case description_list_sort_mode::alphabetical:
+                return [comparer](const argument_base_type *left, const argument_base_type *right)
+                {
+                    return comparer(left->name(), right->name());
+                };
+
+            case description_list_sort_mode::alphabetical_descending:
+                return [comparer](const argument_base_type *left, const argument_base_type *right)
+                {
+                    return comparer(right->name(), left->name());
+                };
+
+            case description_list_sort_mode::alphabetical_short_name:
+                return [comparer](const argument_base_type *left, const argument_base_type *right)
+                {
+                    return comparer(left->short_or_long_name(), right->short_or_long_name());
+                };
+
+            case description_list_sort_mode::alphabetical_short_name_descending:
+                return [comparer](const argument_base_type *left, const argument_base_type *right)
+                {
+                    return comparer(right->short_or_long_name(), left->short_or_long_name());
+                };
+
+            default:
+                throw std::logic_error("Invalid sort mode.");
+            }
+        }
+
         storage_type _storage;
         std::vector<prefix_info> _sorted_prefixes;
 
@@ -1094,6 +1528,21 @@ namespace ookii
         on_parsed_callback _on_parsed_callback;
         const argument_base_type* _help_argument{};
         bool _help_requested{};
+        std::unique_ptr<details::description_order_cache<argument_base_type>> _description_orders{
+            std::make_unique<details::description_order_cache<argument_base_type>>()};
+        std::unique_ptr<usage_cache_type> _usage_cache{std::make_unique<usage_cache_type>()};
+
+        // Strings that values of string_view arguments may refer to, kept until the next parse.
+        // A deque is used because its elements don't move when it grows.
+        std::deque<string_type> _retained_values;
+
+        // Files read by arguments that use allow_value_from_file(), kept until the next parse.
+        std::vector<details::mapped_file> _value_files;
+
+        // The combined length of all values converted by the current parse, and the error from
+        // the last limit check.
+        size_t _total_value_length{};
+        parse_error _limit_error{};
     };
 
     //! \brief Typedef for basic_command_line_parser using `char` as the character type.
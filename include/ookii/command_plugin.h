@@ -0,0 +1,82 @@
+//! \file command_plugin.h
+//! \brief Enables basic_command_manager::add_plugin_command().
+//!
+//! Plugin commands need the platform's library loader, which on some platforms is in a separate
+//! library, so unlike the other headers, this header is not included by command_line.h. Include
+//! it in the source files that call basic_command_manager::add_plugin_command(), and link the
+//! application to the `Ookii.CommandLine::OOKIICL_PLUGIN` CMake target, which adds the loader
+//! library if one is needed.
+#ifndef OOKII_COMMAND_PLUGIN_H_
+#define OOKII_COMMAND_PLUGIN_H_
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "subcommand.h"
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+namespace ookii::details
+{
+    // Libraries are never unloaded, so there's no function to free them.
+    inline void *load_library(const std::filesystem::path &path) noexcept
+    {
+#ifdef _WIN32
+        return LoadLibraryW(path.c_str());
+#else
+        return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+    }
+
+    inline void *get_library_symbol(void *library, const char *name) noexcept
+    {
+#ifdef _WIN32
+        return reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+        return dlsym(library, name);
+#endif
+    }
+
+    // Loads the shared library of a plugin command the first time the command is created. The
+    // library is never unloaded, so the commands it created stay valid after the manager is
+    // destroyed.
+    template<typename Command, typename Builder>
+    class plugin_loader
+    {
+    public:
+        using function_type = Command *(*)(Builder &);
+
+        plugin_loader(std::filesystem::path library, std::string symbol)
+            : _library{std::move(library)},
+              _symbol{std::move(symbol)}
+        {
+        }
+
+        std::unique_ptr<Command> create(Builder &builder)
+        {
+            std::call_once(_once, [this]()
+                {
+                    if (auto library = load_library(_library))
+                        _function = reinterpret_cast<function_type>(get_library_symbol(library, _symbol.c_str()));
+                });
+
+            if (_function == nullptr)
+                return {};
+
+            return std::unique_ptr<Command>{_function(builder)};
+        }
+
+    private:
+        std::filesystem::path _library;
+        std::string _symbol;
+        std::once_flag _once;
+        function_type _function{};
+    };
+}
+
+#endif
@@ -0,0 +1,375 @@
+//! \file command_shell.h
+//! \brief Provides the ookii::basic_command_shell class.
+#ifndef OOKII_COMMAND_SHELL_H_
+#define OOKII_COMMAND_SHELL_H_
+
+#pragma once
+
+#include <deque>
+#include <istream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include "subcommand.h"
+
+namespace ookii
+{
+    //! \brief Runs commands from a basic_command_manager interactively, reading one command line
+    //!        at a time.
+    //!
+    //! A command shell lets an application run many commands in a single process, for example
+    //! from a `shell` command that reads commands from the console until the user types `exit`.
+    //! Every line is split into arguments using basic_command_line_tokens::split(), so the same
+    //! quoting rules as a POSIX shell apply, and the first argument is the command name. Nested
+    //! commands added using basic_command_manager::add_parent_command() are supported.
+    //!
+    //! Unlike basic_command_manager::run_command(), which creates a basic_parser_builder, a
+    //! parser and a new command object every time, the shell keeps the command object and its
+    //! parser after a command is used for the first time. When the same command is used again,
+    //! the existing parser is used, after calling
+    //! basic_command_line_parser::restore_initial_values() so arguments that are not supplied get
+    //! the values they had when the command was created. The shell stores those values using
+    //! basic_command_line_parser::capture_initial_values() when it creates the parser. This means
+    //! the command's constructor, and the function set using
+    //! basic_command_manager::configure_parser(), are only called once per command. Any state of
+    //! the command other than its arguments is not reset, so the run() method of a command that is
+    //! used in a shell should not depend on state left by a previous call. Commands that use
+    //! basic_command_with_custom_parsing are created again every time.
+    //!
+    //! The lines that are run are kept in a history, which can be retrieved using history().
+    //!
+    //! Two typedefs for common character types are provided:
+    //!
+    //! Type                     | Definition
+    //! ------------------------ | -------------------------------------
+    //! `ookii::command_shell`   | `ookii::basic_command_shell<char>`
+    //! `ookii::wcommand_shell`  | `ookii::basic_command_shell<wchar_t>`
+    //!
+    //! \tparam CharType The character type used for arguments and other strings.
+    //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use for strings. Defaults to `std::allocator<CharType>`.
+    template<typename CharType, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
+    class basic_command_shell
+    {
+    public:
+        //! \brief The type of the basic_command_manager used.
+        using manager_type = basic_command_manager<CharType, Traits, Alloc>;
+        //! \brief The concrete type of command_info used.
+        using info_type = typename manager_type::info_type;
+        //! \brief The concrete type of basic_command used.
+        using command_type = typename manager_type::command_type;
+        //! \brief The concrete type of basic_command_with_custom_parsing used.
+        using command_with_custom_parsing_type = typename manager_type::command_with_custom_parsing_type;
+        //! \brief The concrete type of basic_usage_writer used.
+        using usage_writer_type = typename manager_type::usage_writer_type;
+        //! \brief The concrete type of basic_command_line_parser used.
+        using parser_type = basic_command_line_parser<CharType, Traits, Alloc>;
+        //! \brief The concrete string type used.
+        using string_type = typename manager_type::string_type;
+        //! \brief The concrete string_view type used.
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+        //! \brief The concrete input stream type used.
+        using istream_type = std::basic_istream<CharType, Traits>;
+        //! \brief The concrete output stream type used.
+        using ostream_type = std::basic_ostream<CharType, Traits>;
+
+        //! \brief The default maximum number of lines kept in the history.
+        static constexpr size_t default_max_history = 1000;
+
+        //! \brief Initializes a new instance of the basic_command_shell class.
+        //!
+        //! \param manager The basic_command_manager containing the commands. It must remain valid
+        //!        as long as the shell is used.
+        //! \param usage A basic_usage_writer instance that will be used to format errors and usage
+        //!        help, or `nullptr` to use the default. If not `nullptr`, it must remain valid as
+        //!        long as the shell is used, and the prompt is written to its output stream.
+        basic_command_shell(const manager_type &manager, usage_writer_type *usage = nullptr)
+            : _manager{manager},
+              _usage{usage},
+              _prompt{manager.application_name() + literal_cast<CharType>("> ").data()},
+              _exit_command{literal_cast<CharType>("exit").data()}
+        {
+        }
+
+        //! \brief Sets the prompt that is written before reading each line.
+        //!
+        //! The default prompt is the application name followed by "> ". Set it to an empty
+        //! string to disable the prompt, for example when reading from a file.
+        //!
+        //! \param prompt The prompt.
+        void prompt(string_type prompt)
+        {
+            _prompt = std::move(prompt);
+        }
+
+        //! \brief Gets the prompt that is written before reading each line.
+        const string_type &prompt() const noexcept
+        {
+            return _prompt;
+        }
+
+        //! \brief Sets the command that stops the run() method.
+        //!
+        //! The default is "exit". The command is matched exactly, and only if the line contains
+        //! no other arguments. Set it to an empty string to only stop at the end of the input.
+        //!
+        //! \param exit_command The name of the exit command.
+        void exit_command(string_type exit_command)
+        {
+            _exit_command = std::move(exit_command);
+        }
+
+        //! \brief Gets the command that stops the run() method.
+        const string_type &exit_command() const noexcept
+        {
+            return _exit_command;
+        }
+
+        //! \brief Sets the maximum number of lines kept in the history.
+        //!
+        //! When the history is full, the oldest line is removed. A value of zero disables the
+        //! history. The default is default_max_history.
+        //!
+        //! \param max_history The maximum number of lines.
+        void max_history(size_t max_history)
+        {
+            _max_history = max_history;
+            trim_history();
+        }
+
+        //! \brief Gets the maximum number of lines kept in the history.
+        size_t max_history() const noexcept
+        {
+            return _max_history;
+        }
+
+        //! \brief Gets the lines that were run, oldest first.
+        //!
+        //! Every line passed to run_line() that isn't empty is added, including lines with errors.
+        const std::deque<string_type> &history() const noexcept
+        {
+            return _history;
+        }
+
+        //! \brief Removes all lines from the history.
+        void clear_history() noexcept
+        {
+            _history.clear();
+        }
+
+        //! \brief Destroys all the cached command objects and parsers.
+        //!
+        //! Commands will be created again the next time they are used.
+        void clear_cache() noexcept
+        {
+            _cache.clear();
+        }
+
+        //! \brief Splits a line into arguments, and runs the command it specifies.
+        //!
+        //! If the command could not be found, a list of commands will be written. If an error
+        //! occurred parsing the arguments, an error message and usage help for the command will be
+        //! written.
+        //!
+        //! \param line The command line, starting with the command name.
+        //! \return The exit code of the command, or `std::nullopt` if the line was empty, or the
+        //!         command could not be found or created.
+        std::optional<int> run_line(string_view_type line)
+        {
+            auto tokens = basic_command_line_tokens<CharType, Traits>::split(line);
+            if (!tokens)
+            {
+                add_history(line);
+                write_error(_manager.string_provider().unterminated_command_line());
+                return {};
+            }
+
+            if (tokens->empty())
+                return {};
+
+            add_history(line);
+            return run_command(tokens->args());
+        }
+
+        //! \brief Reads lines from a stream and runs them, until the end of the stream is reached
+        //!        or the exit command is used.
+        //!
+        //! The prompt is written before each line is read. A line that ends inside quotes, or
+        //! with a backslash, continues on the next line.
+        //!
+        //! \param input The stream to read from.
+        //! \return The exit code of the last command that was run, or `std::nullopt` if no command
+        //!         was run or the last command could not be created.
+        std::optional<int> run(istream_type &input)
+        {
+            std::optional<int> result;
+            string_type line;
+            while (read_line(input, line))
+            {
+                auto tokens = basic_command_line_tokens<CharType, Traits>::split(line);
+                if (tokens && tokens->size() == 1 && !_exit_command.empty() && tokens->views()[0] == _exit_command)
+                    break;
+
+                if (tokens && tokens->empty())
+                    continue;
+
+                result = run_line(line);
+            }
+
+            return result;
+        }
+
+        //! \brief Reads lines from the standard input stream and runs them, until the end of the
+        //!        stream is reached or the exit command is used.
+        //! \return The exit code of the last command that was run, or `std::nullopt` if no command
+        //!         was run or the last command could not be created.
+        std::optional<int> run()
+        {
+            return run(console_stream<CharType>::cin());
+        }
+
+        //! \brief Runs the command specified by arguments that were already split.
+        //!
+        //! This behaves like run_line(), and uses the same cached commands and parsers, but the
+        //! arguments are not split and not added to the history. This is useful if the arguments
+        //! come from somewhere other than a command line, such as a command_host.
+        //!
+        //! \param args The arguments, starting with the command name.
+        //! \return The exit code of the command, or `std::nullopt` if there were no arguments, or
+        //!         the command could not be found or created.
+        std::optional<int> run_command(std::span<const CharType *const> args)
+        {
+            if (args.empty())
+            {
+                _manager.write_usage(_usage);
+                return {};
+            }
+
+            auto [manager, info, command_args] = _manager.find_command(args[0], args.subspan(1));
+            args = command_args;
+            if (info == nullptr)
+            {
+                manager->write_usage(_usage);
+                return {};
+            }
+
+            if (info->use_custom_argument_parsing())
+            {
+                auto command = info->create_custom_parsing();
+                auto custom_command = static_cast<command_with_custom_parsing_type*>(command.get());
+                if (!custom_command->parse(args, *manager, _usage))
+                    return {};
+
+                return command->run();
+            }
+
+            // The info is owned by the manager, so its address identifies the command.
+            auto it = _cache.find(info);
+            if (it == _cache.end())
+            {
+                auto builder = manager->create_parser_builder(*info);
+                cached_command cached;
+                cached.command = info->create(builder);
+                if (!cached.command)
+                {
+                    write_error(manager->string_provider().unloadable_plugin_command(info->name()));
+                    return {};
+                }
+
+                cached.parser = std::make_unique<parser_type>(builder.build());
+                cached.parser->capture_initial_values();
+                it = _cache.emplace(info, std::move(cached)).first;
+            }
+            else
+            {
+                it->second.parser->restore_initial_values();
+            }
+
+            if (!it->second.parser->parse(args, _usage))
+                return {};
+
+            return it->second.command->run();
+        }
+
+    private:
+        static constexpr auto c_continuation_prompt = literal_cast<CharType>("> ");
+
+        struct cached_command
+        {
+            std::unique_ptr<command_type> command;
+            std::unique_ptr<parser_type> parser;
+        };
+
+        bool read_line(istream_type &input, string_type &line)
+        {
+            line.clear();
+            string_type next;
+            while (true)
+            {
+                if (!_prompt.empty())
+                {
+                    auto &output = _usage == nullptr ? console_stream<CharType>::cout() : _usage->output;
+                    output << (line.empty() ? string_view_type{_prompt} : string_view_type{c_continuation_prompt.data()});
+                    output.flush();
+                }
+
+                if (!std::getline(input, next))
+                    return !line.empty();
+
+                line += next;
+
+                // Continue on the next line if there's an unterminated quote or a trailing
+                // backslash.
+                if (basic_command_line_tokens<CharType, Traits>::split(line))
+                    return true;
+
+                line += static_cast<CharType>('\n');
+            }
+        }
+
+        void add_history(string_view_type line)
+        {
+            if (_max_history == 0)
+                return;
+
+            _history.emplace_back(line);
+            trim_history();
+        }
+
+        void trim_history()
+        {
+            while (_history.size() > _max_history)
+            {
+                _history.pop_front();
+            }
+        }
+
+        void write_error(string_view_type message)
+        {
+            if (_usage == nullptr)
+            {
+                usage_writer_type{}.write_error(message);
+            }
+            else
+            {
+                _usage->write_error(message);
+            }
+        }
+
+        const manager_type &_manager;
+        usage_writer_type *_usage;
+        string_type _prompt;
+        string_type _exit_command;
+        size_t _max_history{default_max_history};
+        std::deque<string_type> _history;
+        std::map<const info_type *, cached_command> _cache;
+    };
+
+    //! \brief Typedef for basic_command_shell using `char` as the character type.
+    using command_shell = basic_command_shell<char>;
+    //! \brief Typedef for basic_command_shell using `wchar_t` as the character type.
+    using wcommand_shell = basic_command_shell<wchar_t>;
+}
+
+#endif
@@ -0,0 +1,254 @@
+//! \file config_file.h
+//! \brief Provides helpers for reading argument values from configuration files and streams.
+//!
+//! These are used by the basic_command_line_parser class to read the files specified using
+//! basic_parser_builder::config_file(), and by multi-value arguments that use
+//! basic_parser_builder::multi_value_argument_builder::values_from_stream().
+#ifndef OOKII_CONFIG_FILE_H_
+#define OOKII_CONFIG_FILE_H_
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "console_helper.h"
+#include "string_helper.h"
+
+namespace ookii::details
+{
+    // Read-only view of a memory mapped file, which is unmapped when the object is destroyed.
+    class mapped_file
+    {
+    public:
+        mapped_file() = default;
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept
+            : _data{std::exchange(other._data, nullptr)},
+              _size{std::exchange(other._size, 0)}
+        {
+        }
+
+        mapped_file &operator=(mapped_file &&other) noexcept
+        {
+            if (this != &other)
+            {
+                unmap_file(_data, _size);
+                _data = std::exchange(other._data, nullptr);
+                _size = std::exchange(other._size, 0);
+            }
+
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            unmap_file(_data, _size);
+        }
+
+        // Returns std::nullopt if the file could not be opened. An empty file is not an error.
+        static std::optional<mapped_file> open(const std::filesystem::path &path) noexcept
+        {
+            mapped_file result;
+            if (!map_file(path, result._data, result._size))
+            {
+                return {};
+            }
+
+            return result;
+        }
+
+        std::string_view contents() const noexcept
+        {
+            if (_data == nullptr)
+            {
+                return {};
+            }
+
+            return {_data, _size};
+        }
+
+    private:
+        const char *_data{};
+        size_t _size{};
+    };
+
+    // The size of the blocks read by for_each_delimited_value(). The buffer only grows if a single
+    // value doesn't fit.
+    constexpr size_t c_value_stream_block_size = 64 * 1024;
+
+    // Calls f for every non-empty value in the stream, separated by delimiter. A '\r' before a
+    // '\n' delimiter is removed. The stream is read in large blocks, and the values passed to f
+    // point into the block, so they are only valid during the call. Returns false if f returned
+    // false, which stops reading.
+    //
+    // If max_length is not zero, a value that is longer is passed to f as soon as that is known,
+    // without the rest of it, so the buffer doesn't grow beyond that length and f can reject it.
+    // The caller must make sure f rejects such a value, or the buffer is unbounded again.
+    template<typename Func>
+    bool for_each_delimited_value(std::streambuf &stream, char delimiter, size_t max_length, Func f)
+    {
+        auto emit = [&](const char *begin, const char *end)
+        {
+            if (delimiter == '\n' && end != begin && *(end - 1) == '\r')
+            {
+                --end;
+            }
+
+            return end == begin || f(std::string_view{begin, static_cast<size_t>(end - begin)});
+        };
+
+        std::vector<char> buffer(c_value_stream_block_size);
+        size_t filled = 0;
+        while (true)
+        {
+            auto count = stream.sgetn(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+            if (count <= 0)
+            {
+                return emit(buffer.data(), buffer.data() + filled);
+            }
+
+            filled += static_cast<size_t>(count);
+            const char *current = buffer.data();
+            const char *end = buffer.data() + filled;
+            while (auto found = static_cast<const char *>(std::memchr(current, delimiter, static_cast<size_t>(end - current))))
+            {
+                if (!emit(current, found))
+                {
+                    return false;
+                }
+
+                current = found + 1;
+            }
+
+            // Move the incomplete value to the start of the buffer, and make room for more data if
+            // it fills the whole buffer.
+            filled = static_cast<size_t>(end - current);
+            if (max_length != 0 && filled > max_length)
+            {
+                return f(std::string_view{current, filled});
+            }
+
+            std::memmove(buffer.data(), current, filled);
+            if (filled == buffer.size())
+            {
+                buffer.resize(buffer.size() * 2);
+            }
+        }
+    }
+
+    template<typename CharType, typename Traits>
+    struct config_entry
+    {
+        std::basic_string_view<CharType, Traits> key;
+
+        // std::nullopt if the line had no '=' character.
+        std::optional<std::basic_string_view<CharType, Traits>> value;
+    };
+
+    template<typename CharType, typename Traits>
+    std::basic_string_view<CharType, Traits> trim_config_white_space(std::basic_string_view<CharType, Traits> value)
+    {
+        auto is_space = [](CharType ch)
+        {
+            return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\f' || ch == '\v';
+        };
+
+        while (!value.empty() && is_space(value.front()))
+        {
+            value.remove_prefix(1);
+        }
+
+        while (!value.empty() && is_space(value.back()))
+        {
+            value.remove_suffix(1);
+        }
+
+        return value;
+    }
+
+    // Splits a file into key=value entries, skipping blank lines and comments. The entries refer
+    // into the contents, so they are only valid as long as it is.
+    template<typename CharType, typename Traits>
+    std::vector<config_entry<CharType, Traits>> parse_config_entries(std::basic_string_view<CharType, Traits> contents)
+    {
+        std::vector<config_entry<CharType, Traits>> result;
+        for (auto line : tokenize<CharType, Traits>{contents, static_cast<CharType>('\n')})
+        {
+            line = trim_config_white_space(line);
+            if (line.empty() || line[0] == '#' || line[0] == ';')
+            {
+                continue;
+            }
+
+            auto [key, value] = split_once(line, static_cast<CharType>('='));
+            if (value)
+            {
+                value = trim_config_white_space(*value);
+            }
+
+            result.push_back({trim_config_white_space(key), value});
+        }
+
+        return result;
+    }
+
+    // Holds the contents of a configuration file for the duration of parsing. For char, the
+    // entries point directly into the mapped file; other character types need a converted copy.
+    // Since the entries point into this object, it can't be copied or moved.
+    template<typename CharType, typename Traits, typename Alloc>
+    class config_file_contents
+    {
+    public:
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+
+        config_file_contents() = default;
+        config_file_contents(const config_file_contents &) = delete;
+        config_file_contents &operator=(const config_file_contents &) = delete;
+
+        // Returns false if the file could not be opened.
+        bool read(const std::filesystem::path &path, const std::locale &loc)
+        {
+            auto file = mapped_file::open(path);
+            if (!file)
+            {
+                return false;
+            }
+
+            _file = std::move(*file);
+            if constexpr (std::is_same_v<CharType, char>)
+            {
+                auto contents = _file.contents();
+                _entries = parse_config_entries(string_view_type{contents.data(), contents.size()});
+            }
+            else
+            {
+                _converted = string_convert<CharType, Traits, Alloc>::from_bytes(_file.contents(), loc);
+                _entries = parse_config_entries(string_view_type{_converted});
+            }
+
+            return true;
+        }
+
+        const std::vector<config_entry<CharType, Traits>> &entries() const noexcept
+        {
+            return _entries;
+        }
+
+    private:
+        mapped_file _file;
+        std::basic_string<CharType, Traits, Alloc> _converted;
+        std::vector<config_entry<CharType, Traits>> _entries;
+    };
+}
+
+#endif
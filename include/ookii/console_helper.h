@@ -6,10 +6,49 @@
 #pragma once
 
 #include "platform_helper.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <string>
 
 namespace ookii
 {
+    namespace details
+    {
+        // Gets the value of an environment variable, or std::nullopt if it's not set.
+        inline std::optional<std::string> get_environment_variable(const char *name)
+        {
+#ifdef _WIN32
+            size_t required;
+            if (getenv_s(&required, nullptr, 0, name) != 0 || required == 0)
+            {
+                return {};
+            }
+
+            std::string value(required, '\0');
+            if (getenv_s(&required, value.data(), value.size(), name) != 0)
+            {
+                return {};
+            }
+
+            // Remove the terminating NULL character.
+            value.resize(required - 1);
+            return value;
+#else
+            auto value = getenv(name);
+            if (value == nullptr)
+            {
+                return {};
+            }
+
+            return value;
+#endif
+        }
+    }
+
     //! \brief Determines the width of the console.
     //! 
     //! This function returns the width of the console attached to stdout. If stdout is redirected
@@ -27,6 +66,124 @@ namespace ookii
         return default_width;
     }
 
+    //! \brief Provides a process-wide cache of the console width.
+    //!
+    //! Determining the console width requires a system call, which get_console_width() makes
+    //! every time it's called. This class determines the width once, and afterwards returns the
+    //! cached value without taking any locks, so it's cheap to call from any thread.
+    //!
+    //! The cached value can be invalidated explicitly using invalidate(), automatically when the
+    //! terminal is resized using watch_resize(), or periodically using poll_interval().
+    //!
+    //! The basic_line_wrapping_streambuf class uses this cache when it's initialized with the
+    //! ookii::use_console_width constant. Use basic_line_wrapping_streambuf::update_console_width()
+    //! to apply a changed width to an existing stream.
+    class console_width_cache
+    {
+    public:
+        //! \brief Gets the width of the console, determining it if it is not cached.
+        //!
+        //! \param default_width The width to assume if the actual width can't be determined.
+        static short width(short default_width = 80) noexcept
+        {
+            auto generation = _generation.load(std::memory_order_acquire);
+            auto value = _value.load(std::memory_order_acquire);
+            if (!is_valid(value, generation))
+            {
+                // If the cache was invalidated while determining the width, the generation stored
+                // here will be stale, and the width will be determined again next time.
+                auto width = details::get_console_width();
+                value = make_value(generation, width);
+                _value.store(value, std::memory_order_release);
+                if (_poll_interval.load(std::memory_order_relaxed) != 0)
+                {
+                    _last_update.store(now(), std::memory_order_relaxed);
+                }
+            }
+
+            if ((value & c_has_width_flag) == 0)
+            {
+                return default_width;
+            }
+
+            return static_cast<short>(value & c_width_mask);
+        }
+
+        //! \brief Discards the cached width, so it is determined again on the next call to
+        //!        width().
+        //!
+        //! This function is async-signal-safe if `std::atomic<std::uint32_t>` is lock-free.
+        static void invalidate() noexcept
+        {
+            _generation.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        //! \brief Invalidates the cached width whenever the terminal is resized.
+        //!
+        //! On POSIX platforms, this installs a handler for the `SIGWINCH` signal. If another
+        //! handler was already installed, it will still be called.
+        //!
+        //! On Windows, this is not supported; use poll_interval() instead.
+        //!
+        //! \return `true` if the handler was installed; otherwise, `false`.
+        static bool watch_resize() noexcept
+        {
+            return details::set_console_resize_handler(&console_width_cache::invalidate);
+        }
+
+        //! \brief Sets an interval after which the cached width is considered stale.
+        //!
+        //! This can be used if watch_resize() is not supported or not desirable.
+        //!
+        //! \param interval The maximum age of the cached width, or zero to keep the width until
+        //!        invalidate() is called.
+        static void poll_interval(std::chrono::milliseconds interval) noexcept
+        {
+            _last_update.store(now(), std::memory_order_relaxed);
+            _poll_interval.store(interval.count(), std::memory_order_relaxed);
+        }
+
+    private:
+        static bool is_valid(std::uint64_t value, std::uint32_t generation) noexcept
+        {
+            if ((value & c_cached_flag) == 0 || (value >> 32) != generation)
+            {
+                return false;
+            }
+
+            auto interval = _poll_interval.load(std::memory_order_relaxed);
+            return interval == 0 || now() - _last_update.load(std::memory_order_relaxed) < interval;
+        }
+
+        static std::uint64_t make_value(std::uint32_t generation, std::optional<short> width) noexcept
+        {
+            std::uint64_t value = (static_cast<std::uint64_t>(generation) << 32) | c_cached_flag;
+            if (width)
+            {
+                value |= c_has_width_flag | static_cast<std::uint16_t>(*width);
+            }
+
+            return value;
+        }
+
+        static std::int64_t now() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static constexpr std::uint64_t c_width_mask = 0xffff;
+        static constexpr std::uint64_t c_has_width_flag = 0x10000;
+        static constexpr std::uint64_t c_cached_flag = 0x20000;
+
+        // The cached value holds the generation it was determined for in the high 32 bits, so
+        // the width and its validity are always read together.
+        static inline std::atomic<std::uint64_t> _value{};
+        static inline std::atomic<std::uint32_t> _generation{};
+        static inline std::atomic<std::int64_t> _poll_interval{};
+        static inline std::atomic<std::int64_t> _last_update{};
+    };
+
     //! \brief Represents one of the standard console streams.
     enum class standard_stream
     {
@@ -226,6 +383,79 @@ namespace ookii
     }
 #endif
 
+    namespace details
+    {
+        // The buffers that receive the standard output and error written by the current thread,
+        // while a thread_redirect_streambuf is installed. A nullptr buffer means the output goes
+        // to the original stream.
+        template<typename CharType, typename Traits>
+        struct thread_output_target
+        {
+            std::basic_streambuf<CharType, Traits> *output{};
+            std::basic_streambuf<CharType, Traits> *error{};
+
+            static inline thread_local thread_output_target *current{};
+        };
+
+        // Replaces the buffer of a stream, such as std::cout, for as long as it exists, and sends
+        // the output of each thread to that thread's thread_output_target. This buffer doesn't
+        // buffer anything itself, so it can be used by many threads at once, as long as the
+        // target buffers are not shared between threads.
+        template<typename CharType, typename Traits>
+        class thread_redirect_streambuf : public std::basic_streambuf<CharType, Traits>
+        {
+        public:
+            using streambuf_type = std::basic_streambuf<CharType, Traits>;
+            using int_type = typename streambuf_type::int_type;
+            using target_type = thread_output_target<CharType, Traits>;
+
+            thread_redirect_streambuf(std::basic_ostream<CharType, Traits> &stream, bool is_error)
+                : _stream{stream},
+                  _is_error{is_error}
+            {
+                _original = _stream.rdbuf(this);
+            }
+
+            thread_redirect_streambuf(const thread_redirect_streambuf &) = delete;
+            thread_redirect_streambuf &operator=(const thread_redirect_streambuf &) = delete;
+
+            ~thread_redirect_streambuf()
+            {
+                _stream.rdbuf(_original);
+            }
+
+        protected:
+            int_type overflow(int_type ch) override
+            {
+                if (Traits::eq_int_type(ch, Traits::eof()))
+                    return Traits::not_eof(ch);
+
+                return target()->sputc(Traits::to_char_type(ch));
+            }
+
+            std::streamsize xsputn(const CharType *s, std::streamsize count) override
+            {
+                return target()->sputn(s, count);
+            }
+
+            int sync() override
+            {
+                return target()->pubsync();
+            }
+
+        private:
+            streambuf_type *target() const noexcept
+            {
+                auto current = target_type::current;
+                auto buffer = current == nullptr ? nullptr : (_is_error ? current->error : current->output);
+                return buffer == nullptr ? _original : buffer;
+            }
+
+            std::basic_ostream<CharType, Traits> &_stream;
+            streambuf_type *_original;
+            bool _is_error;
+        };
+    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+//! \file fd_streambuf.h
+//! \brief Provides the ookii::fd_streambuf class.
+#ifndef OOKII_FD_STREAMBUF_H_
+#define OOKII_FD_STREAMBUF_H_
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <streambuf>
+#include "platform_helper.h"
+
+namespace ookii
+{
+    //! \brief Stream buffer that writes directly to a file descriptor, without going through the
+    //!        C standard library's `FILE` streams.
+    //!
+    //! Writing to `std::cout` can be slow, because it is synchronized with the C standard I/O
+    //! functions by default, which means every write is forwarded to `stdout` immediately. This
+    //! class instead collects all output in a large buffer, and only writes it to the file
+    //! descriptor when the buffer is full or the stream is flushed. When a write doesn't fit in the
+    //! buffer, the buffer and the new data are written together using a single `writev()` call,
+    //! so large blocks of output are never copied.
+    //!
+    //! This makes writing a large amount of text, such as the usage help for an application with
+    //! many arguments, take only a few system calls. It doesn't make formatting the text any
+    //! faster, and formatting usually takes most of the time, so the gain is modest unless the
+    //! output goes to a terminal or another slow destination. Use the
+    //! basic_line_wrapping_ostream::for_fd() method or the basic_usage_writer constructor that
+    //! takes file descriptors to use this class.
+    //!
+    //! Because this class doesn't share a buffer with `std::cout` or `stdout`, output written
+    //! using those streams should be flushed before using this class on the same file descriptor,
+    //! and vice versa. The buffer is flushed when the object is destroyed.
+    //!
+    //! This class only supports `char`, because the output is written as is.
+    class fd_streambuf : public std::streambuf
+    {
+    public:
+        //! \brief The default size of the buffer.
+        static constexpr size_t default_buffer_size = 64 * 1024;
+
+        //! \brief Initializes a new instance of the fd_streambuf class.
+        //! \param fd The file descriptor to write to. The file descriptor is not closed when
+        //!        this object is destroyed.
+        //! \param buffer_size The size of the buffer.
+        explicit fd_streambuf(int fd, size_t buffer_size = default_buffer_size)
+            : _fd{fd},
+              _buffer{std::make_unique<char[]>(buffer_size)},
+              _buffer_size{buffer_size}
+        {
+            reset_put_area();
+        }
+
+        fd_streambuf(const fd_streambuf &) = delete;
+        fd_streambuf &operator=(const fd_streambuf &) = delete;
+
+        //! \brief Writes any remaining buffered output to the file descriptor.
+        ~fd_streambuf()
+        {
+            flush_buffer(nullptr, 0);
+        }
+
+        //! \brief Gets the file descriptor that this stream buffer writes to.
+        int fd() const noexcept
+        {
+            return _fd;
+        }
+
+    protected:
+        //! \brief Writes the buffer to the file descriptor, and then adds the specified character
+        //!        to the buffer.
+        //! \param ch The character to add, or `traits_type::eof()` to only write the buffer.
+        //! \return `traits_type::eof()` if writing failed; otherwise, a value other than
+        //!         `traits_type::eof()`.
+        int_type overflow(int_type ch = traits_type::eof()) override
+        {
+            if (!flush_buffer(nullptr, 0))
+            {
+                return traits_type::eof();
+            }
+
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                return traits_type::not_eof(ch);
+            }
+
+            *this->pptr() = traits_type::to_char_type(ch);
+            this->pbump(1);
+            return ch;
+        }
+
+        //! \brief Writes multiple characters.
+        //! \param s The characters to write.
+        //! \param count The number of characters.
+        //! \return The number of characters written.
+        std::streamsize xsputn(const char_type *s, std::streamsize count) override
+        {
+            auto size = static_cast<size_t>(count);
+            if (size <= static_cast<size_t>(this->epptr() - this->pptr()))
+            {
+                std::memcpy(this->pptr(), s, size);
+                this->pbump(static_cast<int>(count));
+                return count;
+            }
+
+            return flush_buffer(s, size) ? count : 0;
+        }
+
+        //! \brief Writes the buffer to the file descriptor.
+        //! \return 0 on success, or -1 if writing failed.
+        int sync() override
+        {
+            return flush_buffer(nullptr, 0) ? 0 : -1;
+        }
+
+    private:
+        // Writes the buffer followed by the additional data, and empties the buffer.
+        bool flush_buffer(const char *extra, size_t extra_size) noexcept
+        {
+            auto size = static_cast<size_t>(this->pptr() - this->pbase());
+            if (size == 0 && extra_size == 0)
+            {
+                return true;
+            }
+
+            auto result = details::write_fd(_fd, this->pbase(), size, extra, extra_size);
+            reset_put_area();
+            return result;
+        }
+
+        void reset_put_area() noexcept
+        {
+            this->setp(_buffer.get(), _buffer.get() + _buffer_size);
+        }
+
+        int _fd;
+        std::unique_ptr<char[]> _buffer;
+        size_t _buffer_size;
+    };
+}
+
+#endif
@@ -3,8 +3,11 @@
 //!        wrapping text at the specified width.
 #pragma once
 
+#include <array>
 #include <cassert>
+#include <type_traits>
 #include <vector>
+#include "fd_streambuf.h"
 #include "vt_helper.h"
 
 namespace ookii
@@ -109,27 +112,9 @@ namespace ookii
 
             _base_streambuf = streambuf;
             _count_formatting = count_formatting;
-
-            // Check if the caller wants to use the console width.
-            if (max_line_length == use_console_width)
-            {
-                _max_line_length = get_console_width();
-                if (_max_line_length != 0)
-                {
-                    // Subtract one because it looks nicer.
-                    --_max_line_length;
-                }
-            }
-            else
-            {
-                _max_line_length = max_line_length;
-            }
-
-            // Don't allow super long lines, to avoid allocating large buffers.
-            if (_max_line_length > c_max_allowed_line_length)
-            {
-                _max_line_length = c_max_allowed_line_length;
-            }
+            update_locale_characters(this->getloc());
+            _uses_console_width = max_line_length == use_console_width;
+            _max_line_length = get_line_length(max_line_length);
 
             // Allocate a buffer only if line wrapping is used.
             if (_max_line_length > 0)
@@ -146,6 +131,81 @@ namespace ookii
             }
         }
 
+        //! \brief Gets the maximum line length, or 0 if there is no limit.
+        size_t max_line_length() const noexcept
+        {
+            return _max_line_length;
+        }
+
+        //! \brief Changes the maximum line length.
+        //!
+        //! Text that was already written to the underlying stream buffer is not affected, but the
+        //! unfinished line that's still in the buffer, if any, will be wrapped using the new length.
+        //!
+        //! \param max_line_length The maximum line length, or a value of 0 or larger than 65536
+        //!        to specify no limit. Use the use_console_width constant to use the console width
+        //!        as the maximum.
+        //! \return `false` if the unfinished line needed to be written but could not be;
+        //!         otherwise, `true`.
+        bool max_line_length(size_t max_line_length)
+        {
+            _uses_console_width = max_line_length == use_console_width;
+            auto new_length = get_line_length(max_line_length);
+            if (new_length == _max_line_length)
+            {
+                return true;
+            }
+
+            auto pending = static_cast<int>(this->pptr() - this->pbase());
+            _max_line_length = new_length;
+            if (new_length == 0)
+            {
+                // Without a limit, there is no buffer, so write the unfinished line now. This
+                // doesn't add a line break, so writing can continue on the same line.
+                auto pending_data = std::move(_buffer);
+                _buffer = {};
+                this->setp(nullptr, nullptr);
+                return _base_streambuf == nullptr ||
+                    write_unbuffered(pending_data.data(), pending) == pending;
+            }
+
+            _buffer.resize(std::max(new_length * 2, static_cast<size_t>(pending)));
+            reset_put_area(pending);
+            if (pending == 0 || _base_streambuf == nullptr)
+            {
+                return true;
+            }
+
+            // The unfinished line may be too long for the new length.
+            return flush_buffer() && ensure_free_space();
+        }
+
+        //! \brief Updates the maximum line length if this stream buffer uses the console width and
+        //!        that width has changed.
+        //!
+        //! The console width is determined using the console_width_cache class, so this is cheap
+        //! to call regularly; use console_width_cache::watch_resize() or
+        //! console_width_cache::poll_interval() to make sure the width is kept up to date.
+        //!
+        //! \return `true` if the maximum line length changed; otherwise, `false`.
+        bool update_console_width()
+        {
+            if (!_uses_console_width || get_line_length(use_console_width) == _max_line_length)
+            {
+                return false;
+            }
+
+            max_line_length(use_console_width);
+            return true;
+        }
+
+        //! \brief Gets a value that indicates whether virtual terminal sequences are included when
+        //!        calculating the length of a line.
+        bool count_formatting() const noexcept
+        {
+            return _count_formatting;
+        }
+
         //! \brief Gets the current number of spaces that each line is indented with.
         size_t indent() const
         {
@@ -211,9 +271,13 @@ namespace ookii
                 std::swap(_buffer, other._buffer);
                 std::swap(_new_line, other._new_line);
                 std::swap(_space, other._space);
+                std::swap(_ctype, other._ctype);
+                std::swap(_char_classes, other._char_classes);
+                std::swap(_indent_chars, other._indent_chars);
                 std::swap(_indent_count, other._indent_count);
                 std::swap(_need_indent, other._need_indent);
                 std::swap(_count_formatting, other._count_formatting);
+                std::swap(_uses_console_width, other._uses_console_width);
             }
         }
 
@@ -312,8 +376,8 @@ namespace ookii
 
             if (!is_eof(ch))
             {
-                // If the buffer is still full, try to grow it.
-                if (this->pptr() == this->epptr() && !grow_buffer())
+                // If the buffer is still too full, try to grow it.
+                if (!ensure_free_space())
                 {
                     return traits_type::eof();
                 }
@@ -327,6 +391,67 @@ namespace ookii
             return traits_type::not_eof(ch);
         }
 
+        //! \brief Writes multiple characters.
+        //!
+        //! If the buffer holds no unfinished line, complete lines are wrapped and written to
+        //! the underlying stream buffer directly from \p s, and only the final, unfinished line
+        //! is copied into the buffer. This avoids copying most of the text when writing large
+        //! strings.
+        //!
+        //! \param s The characters to write.
+        //! \param count The number of characters to write.
+        //! \return The number of characters written.
+        virtual std::streamsize xsputn(const char_type *s, std::streamsize count) override
+        {
+            if (_base_streambuf == nullptr || count <= 0)
+            {
+                return 0;
+            }
+
+            // If there is no maximum line length set, forward the characters to the base stream.
+            if (_buffer.empty())
+            {
+                return write_unbuffered(s, count);
+            }
+
+            auto current = s;
+            auto end = s + count;
+            while (current < end)
+            {
+                if (this->pptr() == this->pbase())
+                {
+                    // Nothing is pending, so wrap straight from the caller's buffer, and keep only
+                    // the unfinished line.
+                    auto remaining = write_lines(current, end, false);
+                    if (remaining == nullptr || !append_to_buffer(remaining, end))
+                    {
+                        // It's not known how much was written, but some characters may have been.
+                        return 0;
+                    }
+
+                    return count;
+                }
+
+                // There is an unfinished line in the buffer; complete it using the characters up to
+                // and including the next line break. Once that line break is flushed, the buffer
+                // is normally empty again.
+                auto new_line = traits_type::find(current, static_cast<size_t>(end - current), _new_line);
+                auto segment_end = new_line == nullptr ? end : new_line + 1;
+                if (!append_to_buffer(current, segment_end))
+                {
+                    return current - s;
+                }
+
+                current = segment_end;
+                if (new_line != nullptr && !flush_buffer())
+                {
+                    return current - s;
+                }
+            }
+
+            return count;
+        }
+
         //! \brief Flushes the buffer to the underlying stream buffer.
         //!
         //! If the buffer contains a line that's shorter than the maximum and was not terminated by
@@ -370,9 +495,45 @@ namespace ookii
             // Only called when there is a buffer.
             assert(start != nullptr && end != nullptr);
 
+            auto remaining = write_lines(start, end, flush_last_line);
+            if (remaining == nullptr)
+            {
+                return false;
+            }
+
+            if (flush_last_line)
+            {
+                reset_put_area(0);
+            }
+            else if (remaining > start)
+            {
+                // If we flushed any characters, move the remaining characters to the front for the
+                // next flush.
+                std::streamsize count = 0;
+                if (end > remaining)
+                {
+                    count = end - remaining;
+                    traits_type::move(this->pbase(), remaining, static_cast<size_t>(count));
+                }
+
+                // Reset the put area, and indicate the number of characters moved to the front.
+                reset_put_area(static_cast<int>(count));
+            }
+
+            return true;
+        }
+
+        // Write all complete lines in the range [start, end) to the underlying stream buffer,
+        // wrapping lines and adding indentation as necessary. Returns a pointer to the start of
+        // the final, unfinished line, or NULL if writing failed. If flush_last_line is true, that
+        // line is written as well, followed by a line break, and end is returned.
+        //
+        // The range can be the put area, or a buffer passed to xsputn().
+        const char_type *write_lines(const char_type *start, const char_type *end, bool flush_last_line)
+        {
             std::streamsize count;
-            char_type *potential_line_break{};
-            char_type *new_start{};
+            const char_type *potential_line_break{};
+            const char_type *new_start{};
             auto locale = this->getloc();
             size_t line_length{};
             if (_need_indent)
@@ -380,16 +541,28 @@ namespace ookii
                 line_length = _indent_count;
             }
 
-            // Loop over the contents of the buffer.
+            // Loop over the contents of the range.
             for (auto current = start; current < end; ++current)
             {
+                auto char_class = get_char_class(*current);
+                if (char_class == 0 && line_length < _max_line_length)
+                {
+                    // Skip ahead over characters that don't need special handling, as long as
+                    // they fit on the current line.
+                    auto run_end = current + std::min(static_cast<size_t>(end - current), _max_line_length - line_length);
+                    auto next = skip_plain_chars(current + 1, run_end);
+                    line_length += static_cast<size_t>(next - current);
+                    current = next - 1;
+                    continue;
+                }
+
                 // Check if this character can be used as a line break.
-                if (std::isspace(*current, locale))
+                if (char_class & c_class_space)
                 {
                     potential_line_break = current;
                 }
 
-                if (!_count_formatting && traits_type::eq(*current, vt_helper_type::c_escape))
+                if (!_count_formatting && (char_class & c_class_escape))
                 {
                     auto vt_end = vt_helper_type::find_sequence_end(current + 1, end, locale);
                     if (vt_end == nullptr)
@@ -404,7 +577,7 @@ namespace ookii
                 }
 
                 // Check if we need to output a line.
-                if (line_length >= _max_line_length || traits_type::eq(*current, _new_line))
+                if (line_length >= _max_line_length || (char_class & c_class_new_line))
                 {
                     // Before writing the line, add indentation if necessary.
                     // N.B. Don't indent empty lines.
@@ -413,7 +586,7 @@ namespace ookii
                         line_length -= _indent_count;
                         if (line_length > 0 && !write_indent())
                         {
-                            return false;
+                            return nullptr;
                         }
                     }
 
@@ -432,24 +605,23 @@ namespace ookii
                     count = potential_line_break - start;
                     if (_base_streambuf->sputn(start, count) < count)
                     {
-                        return false;
+                        return nullptr;
                     }
 
                     // Write the line break.
                     if (is_eof(_base_streambuf->sputc(_new_line)))
                     {
-                        return false;
+                        return nullptr;
                     }
 
-                    // Update the state for the new line.
+                    // Update the state for the new line, and continue from its start so the
+                    // characters carried over from the previous line are measured the same way
+                    // as any others (skipping VT sequences).
                     start = new_start;
+                    current = new_start - 1;
                     potential_line_break = nullptr;
                     _need_indent = line_length > 0;
-                    line_length = ((current + 1) - start);
-                    if (_need_indent)
-                    {
-                        line_length += _indent_count;
-                    }
+                    line_length = _need_indent ? _indent_count : 0;
                 }
                 else
                 {
@@ -463,35 +635,96 @@ namespace ookii
                 {
                     if (_need_indent && !write_indent())
                     {
-                        return false;
+                        return nullptr;
                     }
 
                     count = end - start;
-                    // Write the remainder of the buffer plus a new line.
+                    // Write the remainder of the range plus a new line.
                     if (_base_streambuf->sputn(start, count) < count ||
                         is_eof(_base_streambuf->sputc(_new_line)))
                     {
-                        return false;
+                        return nullptr;
                     }
                 }
 
-                reset_put_area(0);
+                return end;
             }
-            else if (start > this->pbase())
+
+            return start;
+        }
+
+        // Write characters directly to the underlying stream buffer when there is no maximum line
+        // length, adding indentation after each line break.
+        std::streamsize write_unbuffered(const char_type *s, std::streamsize count)
+        {
+            auto current = s;
+            auto end = s + count;
+            while (current < end)
             {
-                // If we flushed any characters, move the remaining characters to the front for the
-                // next flush.
-                // N.B. line_length can't be used for this because it includes indent character
-                // count.
-                count = 0;
-                if (end > start)
+                auto new_line = traits_type::find(current, static_cast<size_t>(end - current), _new_line);
+                auto segment_end = new_line == nullptr ? end : new_line;
+                if (segment_end > current)
                 {
-                    count = end - start;
-                    traits_type::move(this->pbase(), start, static_cast<size_t>(count));
+                    // Write indentation if needed.
+                    // N.B. Don't indent blank lines.
+                    if (_need_indent && !write_indent())
+                    {
+                        break;
+                    }
+
+                    _blank_line = false;
+                    auto written = _base_streambuf->sputn(current, segment_end - current);
+                    current += written;
+                    if (current < segment_end)
+                    {
+                        break;
+                    }
                 }
 
-                // Reset the put area, and indicate the number of characters moved to the front.
-                reset_put_area(static_cast<int>(count));
+                if (new_line != nullptr)
+                {
+                    // Indicate the next line needs indentation, unless this line was blank.
+                    _need_indent = !_blank_line;
+                    _blank_line = true;
+                    if (is_eof(_base_streambuf->sputc(_new_line)))
+                    {
+                        break;
+                    }
+
+                    ++current;
+                }
+            }
+
+            return current - s;
+        }
+
+        // Copy characters to the put area, flushing the buffer whenever it fills up.
+        bool append_to_buffer(const char_type *begin, const char_type *end)
+        {
+            while (begin < end)
+            {
+                auto count = std::min(end - begin, this->epptr() - this->pptr());
+                traits_type::copy(this->pptr(), begin, static_cast<size_t>(count));
+                this->pbump(static_cast<int>(count));
+                begin += count;
+                if (begin < end && (!flush_buffer() || !ensure_free_space()))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Grow the buffer if less than half of it is available after a flush. Since every flush
+        // scans the whole buffer, this makes sure the cost of a scan is spread over enough new
+        // characters, even if the unfinished line is very long (e.g. because it contains long
+        // VT sequences).
+        bool ensure_free_space()
+        {
+            if ((this->epptr() - this->pptr()) * 2 < this->epptr() - this->pbase())
+            {
+                return grow_buffer();
             }
 
             return true;
@@ -499,7 +732,7 @@ namespace ookii
 
         bool grow_buffer()
         {
-            assert(this->epptr() == this->pptr());
+            auto valid_data = static_cast<int>(this->pptr() - this->pbase());
             auto old_size = static_cast<int>(_buffer.size());
             auto new_size = old_size * 2;
             // Cap consumed memory at 2GB if overflow happened.
@@ -514,10 +747,33 @@ namespace ookii
             }
 
             _buffer.resize(new_size);
-            reset_put_area(old_size);
+            reset_put_area(valid_data);
             return true;
         }
 
+        // Determine the actual maximum line length to use for a requested length.
+        static size_t get_line_length(size_t max_line_length) noexcept
+        {
+            // Check if the caller wants to use the console width.
+            if (max_line_length == use_console_width)
+            {
+                max_line_length = console_width_cache::width();
+                if (max_line_length != 0)
+                {
+                    // Subtract one because it looks nicer.
+                    --max_line_length;
+                }
+            }
+
+            // Don't allow super long lines, to avoid allocating large buffers.
+            if (max_line_length > c_max_allowed_line_length)
+            {
+                max_line_length = c_max_allowed_line_length;
+            }
+
+            return max_line_length;
+        }
+
         // Reset the put area pointers.
         void reset_put_area(int valid_data = 0)
         {
@@ -528,12 +784,68 @@ namespace ookii
             }
         }
 
-        // Update the new line and space characters based on the specified locale.
+        // Update the new line and space characters, and the character class table, based on the
+        // specified locale.
         void update_locale_characters(const std::locale &loc)
         {
-            auto &ctype = std::use_facet<std::ctype<char_type>>(loc);
-            _new_line = ctype.widen('\n');
-            _space = ctype.widen(' ');
+            _ctype = &std::use_facet<std::ctype<char_type>>(loc);
+            _new_line = _ctype->widen('\n');
+            _space = _ctype->widen(' ');
+            _indent_chars.clear();
+            for (size_t i = 0; i < _char_classes.size(); ++i)
+            {
+                _char_classes[i] = classify(static_cast<char_type>(i));
+            }
+        }
+
+        // Determine the class of a character using the ctype facet.
+        unsigned char classify(char_type ch) const
+        {
+            unsigned char result = 0;
+            if (_ctype->is(std::ctype_base::space, ch))
+            {
+                result |= c_class_space;
+            }
+
+            if (traits_type::eq(ch, _new_line))
+            {
+                result |= c_class_new_line;
+            }
+
+            if (traits_type::eq(ch, vt_helper_type::c_escape))
+            {
+                result |= c_class_escape;
+            }
+
+            return result;
+        }
+
+        // Get the class of a character, using the table if possible, which avoids calling into the
+        // locale for every character.
+        unsigned char get_char_class(char_type ch) const
+        {
+            auto value = static_cast<std::make_unsigned_t<char_type>>(ch);
+            if constexpr (sizeof(char_type) > 1)
+            {
+                if (value >= c_char_class_table_size)
+                {
+                    return classify(ch);
+                }
+            }
+
+            return _char_classes[value];
+        }
+
+        // Returns a pointer to the first character in the range that is a space, new line or
+        // escape character, or end if there is none.
+        const char_type *skip_plain_chars(const char_type *current, const char_type *end) const
+        {
+            while (current < end && get_char_class(*current) == 0)
+            {
+                ++current;
+            }
+
+            return current;
         }
 
         // Write indentation to the underlying stream buffer.
@@ -545,12 +857,15 @@ namespace ookii
             }
 
             assert(_need_indent);
-            for (size_t i = 0; i < _indent_count; ++i)
+            if (_indent_chars.size() < _indent_count)
             {
-                if (is_eof(_base_streambuf->sputc(_space)))
-                {
-                    return false;
-                }
+                _indent_chars.assign(_indent_count, _space);
+            }
+
+            auto count = static_cast<std::streamsize>(_indent_count);
+            if (_base_streambuf->sputn(_indent_chars.data(), count) < count)
+            {
+                return false;
             }
 
             _need_indent = false;
@@ -570,16 +885,24 @@ namespace ookii
         }
 
         static constexpr size_t c_max_allowed_line_length = 65536;
+        static constexpr size_t c_char_class_table_size = 256;
+        static constexpr unsigned char c_class_space = 0x1;
+        static constexpr unsigned char c_class_new_line = 0x2;
+        static constexpr unsigned char c_class_escape = 0x4;
 
         base_type *_base_streambuf{};
         size_t _max_line_length{};
         std::vector<char_type> _buffer;
         char_type _new_line{};
         char_type _space{};
+        const std::ctype<char_type> *_ctype{};
+        std::array<unsigned char, c_char_class_table_size> _char_classes{};
+        std::vector<char_type> _indent_chars;
         size_t _indent_count{};
         bool _need_indent{};
         bool _blank_line{true};
         bool _count_formatting{};
+        bool _uses_console_width{};
     };
 
     //! \brief A line wrapping stream buffer for use with the `char` type.
@@ -814,7 +1137,7 @@ namespace ookii
         //!        determined.
         static basic_line_wrapping_ostream for_cout(short default_width = 80)
         {
-            return {console_stream<CharType>::cout(), static_cast<size_t>(get_console_width(default_width))};
+            return {console_stream<CharType>::cout(), static_cast<size_t>(console_width_cache::width(default_width))};
         }
 
         //! \brief Creates a basic_line_wrapping_ostream that writes to the standard error stream,
@@ -824,7 +1147,29 @@ namespace ookii
         //!        determined.
         static basic_line_wrapping_ostream for_cerr(short default_width = 80)
         {
-            return {console_stream<CharType>::cerr(), static_cast<size_t>(get_console_width(default_width))};
+            return {console_stream<CharType>::cerr(), static_cast<size_t>(console_width_cache::width(default_width))};
+        }
+
+        //! \brief Creates a basic_line_wrapping_ostream that writes directly to a file descriptor
+        //!        using an fd_streambuf, using the console width as the line width.
+        //!
+        //! Unlike the streams created by for_cout() and for_cerr(), the returned stream doesn't
+        //! go through `std::cout` or `std::cerr`, so output is collected in a large buffer and
+        //! written with only a few system calls. Flush any output written to `std::cout` for the
+        //! same file descriptor before using this stream.
+        //!
+        //! This method is only available if \a CharType is `char`.
+        //!
+        //! \param fd The file descriptor to write to, for example `STDOUT_FILENO`.
+        //! \param default_width The maximum line length to use if the console width cannot be
+        //!        determined.
+        static basic_line_wrapping_ostream for_fd(int fd, short default_width = 80)
+            requires std::is_same_v<CharType, char>
+        {
+            basic_line_wrapping_ostream result;
+            result._owned_sink = std::make_unique<fd_streambuf>(fd);
+            result._buffer.init(result._owned_sink.get(), static_cast<size_t>(console_width_cache::width(default_width)));
+            return result;
         }
 
         //! \brief Swaps this basic_line_wrapping_ostream instance with another.
@@ -835,6 +1180,7 @@ namespace ookii
             if (this != std::addressof(other))
             {
                 base_type::swap(other);
+                _owned_sink.swap(other._owned_sink);
                 _buffer.swap(other._buffer);
             }
         }
@@ -862,7 +1208,35 @@ namespace ookii
             }
         }
 
+        //! \brief Changes the maximum line length.
+        //!
+        //! The unfinished line that's still in the buffer, if any, will be wrapped using the new
+        //! length.
+        //!
+        //! \param max_line_length The maximum line length, or a value of 0 or larger than 65536
+        //!        to specify no limit. Use the use_console_width constant to use the console width
+        //!        as the maximum.
+        void max_line_length(size_t max_line_length)
+        {
+            if (!_buffer.max_line_length(max_line_length))
+            {
+                this->setstate(basic_line_wrapping_ostream::badbit);
+            }
+        }
+
+        //! \brief Updates the maximum line length if this stream uses the console width and that
+        //!        width has changed.
+        //!
+        //! \return `true` if the maximum line length changed; otherwise, `false`.
+        //! \sa basic_line_wrapping_streambuf::update_console_width()
+        bool update_console_width()
+        {
+            return _buffer.update_console_width();
+        }
+
     private:
+        // Declared before _buffer so it's destroyed after _buffer flushes the last line into it.
+        std::unique_ptr<streambuf_type> _owned_sink;
         basic_line_wrapping_streambuf<CharType, Traits> _buffer;
     };
 
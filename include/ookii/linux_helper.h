@@ -7,11 +7,23 @@
 
 #if !defined(OOKII_NO_PLATFORM_HEADERS) && (!defined(OOKII_CONSOLE_NOT_INLINE) || defined(OOKII_CONSOLE_DEFINITION))
 
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
+#if defined(__linux__)
+#include <sys/inotify.h>
 #endif
 
+#endif
+
+#include <cerrno>
+#include <filesystem>
 #include <optional>
 
 namespace ookii::details
@@ -35,6 +47,235 @@ namespace ookii::details
     }
 #endif
 
+    OOKII_PLATFORM_FUNC(bool set_console_resize_handler(void (*callback)()) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+#if defined(SIGWINCH)
+
+        static void (*s_callback)() = nullptr;
+        static struct sigaction s_previous{};
+
+        struct handler
+        {
+            static void invoke(int signal, siginfo_t *info, void *context)
+            {
+                s_callback();
+
+                // Don't break any handler that was installed before this one.
+                if ((s_previous.sa_flags & SA_SIGINFO) != 0)
+                {
+                    if (s_previous.sa_sigaction != nullptr)
+                    {
+                        s_previous.sa_sigaction(signal, info, context);
+                    }
+                }
+                else if (s_previous.sa_handler != SIG_DFL && s_previous.sa_handler != SIG_IGN)
+                {
+                    s_previous.sa_handler(signal);
+                }
+            }
+        };
+
+        // The handler can only be installed once.
+        if (s_callback != nullptr)
+        {
+            return s_callback == callback;
+        }
+
+        s_callback = callback;
+        struct sigaction action{};
+        action.sa_sigaction = handler::invoke;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART | SA_SIGINFO;
+        if (sigaction(SIGWINCH, &action, &s_previous) != 0)
+        {
+            s_callback = nullptr;
+            return false;
+        }
+
+        return true;
+
+#else
+
+        return false;
+
+#endif
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(bool map_file(const std::filesystem::path &path, const char *&data, size_t &size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        data = nullptr;
+        size = 0;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            close(fd);
+            return false;
+        }
+
+        // An empty file can't be mapped, but that's not an error.
+        if (info.st_size > 0)
+        {
+            auto mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                close(fd);
+                return false;
+            }
+
+            data = static_cast<const char *>(mapping);
+            size = static_cast<size_t>(info.st_size);
+        }
+
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+        return true;
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(void unmap_file(const char *data, size_t size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        if (data != nullptr)
+        {
+            munmap(const_cast<char *>(data), size);
+        }
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(int start_file_watch(const std::filesystem::path &directory) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+#if defined(__linux__)
+
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+
+        // Watch the directory rather than the file, so editors that replace the file by renaming
+        // a new one over it are handled.
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+
+#else
+
+        return -1;
+
+#endif
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(bool wait_for_file_change(int watch, const std::filesystem::path &file_name, int timeout_ms) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+#if defined(__linux__)
+
+        pollfd poll_info{watch, POLLIN, 0};
+        if (poll(&poll_info, 1, timeout_ms) <= 0)
+        {
+            return false;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(watch, buffer, sizeof(buffer))) > 0)
+        {
+            for (auto current = buffer; current < buffer + length; )
+            {
+                auto event = reinterpret_cast<const inotify_event *>(current);
+                if (event->len > 0 && file_name.native() == event->name)
+                {
+                    changed = true;
+                }
+
+                current += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        return changed;
+
+#else
+
+        return false;
+
+#endif
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(void stop_file_watch(int watch) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        if (watch >= 0)
+        {
+            close(watch);
+        }
+    }
+#endif
+
+
+    // Writes both buffers to the file descriptor with as few system calls as possible, retrying
+    // after partial writes and interrupts.
+    OOKII_PLATFORM_FUNC(bool write_fd(int fd, const char *first, size_t first_size, const char *second, size_t second_size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        iovec buffers[2]{{const_cast<char *>(first), first_size}, {const_cast<char *>(second), second_size}};
+        iovec *current = buffers;
+        int count = 2;
+        while (count > 0)
+        {
+            if (current->iov_len == 0)
+            {
+                ++current;
+                --count;
+                continue;
+            }
+
+            auto written = writev(fd, current, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            auto remaining = static_cast<size_t>(written);
+            while (count > 0 && remaining >= current->iov_len)
+            {
+                remaining -= current->iov_len;
+                ++current;
+                --count;
+            }
+
+            if (count > 0)
+            {
+                current->iov_base = static_cast<char *>(current->iov_base) + remaining;
+                current->iov_len -= remaining;
+            }
+        }
+
+        return true;
+    }
+#endif
+
 }
 
 #endif
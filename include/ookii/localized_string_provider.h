@@ -89,6 +89,70 @@ namespace ookii
             return OOKII_FMT_NS format(defaults::combined_short_name_non_switch.data(), argument_name);
         }
 
+        //! \brief Gets the error message for parse_error::unreadable_value_file.
+        //! \param argument_name The name of the argument.
+        virtual string_type unreadable_value_file(string_view_type argument_name) const
+        {
+            return OOKII_FMT_NS format(defaults::unreadable_value_file_format.data(), argument_name);
+        }
+
+        //! \brief Gets the error message for parse_error::too_many_tokens.
+        virtual string_type too_many_tokens() const
+        {
+            return defaults::too_many_tokens.data();
+        }
+
+        //! \brief Gets the error message for parse_error::value_too_long.
+        //! \param argument_name The name of the argument.
+        virtual string_type value_too_long(string_view_type argument_name) const
+        {
+            return OOKII_FMT_NS format(defaults::value_too_long_format.data(), argument_name);
+        }
+
+        //! \brief Gets the error message for parse_error::too_many_values.
+        //! \param argument_name The name of the argument.
+        virtual string_type too_many_values(string_view_type argument_name) const
+        {
+            return OOKII_FMT_NS format(defaults::too_many_values_format.data(), argument_name);
+        }
+
+        //! \brief Gets the error message for parse_error::total_value_length_exceeded.
+        virtual string_type total_value_length_exceeded() const
+        {
+            return defaults::total_value_length_exceeded.data();
+        }
+
+        //! \brief Gets the error message used by basic_command_shell when a line contains an
+        //!        unterminated quote or ends with a backslash.
+        virtual string_type unterminated_command_line() const
+        {
+            return defaults::unterminated_command_line.data();
+        }
+
+        //! \brief Gets the error message used by basic_command_manager::run_script() when the
+        //!        script file could not be opened.
+        //! \param path The path of the script file.
+        virtual string_type unreadable_script_file(string_view_type path) const
+        {
+            return OOKII_FMT_NS format(defaults::unreadable_script_file_format.data(), path);
+        }
+
+        //! \brief Gets the error message used by basic_command_manager::run_script() after the
+        //!        error for a line that could not be parsed.
+        //! \param line_number The line number, starting at one.
+        virtual string_type script_line_error(size_t line_number) const
+        {
+            return OOKII_FMT_NS format(defaults::script_line_error_format.data(), line_number);
+        }
+
+        //! \brief Gets the error message used when the shared library of a command added using
+        //!        basic_command_manager::add_plugin_command() could not be loaded.
+        //! \param name The name of the command.
+        virtual string_type unloadable_plugin_command(string_view_type name) const
+        {
+            return OOKII_FMT_NS format(defaults::unloadable_plugin_command_format.data(), name);
+        }
+
         //! \brief Gets the error message for parse_error::unknown.
         virtual string_type unknown_error() const
         {
@@ -154,6 +218,15 @@ namespace ookii
             static constexpr auto too_many_arguments = literal_cast<CharType>("Too many arguments were supplied.");
             static constexpr auto missing_required_argument_format = literal_cast<CharType>("The required argument '{}' was not supplied.");
             static constexpr auto combined_short_name_non_switch = literal_cast<CharType>("The combined short argument '{}' contains an argument that is not a switch.");
+            static constexpr auto unreadable_value_file_format = literal_cast<CharType>("The file specified for the argument '{}' could not be read.");
+            static constexpr auto too_many_tokens = literal_cast<CharType>("The command line contains more arguments than are allowed.");
+            static constexpr auto value_too_long_format = literal_cast<CharType>("The value provided for the argument '{}' is too long.");
+            static constexpr auto too_many_values_format = literal_cast<CharType>("Too many values were supplied for the argument '{}'.");
+            static constexpr auto total_value_length_exceeded = literal_cast<CharType>("The combined length of the supplied values is too large.");
+            static constexpr auto unterminated_command_line = literal_cast<CharType>("The command line contains an unterminated quote.");
+            static constexpr auto unreadable_script_file_format = literal_cast<CharType>("The script file '{}' could not be read.");
+            static constexpr auto script_line_error_format = literal_cast<CharType>("The script was not run because of an error in line {}.");
+            static constexpr auto unloadable_plugin_command_format = literal_cast<CharType>("The command '{}' could not be loaded.");
             static constexpr auto unknown = literal_cast<CharType>("An unknown error has occurred.");
             static constexpr auto automatic_help_name = literal_cast<CharType>("Help");
             static constexpr CharType automatic_help_short_name = '?';
@@ -42,7 +42,28 @@ namespace ookii
         missing_required_argument,
 
         //! \brief A combined short argument contains an argument that is not a switch.
-        combined_short_name_non_switch
+        combined_short_name_non_switch,
+
+        //! \brief The file specified as the value of an argument using
+        //!        basic_parser_builder::argument_builder_common::allow_value_from_file() or
+        //!        basic_parser_builder::multi_value_argument_builder::values_from_stream() could
+        //!        not be opened.
+        unreadable_value_file,
+
+        //! \brief The command line contained more arguments than allowed by
+        //!        basic_parser_builder::max_token_count().
+        too_many_tokens,
+
+        //! \brief A value was longer than allowed by basic_parser_builder::max_value_length().
+        value_too_long,
+
+        //! \brief A multi-value argument had more values than allowed by
+        //!        basic_parser_builder::max_value_count().
+        too_many_values,
+
+        //! \brief The combined length of all values was more than allowed by
+        //!        basic_parser_builder::max_total_value_length().
+        total_value_length_exceeded
     };
 
     //! \brief Provides the result, success or error, of a command line argument parsing operation.
@@ -131,6 +152,21 @@ namespace ookii
             case parse_error::combined_short_name_non_switch:
                 return string_provider->combined_short_name_non_switch(error_arg_name);
 
+            case parse_error::unreadable_value_file:
+                return string_provider->unreadable_value_file(error_arg_name);
+
+            case parse_error::too_many_tokens:
+                return string_provider->too_many_tokens();
+
+            case parse_error::value_too_long:
+                return string_provider->value_too_long(error_arg_name);
+
+            case parse_error::too_many_values:
+                return string_provider->too_many_values(error_arg_name);
+
+            case parse_error::total_value_length_exceeded:
+                return string_provider->total_value_length_exceeded();
+
             default:
                 return string_provider->unknown_error();
             }
@@ -0,0 +1,366 @@
+//! \file reloadable_options.h
+//! \brief Provides the ookii::basic_reloadable_options class.
+#ifndef OOKII_RELOADABLE_OPTIONS_H_
+#define OOKII_RELOADABLE_OPTIONS_H_
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "command_line_builder.h"
+
+namespace ookii
+{
+    //! \brief Holds an immutable snapshot of parsed arguments that can be replaced while the
+    //!        application is running.
+    //!
+    //! Long-running applications can use this class to re-read their options, for example from
+    //! a configuration file added using basic_parser_builder::config_file(), without restarting.
+    //!
+    //! Every call to reload() default-constructs a new `Options` instance, uses the factory
+    //! function passed to the constructor to create a basic_command_line_parser whose arguments
+    //! are bound to it, and parses the original command line again. If parsing succeeds, the
+    //! result is published as the new snapshot; otherwise, the current snapshot is kept. The
+    //! parser is kept alive as long as its snapshot, so members of type `std::basic_string_view`,
+    //! which may refer to memory owned by the parser, stay valid. Since
+    //! the command line takes precedence over configuration files and environment variables,
+    //! only arguments that were not supplied on the command line can change.
+    //!
+    //! Snapshots are never modified after they are published, so they can be read from any
+    //! thread without locking. The current() method returns a `std::shared_ptr` to the current
+    //! snapshot. Threads that read the options often should use a reader instead, which only
+    //! does a single atomic load unless a new snapshot was published.
+    //!
+    //! The watch() method starts a thread that calls reload() whenever a file changes. On Linux,
+    //! this uses inotify; on other platforms, the file's modification time is polled.
+    //!
+    //! Two typedefs for common character types are provided:
+    //!
+    //! Type                                   | Definition
+    //! -------------------------------------- | -------------------------------------
+    //! `ookii::reloadable_options<Options>`   | `ookii::basic_reloadable_options<Options, char>`
+    //! `ookii::wreloadable_options<Options>`  | `ookii::basic_reloadable_options<Options, wchar_t>`
+    //!
+    //! \tparam Options The type that holds the argument values. This type must be default
+    //!         constructible.
+    //! \tparam CharType The character type used for arguments and other strings.
+    //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use for strings. Defaults to `std::allocator<CharType>`.
+    template<typename Options, typename CharType = details::default_char_type, typename Traits = std::char_traits<CharType>,
+        typename Alloc = std::allocator<CharType>>
+    class basic_reloadable_options
+    {
+    public:
+        //! \brief The specialized type of basic_command_line_parser used.
+        using parser_type = basic_command_line_parser<CharType, Traits, Alloc>;
+        //! \brief The specialized type of parse_result used.
+        using result_type = typename parser_type::result_type;
+        //! \brief The specialized type of `std::basic_string` used.
+        using string_type = typename parser_type::string_type;
+        //! \brief The type of a pointer to a snapshot.
+        using snapshot_type = std::shared_ptr<const Options>;
+        //! \brief The type of the function that creates a parser bound to an `Options` instance.
+        using parser_factory = std::function<parser_type(Options &)>;
+        //! \brief The type of the function called after the watcher thread reloaded the options.
+        using reload_callback = std::function<void(const result_type &)>;
+
+        //! \brief Provides fast access to the current snapshot for a single thread.
+        //!
+        //! A reader keeps a reference to the last snapshot it returned, and only gets the new
+        //! snapshot if the generation() of the basic_reloadable_options has changed. Checking the
+        //! generation is a single atomic load, so get() is wait-free unless a reload happened.
+        //!
+        //! A reader must not be used by more than one thread at a time. Create one reader for
+        //! each thread instead.
+        class reader
+        {
+        public:
+            //! \brief Initializes a new instance of the reader class.
+            //! \param owner The basic_reloadable_options to read from. The reader must not
+            //!        outlive it.
+            explicit reader(const basic_reloadable_options &owner) noexcept
+                : _owner{&owner}
+            {
+            }
+
+            //! \brief Gets the current snapshot.
+            //!
+            //! The returned reference stays valid until the next call to get() on this reader, or
+            //! until the reader is destroyed, even if a reload happens in the meantime.
+            const Options &get()
+            {
+                auto generation = _owner->_generation.load(std::memory_order_acquire);
+                if (generation != _generation || !_snapshot)
+                {
+                    _snapshot = _owner->current();
+                    _generation = generation;
+                }
+
+                return *_snapshot;
+            }
+
+            //! \brief Provides access to the members of the current snapshot.
+            const Options *operator->()
+            {
+                return &get();
+            }
+
+        private:
+            const basic_reloadable_options *_owner;
+            snapshot_type _snapshot;
+            std::uint64_t _generation{};
+        };
+
+        //! \brief Initializes a new instance of the basic_reloadable_options class.
+        //!
+        //! The initial snapshot is a default-constructed `Options` instance; call reload() to
+        //! parse the arguments for the first time.
+        //!
+        //! \param factory A function that creates a basic_command_line_parser whose arguments are
+        //!        bound to the members of the `Options` instance passed to it.
+        //! \param args The command line arguments to parse on every reload, not including the
+        //!        application name.
+        basic_reloadable_options(parser_factory factory, std::vector<string_type> args = {})
+            : _factory{std::move(factory)},
+              _args{std::move(args)}
+        {
+            if (!_factory)
+            {
+                throw std::invalid_argument("factory");
+            }
+
+            store_snapshot(std::make_shared<const Options>());
+        }
+
+        //! \brief Initializes a new instance of the basic_reloadable_options class, using the
+        //!        arguments passed to `main()`.
+        //!
+        //! \param factory A function that creates a basic_command_line_parser whose arguments are
+        //!        bound to the members of the `Options` instance passed to it.
+        //! \param argc The number of arguments.
+        //! \param argv The arguments. The first argument is assumed to be the application name
+        //!        and is skipped.
+        basic_reloadable_options(parser_factory factory, int argc, const CharType *const argv[])
+            : basic_reloadable_options{std::move(factory), argc > 1
+                ? std::vector<string_type>{argv + 1, argv + argc}
+                : std::vector<string_type>{}}
+        {
+        }
+
+        basic_reloadable_options(const basic_reloadable_options &) = delete;
+        basic_reloadable_options &operator=(const basic_reloadable_options &) = delete;
+
+        //! \brief Stops the watcher thread, if it's running.
+        ~basic_reloadable_options()
+        {
+            stop_watching();
+        }
+
+        //! \brief Parses the arguments again and publishes the result as the new snapshot.
+        //!
+        //! If parsing fails, the current snapshot remains in use. This method can be called from
+        //! any thread; concurrent reloads are serialized.
+        //!
+        //! \return A parse_result that indicates whether the operation was successful.
+        result_type reload()
+        {
+            std::lock_guard lock{_reload_mutex};
+            auto state = std::make_shared<snapshot_state>();
+            state->parser.emplace(_factory(state->options));
+            auto result = state->parser->parse(_args.begin(), _args.end());
+            if (result)
+            {
+                store_snapshot(snapshot_type{state, &state->options});
+            }
+
+            return result;
+        }
+
+        //! \brief Gets the current snapshot.
+        //!
+        //! The snapshot remains valid as long as the returned pointer exists, even if a reload
+        //! happens in the meantime.
+        snapshot_type current() const
+        {
+#ifdef __cpp_lib_atomic_shared_ptr
+            return _snapshot.load(std::memory_order_acquire);
+#else
+            std::lock_guard lock{_snapshot_mutex};
+            return _snapshot;
+#endif
+        }
+
+        //! \brief Gets a number that is incremented every time a new snapshot is published.
+        std::uint64_t generation() const noexcept
+        {
+            return _generation.load(std::memory_order_acquire);
+        }
+
+        //! \brief Starts a thread that calls reload() whenever the specified file changes.
+        //!
+        //! On Linux, the file's directory is watched using inotify, so changes are picked up
+        //! immediately, including when the file is replaced by renaming another file over it. On
+        //! other platforms, the file's modification time and size are checked every
+        //! \a poll_interval.
+        //!
+        //! \param path The path of the file to watch, typically one that was passed to
+        //!        basic_parser_builder::config_file().
+        //! \param callback A function called on the watcher thread after every reload, with the
+        //!        result of parsing. May be empty.
+        //! \param poll_interval The interval used when the platform can't notify about changes.
+        //! \exception std::logic_error The watcher thread is already running.
+        void watch(std::filesystem::path path, reload_callback callback = {},
+            std::chrono::milliseconds poll_interval = std::chrono::seconds{1})
+        {
+            if (_watcher.joinable())
+            {
+                throw std::logic_error("The watcher thread is already running.");
+            }
+
+            // The watch is created before the thread starts, so no change made after this method
+            // returns can be missed.
+            auto directory = path.parent_path();
+            if (directory.empty())
+            {
+                directory = ".";
+            }
+
+            auto handle = details::start_file_watch(directory);
+            _stop = false;
+            _watcher = std::thread{[this, handle, path = std::move(path), callback = std::move(callback), poll_interval]()
+                {
+                    watch_thread(handle, path, callback, poll_interval);
+                }};
+        }
+
+        //! \brief Stops the thread started by watch().
+        //!
+        //! This method does nothing if the watcher thread is not running.
+        void stop_watching()
+        {
+            if (!_watcher.joinable())
+            {
+                return;
+            }
+
+            {
+                std::lock_guard lock{_stop_mutex};
+                _stop = true;
+            }
+
+            _stop_condition.notify_all();
+            _watcher.join();
+        }
+
+    private:
+        // The interval at which the inotify watcher checks whether it should stop.
+        static constexpr int c_stop_check_ms = 100;
+
+        // A snapshot owns the parser that created it, because string_view values can point into
+        // memory owned by the parser, such as values read from a configuration file.
+        struct snapshot_state
+        {
+            Options options;
+            std::optional<parser_type> parser;
+        };
+
+        void store_snapshot(snapshot_type snapshot)
+        {
+#ifdef __cpp_lib_atomic_shared_ptr
+            _snapshot.store(std::move(snapshot), std::memory_order_release);
+#else
+            {
+                std::lock_guard lock{_snapshot_mutex};
+                _snapshot = std::move(snapshot);
+            }
+#endif
+
+            // Incremented after the snapshot is stored, so a reader that sees the new generation
+            // also sees the new snapshot.
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+
+        void watch_thread(int handle, const std::filesystem::path &path, const reload_callback &callback,
+            std::chrono::milliseconds poll_interval)
+        {
+            auto reload_and_notify = [this, &callback]()
+            {
+                auto result = reload();
+                if (callback)
+                {
+                    callback(result);
+                }
+            };
+
+            if (handle >= 0)
+            {
+                auto file_name = path.filename();
+                while (!_stop.load())
+                {
+                    if (details::wait_for_file_change(handle, file_name, c_stop_check_ms))
+                    {
+                        reload_and_notify();
+                    }
+                }
+
+                details::stop_file_watch(handle);
+                return;
+            }
+
+            auto last_state = get_file_state(path);
+            std::unique_lock lock{_stop_mutex};
+            while (!_stop_condition.wait_for(lock, poll_interval, [this]() { return _stop.load(); }))
+            {
+                auto state = get_file_state(path);
+                if (state != last_state)
+                {
+                    last_state = state;
+                    lock.unlock();
+                    reload_and_notify();
+                    lock.lock();
+                }
+            }
+        }
+
+        static std::pair<std::filesystem::file_time_type, std::uintmax_t> get_file_state(const std::filesystem::path &path)
+        {
+            std::error_code error;
+            auto time = std::filesystem::last_write_time(path, error);
+            auto size = std::filesystem::file_size(path, error);
+            return {time, size};
+        }
+
+        parser_factory _factory;
+        std::vector<string_type> _args;
+        std::mutex _reload_mutex;
+#ifdef __cpp_lib_atomic_shared_ptr
+        std::atomic<snapshot_type> _snapshot;
+#else
+        mutable std::mutex _snapshot_mutex;
+        snapshot_type _snapshot;
+#endif
+        std::atomic<std::uint64_t> _generation{};
+        std::thread _watcher;
+        std::mutex _stop_mutex;
+        std::condition_variable _stop_condition;
+        std::atomic<bool> _stop{};
+    };
+
+    //! \brief Typedef for basic_reloadable_options using `char` as the character type.
+    template<typename Options>
+    using reloadable_options = basic_reloadable_options<Options, char>;
+
+    //! \brief Typedef for basic_reloadable_options using `wchar_t` as the character type.
+    template<typename Options>
+    using wreloadable_options = basic_reloadable_options<Options, wchar_t>;
+}
+
+#endif
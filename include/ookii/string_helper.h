@@ -12,6 +12,12 @@
 #include <string>
 #include <string_view>
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
 
 namespace ookii
 {
@@ -61,9 +67,12 @@ namespace ookii
             }
             else
             {
-                return std::lexicographical_compare(begin(left), end(left), begin(right), end(right), [this](auto left, auto right) 
+                // Getting the facet once is much faster than using std::toupper for every character.
+                using char_type = std::remove_cvref_t<decltype(*begin(left))>;
+                const auto &ctype = std::use_facet<std::ctype<char_type>>(_locale);
+                return std::lexicographical_compare(begin(left), end(left), begin(right), end(right), [&ctype](auto left, auto right) 
                     {
-                        return std::toupper(left, _locale) < std::toupper(right, _locale); 
+                        return ctype.toupper(left) < ctype.toupper(right); 
                     });
             }
         }
@@ -252,6 +261,27 @@ namespace ookii
         }
     };
 
+    //! \brief Specialization of lexical_convert for string views.
+    //!
+    //! This returns a view of the original value, so no memory is allocated or copied. The view
+    //! refers to the string that was passed to basic_command_line_parser::parse(), so it's only
+    //! valid as long as that string is.
+    //!
+    //! \tparam CharType The character type used.
+    //! \tparam Traits The character traits to use. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use. Defaults to `std::allocator<CharType>`.
+    template<typename CharType, typename Traits, typename Alloc>
+    struct lexical_convert<std::basic_string_view<CharType, Traits>, CharType, Traits, Alloc>
+    {
+        //! \brief Convert a string to the specified type.
+        //! \param value The string value to convert.
+        //! \return The unmodified value.
+        static std::optional<std::basic_string_view<CharType, Traits>> from_string(std::basic_string_view<CharType, Traits> value, const std::locale &)
+        {
+            return {value};
+        }
+    };
+
     //! \brief A pseudo-range for string tokenization.
     //!
     //! This type lets the user tokenize a string and iterate over the results. It's not quite a
@@ -397,6 +427,301 @@ namespace ookii
 
         return {value.substr(0, index), value.substr(index + 1)};
     }
+
+    //! \brief Holds the arguments produced by splitting a command line string using POSIX shell
+    //!        quoting rules.
+    //!
+    //! Use the split() method or the split_command_line() function to create an instance. All the
+    //! arguments are stored in a single allocation, as null-terminated strings, so they can be
+    //! passed to both basic_command_line_parser::parse() and
+    //! basic_command_manager::create_command() without copying them again. The views and
+    //! pointers remain valid as long as this object exists, including after it's moved.
+    //!
+    //! Two typedefs for common character types are provided:
+    //!
+    //! Type                          | Definition
+    //! ----------------------------- | -------------------------------------
+    //! `ookii::command_line_tokens`  | `ookii::basic_command_line_tokens<char>`
+    //! `ookii::wcommand_line_tokens` | `ookii::basic_command_line_tokens<wchar_t>`
+    //!
+    //! \tparam CharType The character type used.
+    //! \tparam Traits The character traits to use. Defaults to `std::char_traits<CharType>`.
+    template<typename CharType, typename Traits = std::char_traits<CharType>>
+    class basic_command_line_tokens
+    {
+    public:
+        //! \brief The concrete type of `std::basic_string_view` used.
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+        //! \brief The type of iterator over the arguments.
+        using const_iterator = const string_view_type *;
+
+        //! \brief Initializes a new instance of the basic_command_line_tokens class that contains
+        //!        no arguments.
+        basic_command_line_tokens() noexcept = default;
+
+        //! \brief Move constructor.
+        //! \param other The object to move from.
+        basic_command_line_tokens(basic_command_line_tokens &&other) noexcept
+            : _buffer{std::move(other._buffer)},
+              _capacity{std::exchange(other._capacity, 0)},
+              _count{std::exchange(other._count, 0)}
+        {
+        }
+
+        //! \brief Move assignment operator.
+        //! \param other The object to move from.
+        //! \return A reference to this object.
+        basic_command_line_tokens &operator=(basic_command_line_tokens &&other) noexcept
+        {
+            _buffer = std::move(other._buffer);
+            _capacity = std::exchange(other._capacity, 0);
+            _count = std::exchange(other._count, 0);
+            return *this;
+        }
+
+        //! \brief Splits a command line into arguments.
+        //!
+        //! The rules are those of a POSIX shell, without any expansions:
+        //! - Arguments are separated by unquoted white space.
+        //! - Text in single quotes is used literally.
+        //! - In double quotes, a backslash only escapes `$`, `` ` ``, `"`, `\` and a new line;
+        //!   otherwise, it is kept.
+        //! - Outside of quotes, a backslash escapes any character.
+        //! - A backslash followed by a new line is removed.
+        //! - Quoted and unquoted parts that are not separated by white space form a single
+        //!   argument, and empty quotes form an empty argument.
+        //!
+        //! \param command_line The command line to split.
+        //! \return The arguments, or `std::nullopt` if the command line contains an unterminated
+        //!         quote or ends with a backslash.
+        static std::optional<basic_command_line_tokens> split(string_view_type command_line)
+        {
+            // Every argument starts with a non-white-space character that follows white space, so
+            // counting those gives an upper bound for the number of arguments. The output never
+            // needs more characters than the input, plus one for the last terminator.
+            size_t max_count = 0;
+            bool previous_space = true;
+            for (auto ch : command_line)
+            {
+                auto space = is_space(ch);
+                if (!space && previous_space)
+                {
+                    ++max_count;
+                }
+
+                previous_space = space;
+            }
+
+            basic_command_line_tokens result;
+            result.allocate(max_count, command_line.size() + 1);
+            if (!result.split_into(command_line))
+            {
+                return {};
+            }
+
+            return result;
+        }
+
+        //! \brief Gets the arguments as null-terminated strings.
+        //!
+        //! The result can be passed to basic_command_manager::create_command().
+        std::span<const CharType *const> args() const noexcept
+        {
+            return {args_data(), _count};
+        }
+
+        //! \brief Gets the arguments as string views.
+        std::span<const string_view_type> views() const noexcept
+        {
+            return {views_data(), _count};
+        }
+
+        //! \brief Gets an iterator to the first argument.
+        const_iterator begin() const noexcept
+        {
+            return views_data();
+        }
+
+        //! \brief Gets an iterator to directly after the last argument.
+        const_iterator end() const noexcept
+        {
+            return views_data() + _count;
+        }
+
+        //! \brief Gets the number of arguments.
+        size_t size() const noexcept
+        {
+            return _count;
+        }
+
+        //! \brief Gets a value that indicates whether there are no arguments.
+        bool empty() const noexcept
+        {
+            return _count == 0;
+        }
+
+        //! \brief Gets the argument at the specified index.
+        //! \param index The index of the argument.
+        const string_view_type &operator[](size_t index) const noexcept
+        {
+            return views_data()[index];
+        }
+
+    private:
+        static bool is_space(CharType ch) noexcept
+        {
+            return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f' || ch == '\v';
+        }
+
+        // The views, the pointers and the characters share a single allocation, in that order.
+        void allocate(size_t max_count, size_t char_count)
+        {
+            _capacity = max_count;
+            _buffer.reset(new std::byte[max_count * (sizeof(string_view_type) + sizeof(const CharType *)) +
+                char_count * sizeof(CharType)]);
+        }
+
+        const string_view_type *views_data() const noexcept
+        {
+            return reinterpret_cast<const string_view_type *>(_buffer.get());
+        }
+
+        const CharType *const *args_data() const noexcept
+        {
+            return reinterpret_cast<const CharType *const *>(_buffer.get() + _capacity * sizeof(string_view_type));
+        }
+
+        CharType *chars_data() const noexcept
+        {
+            return reinterpret_cast<CharType *>(_buffer.get() + _capacity * (sizeof(string_view_type) + sizeof(const CharType *)));
+        }
+
+        bool split_into(string_view_type command_line)
+        {
+            auto views = _buffer.get();
+            auto args = _buffer.get() + _capacity * sizeof(string_view_type);
+            auto out = chars_data();
+            auto current = command_line.begin();
+            auto end = command_line.end();
+            while (true)
+            {
+                while (current != end && is_space(*current))
+                {
+                    ++current;
+                }
+
+                if (current == end)
+                {
+                    break;
+                }
+
+                auto start = out;
+                bool quoted = false;
+                while (current != end && !is_space(*current))
+                {
+                    auto ch = *current++;
+                    if (ch == '\\')
+                    {
+                        if (current == end)
+                        {
+                            return false;
+                        }
+
+                        if (*current != '\n')
+                        {
+                            *out++ = *current;
+                        }
+
+                        ++current;
+                    }
+                    else if (ch == '\'')
+                    {
+                        quoted = true;
+                        auto close = std::find(current, end, static_cast<CharType>('\''));
+                        if (close == end)
+                        {
+                            return false;
+                        }
+
+                        out = std::copy(current, close, out);
+                        current = close + 1;
+                    }
+                    else if (ch == '"')
+                    {
+                        quoted = true;
+                        while (current != end && *current != '"')
+                        {
+                            if (*current == '\\' && current + 1 != end)
+                            {
+                                auto next = current[1];
+                                if (next == '\n')
+                                {
+                                    current += 2;
+                                    continue;
+                                }
+
+                                if (next == '$' || next == '`' || next == '"' || next == '\\')
+                                {
+                                    ++current;
+                                }
+                            }
+
+                            *out++ = *current++;
+                        }
+
+                        if (current == end)
+                        {
+                            return false;
+                        }
+
+                        ++current;
+                    }
+                    else
+                    {
+                        *out++ = ch;
+                    }
+                }
+
+                // A line continuation on its own doesn't produce an argument.
+                if (out == start && !quoted)
+                {
+                    continue;
+                }
+
+                assert(_count < _capacity);
+                new (views + _count * sizeof(string_view_type)) string_view_type{start, static_cast<size_t>(out - start)};
+                new (args + _count * sizeof(const CharType *)) const CharType *{start};
+                *out++ = '\0';
+                ++_count;
+            }
+
+            return true;
+        }
+
+        std::unique_ptr<std::byte[]> _buffer;
+        size_t _capacity{};
+        size_t _count{};
+    };
+
+    //! \brief Typedef for basic_command_line_tokens using `char` as the character type.
+    using command_line_tokens = basic_command_line_tokens<char>;
+    //! \brief Typedef for basic_command_line_tokens using `wchar_t` as the character type.
+    using wcommand_line_tokens = basic_command_line_tokens<wchar_t>;
+
+    //! \brief Splits a command line into arguments using POSIX shell quoting rules.
+    //!
+    //! See basic_command_line_tokens::split() for the rules that are used.
+    //!
+    //! \tparam CharType The character type used.
+    //! \tparam Traits The character traits to use.
+    //! \param command_line The command line to split.
+    //! \return The arguments, or `std::nullopt` if the command line contains an unterminated
+    //!         quote or ends with a backslash.
+    template<typename CharType, typename Traits>
+    std::optional<basic_command_line_tokens<CharType, Traits>> split_command_line(std::basic_string_view<CharType, Traits> command_line)
+    {
+        return basic_command_line_tokens<CharType, Traits>::split(command_line);
+    }
 }
 
 #endif
\ No newline at end of file
@@ -7,7 +7,14 @@
 #pragma once
 
 #include "command_line_builder.h"
+#include "task.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <span>
+#include <sstream>
+#include <vector>
 
 namespace ookii
 {
@@ -88,6 +95,17 @@ namespace ookii
         //! \return The exit code for the command. Typically, this code will be returned from the
         //!         application to the OS.
         virtual int run() = 0;
+
+        //! \brief Runs the command asynchronously, after argument parsing was successful.
+        //!
+        //! This is used by basic_command_manager::run_command_async(). The default implementation
+        //! calls run(). Derive from basic_async_command to implement a command as a coroutine.
+        //!
+        //! \return A task that produces the exit code for the command.
+        virtual task<int> run_async()
+        {
+            co_return run();
+        }
     };
 
     //! \brief Typedef for basic_command using `char` as the character type.
@@ -95,6 +113,40 @@ namespace ookii
     //! \brief Typedef for basic_command using `wchar_t` as the character type.
     using wcommand = basic_command<wchar_t>;
 
+    //! \brief Abstract base class for subcommands that run as a coroutine.
+    //!
+    //! Implement the run_async() method instead of the run() method. When the command is used
+    //! with basic_command_manager::run_command_async(), the task can await other tasks without
+    //! blocking a thread. When the command is used with basic_command_manager::run_command(), the
+    //! run() method waits for the task on the calling thread.
+    //!
+    //! Several typedefs for common character types are provided:
+    //!
+    //! Type                    | Definition
+    //! ----------------------- | -------------------------------------
+    //! `ookii::async_command`  | `ookii::basic_async_command<char>`
+    //! `ookii::wasync_command` | `ookii::basic_async_command<wchar_t>`
+    template<typename CharType, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
+    class basic_async_command : public basic_command<CharType, Traits, Alloc>
+    {
+    public:
+        //! \brief Runs the command, and waits for it to finish.
+        //! \return The exit code produced by the task returned from run_async().
+        int run() override
+        {
+            return run_async().get();
+        }
+
+        //! \brief Runs the command asynchronously, after argument parsing was successful.
+        //! \return A task that produces the exit code for the command.
+        task<int> run_async() override = 0;
+    };
+
+    //! \brief Typedef for basic_async_command using `char` as the character type.
+    using async_command = basic_async_command<char>;
+    //! \brief Typedef for basic_async_command using `wchar_t` as the character type.
+    using wasync_command = basic_async_command<wchar_t>;
+
     //! \brief Abstract base class for subcommands that do their own argument parsing.
     //! \tparam CharType The character type used for arguments and other strings.
     //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
@@ -152,6 +204,10 @@ namespace ookii
         using string_type = std::basic_string<CharType, Traits, Alloc>;
         //! \brief The type of a function that instantiates a subcommand.
         using creator = std::function<std::unique_ptr<command_type>(builder_type *)>;
+        //! \brief The concrete type of basic_command_manager used.
+        using command_manager_type = basic_command_manager<CharType, Traits, Alloc>;
+        //! \brief The type of a function that adds the child commands of a parent command.
+        using register_children_function = std::function<void(command_manager_type &)>;
 
     public:
 
@@ -202,15 +258,30 @@ namespace ookii
             return {name, description, creator, true};
         }
 
+        //! \brief Creates a command_info instance for a parent command, which has child commands
+        //!        instead of arguments.
+        //!
+        //! \param name The name of the subcommand.
+        //! \param description The description of the subcommand.
+        //! \param register_children A function that adds the child commands to the
+        //!        basic_command_manager passed to it.
+        static command_info create_parent(string_type name, string_type description, register_children_function register_children)
+        {
+            command_info info{name, description, {}};
+            info._register_children = std::move(register_children);
+            return info;
+        }
+
         //! \brief Creates an instance of the subcommand type.
         //! 
         //! \param builder The basic_parser_builder to pass to the subcommand type's constructor.
         //! \return An instance of the subcommand type.
         //!
-        //! This function returns `nullptr` if this command uses custom argument parsing.
+        //! This function returns `nullptr` if this command uses custom argument parsing, or is a
+        //! parent command.
         std::unique_ptr<command_type> create(builder_type &builder) const
         {
-            if (_use_custom_argument_parsing)
+            if (_use_custom_argument_parsing || is_parent_command())
             {
                 return {};
             }
@@ -242,6 +313,27 @@ namespace ookii
             return _use_custom_argument_parsing;
         }
 
+        //! \brief Gets a value that indicates whether the command is a parent command, which has
+        //!        child commands instead of arguments.
+        //! \return `true` if the command was created using create_parent(); otherwise, `false`.
+        bool is_parent_command() const noexcept
+        {
+            return static_cast<bool>(_register_children);
+        }
+
+        //! \brief Adds the child commands of a parent command to a basic_command_manager.
+        //!
+        //! This function does nothing if this command is not a parent command.
+        //!
+        //! \param manager The basic_command_manager to add the child commands to.
+        void register_children(command_manager_type &manager) const
+        {
+            if (_register_children)
+            {
+                _register_children(manager);
+            }
+        }
+
         //! \brief Gets the name of the subcommand.
         const string_type &name() const noexcept
         {
@@ -258,9 +350,72 @@ namespace ookii
         string_type _name;
         string_type _description;
         creator _creator;
+        register_children_function _register_children;
         bool _use_custom_argument_parsing{};
     };
 
+    //! \brief An entry in a static table of subcommands, used with
+    //!        basic_command_manager::add_command_table().
+    //!
+    //! Unlike command_info, this type holds only a name, description and function pointer, so a
+    //! table of them can be a `constexpr` array of string literals that costs nothing at startup.
+    //! Use the create() method to make an entry for a command type.
+    //!
+    //! \tparam CharType The character type used for arguments and other strings.
+    //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use for strings. Defaults to `std::allocator<CharType>`.
+    template<typename CharType, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
+    struct command_table_entry
+    {
+        //! \brief The concrete type of command_info used.
+        using info_type = command_info<CharType, Traits, Alloc>;
+        //! \brief The concrete type of basic_command used.
+        using command_type = typename info_type::command_type;
+        //! \brief The concrete type of basic_parser_builder used.
+        using builder_type = typename info_type::builder_type;
+        //! \brief The concrete string view type used.
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+        //! \brief The type of a function that instantiates a subcommand.
+        using creator = std::unique_ptr<command_type> (*)(builder_type *);
+
+        //! \brief The name of the subcommand.
+        string_view_type name;
+        //! \brief The description of the subcommand.
+        string_view_type description;
+        //! \brief A function that instantiates the subcommand.
+        //!
+        //! For commands that use custom argument parsing, this function is passed `nullptr`.
+        creator create_command;
+        //! \brief Indicates whether this command uses basic_command_with_custom_parsing as a base
+        //!        type.
+        bool use_custom_argument_parsing;
+
+        //! \brief Creates a command_table_entry for the specified command type.
+        //!
+        //! \tparam T The type of the subcommand, which must derive from basic_command.
+        //! \param name The name of the subcommand.
+        //! \param description The description of the subcommand.
+        template<typename T>
+        static constexpr command_table_entry create(string_view_type name, string_view_type description = {}) noexcept
+        {
+            if constexpr (std::is_base_of_v<typename info_type::command_with_custom_parsing_type, T>)
+            {
+                return {name, description, [](builder_type *) -> std::unique_ptr<command_type> { return std::make_unique<T>(); }, true};
+            }
+            else
+            {
+                return {name, description, [](builder_type *builder) -> std::unique_ptr<command_type> { return std::make_unique<T>(*builder); }, false};
+            }
+        }
+
+        //! \brief Creates a command_info instance for this entry.
+        info_type to_info() const
+        {
+            using string_type = typename info_type::string_type;
+            return {string_type{name}, string_type{description}, create_command, use_custom_argument_parsing};
+        }
+    };
+
     namespace details
     {
         template<typename CharType, typename Traits, typename Alloc>
@@ -285,6 +440,11 @@ namespace ookii
         private:
             typename builder_type::version_function _function;
         };
+
+        // Loads the shared library of a plugin command. It's only defined by command_plugin.h, so
+        // the platform's library loader is only needed by applications that use plugin commands.
+        template<typename Command, typename Builder>
+        class plugin_loader;
     }
 
     //! \brief Manages registration, creation and invocation of subcommands for an application.
@@ -295,6 +455,18 @@ namespace ookii
     //! 
     //! You can then invoke create_command() to create an instance of a command type based on the
     //! provided arguments, or run_command() to create a command and immediately run it.
+    //!
+    //! Once all commands are added and the manager is configured, its `const` methods, including
+    //! create_command(), run_command(), get_command(), get_child_manager(), commands() and
+    //! write_usage(), can be called by any number of threads at once. Every call creates its own
+    //! basic_parser_builder and parser, and the state that is created on demand, such as command_info
+    //! instances for a command table and the managers of nested commands, is created without
+    //! taking a lock once it exists. For this to be safe, the function passed to
+    //! configure_parser(), the constructors of the commands, the functions passed to
+    //! add_parent_command(), and the basic_localized_string_provider must not modify shared state
+    //! without synchronization, and a basic_usage_writer instance must not be used by more than one
+    //! thread at a time. Methods that add commands or change the configuration must not be called
+    //! while other threads use the manager.
     //! 
     //! Several typedefs for common character types are provided:
     //! 
@@ -324,6 +496,8 @@ namespace ookii
         using command_with_custom_parsing_type = typename info_type::command_with_custom_parsing_type;
         //! \brief The concrete type of basic_usage_writer used.
         using usage_writer_type = basic_usage_writer<CharType, Traits, Alloc>;
+        //! \brief The concrete type of basic_usage_cache used.
+        using usage_cache_type = basic_usage_cache<CharType, Traits, Alloc>;
         //! \brief The concrete type of output stream used.
         using stream_type = std::basic_ostream<CharType, Traits>;
         //! \brief The type of a function used to configure parser options for every command.
@@ -332,6 +506,25 @@ namespace ookii
         using version_function = std::function<void()>;
         //! \brief The specialized type of basic_localized_string_provider used.
         using string_provider_type = basic_localized_string_provider<CharType, Traits, Alloc>;
+        //! \brief The concrete type of command_table_entry used.
+        using table_entry_type = command_table_entry<CharType, Traits, Alloc>;
+        //! \brief The type of a function that adds the child commands of a parent command.
+        using register_children_function = typename info_type::register_children_function;
+        //! \brief The type of the function exported by the shared library of a plugin command.
+        using plugin_function = command_type *(*)(builder_type &);
+
+        //! \brief The result of the find_command() method.
+        struct found_command
+        {
+            //! \brief The basic_command_manager that contains the command, which is a child
+            //!        manager if the command is nested. If the command was not found, this is the
+            //!        manager whose commands should be listed.
+            const basic_command_manager *manager;
+            //! \brief The command, or `nullptr` if it was not found.
+            const info_type *info;
+            //! \brief The arguments after the names of the command and its parent commands.
+            std::span<const CharType *const> args;
+        };
 
         //! \brief Initializes a new instance of the basic_command_manager class.
         //! 
@@ -348,6 +541,7 @@ namespace ookii
         basic_command_manager(string_type application_name, bool case_sensitive = false, const std::locale &locale = {},
             const string_provider_type *string_provider = nullptr)
             : _commands{string_less{case_sensitive, locale}},
+              _lazy{std::make_unique<lazy_state>(string_less{case_sensitive, locale})},
               _application_name{application_name},
               _locale{locale},
               _string_provider{string_provider},
@@ -365,6 +559,7 @@ namespace ookii
         basic_command_manager &description(string_type description)
         {
             _description = description;
+            _usage_cache->clear();
             return *this;
         }
 
@@ -391,6 +586,7 @@ namespace ookii
         basic_command_manager& common_help_argument(string_type name_with_prefix)
         {
             _common_help_argument = name_with_prefix;
+            _usage_cache->clear();
             return *this;
         }
 
@@ -442,6 +638,156 @@ namespace ookii
             if (!success)
                 throw std::logic_error("Duplicate command name");
 
+            commands_changed();
+            return *this;
+        }
+
+        //! \brief Adds the commands from a static table.
+        //!
+        //! Unlike add_command(), this method doesn't create a command_info for every command, so
+        //! it's suitable for applications with a large number of commands that only ever run one.
+        //! Commands are looked up in the table using a binary search, and a command_info is only
+        //! created for a command when it's looked up by get_command() or create_command(), or when
+        //! all commands are enumerated by commands(), for example to write usage help.
+        //!
+        //! The table must be sorted by name, using the same comparison as the
+        //! basic_command_manager, so when command names are not case sensitive, the table must
+        //! be sorted case insensitively. The table is not copied, so it must remain valid as long
+        //! as the basic_command_manager exists; typically, it's a `static constexpr` array.
+        //!
+        //! If a command in the table has the same name as a command added using add_command(), the
+        //! latter is used.
+        //!
+        //! ```
+        //! static constexpr ookii::command_table_entry<char> commands[] = {
+        //!     ookii::command_table_entry<char>::create<read_command>("read", "Reads a file."),
+        //!     ookii::command_table_entry<char>::create<write_command>("write", "Writes a file."),
+        //! };
+        //!
+        //! ookii::command_manager manager{"my_app"};
+        //! manager.add_command_table(commands);
+        //! ```
+        //!
+        //! \param table The table of commands.
+        //! \return A reference to the basic_command_manager.
+        //! \exception std::invalid_argument The table is not sorted, or contains duplicate names.
+        //! \exception std::logic_error A command table was already added.
+        basic_command_manager &add_command_table(std::span<const table_entry_type> table)
+        {
+            if (!_table.empty())
+                throw std::logic_error("A command table was already added.");
+
+            auto comp = _commands.key_comp();
+            auto it = std::adjacent_find(table.begin(), table.end(), [&comp](const auto &left, const auto &right)
+                {
+                    return !comp(left.name, right.name);
+                });
+
+            if (it != table.end())
+                throw std::invalid_argument("The command table is not sorted, or contains duplicate names.");
+
+            _table = table;
+            _lazy->table_infos = std::vector<std::atomic<info_type *>>(table.size());
+            commands_changed();
+            return *this;
+        }
+
+        //! \brief Adds a parent command, which has child commands instead of arguments.
+        //!
+        //! When a parent command is invoked, the next argument is the name of one of its child
+        //! commands, followed by the arguments for that command. A parent command can have other
+        //! parent commands as children, so commands can be nested to any depth.
+        //!
+        //! The child commands are added to a separate basic_command_manager, which is created the
+        //! first time the parent command is used, by calling the \p register_children function.
+        //! That basic_command_manager is kept for the lifetime of this one, so the function is
+        //! only called once. The child manager uses the same case sensitivity, locale, string
+        //! provider, common help argument and parser configuration function as this one, its
+        //! description is the description of the parent command, and its application name
+        //! includes the name of the parent command, so usage help shows the full command path.
+        //!
+        //! If a parent command is invoked without a child command name, or with an unknown name,
+        //! the list of its child commands is written.
+        //!
+        //! ```
+        //! manager.add_parent_command("course", "Add or remove a course.", [](ookii::command_manager &children)
+        //!     {
+        //!         children
+        //!             .add_command<add_course_command>()
+        //!             .add_command<remove_course_command>();
+        //!     });
+        //! ```
+        //!
+        //! \param name The name used to invoke the command.
+        //! \param description The description of the command, used for usage help.
+        //! \param register_children A function that adds the child commands to the
+        //!        basic_command_manager passed to it.
+        //! \return A reference to the basic_command_manager.
+        basic_command_manager &add_parent_command(string_type name, string_type description, register_children_function register_children)
+        {
+            auto [it, success] = _commands.emplace(name, info_type::create_parent(name, description, std::move(register_children)));
+            if (!success)
+                throw std::logic_error("Duplicate command name");
+
+            _lazy->children.try_emplace(it->first);
+            commands_changed();
+            return *this;
+        }
+
+        //! \brief Adds a command that is created by a function in a shared library, which is only
+        //!        loaded when the command is used.
+        //!
+        //! This allows an application to have commands that are built separately, without linking
+        //! them into the executable. The command's name and description are stored in the
+        //! basic_command_manager, so listing the commands, for example in usage help, does not
+        //! load the library. The library is loaded the first time the command is created, and is
+        //! never unloaded.
+        //!
+        //! The \p symbol must name a function exported by the library, with C linkage, that matches
+        //! plugin_function. It creates the command using `new`, passing the basic_parser_builder
+        //! to the command's constructor. The library must be compiled with the same compiler and
+        //! version of this library as the application. Commands using
+        //! basic_command_with_custom_parsing are not supported.
+        //!
+        //! ```
+        //! // In the shared library.
+        //! extern "C" ookii::command *create_compress_command(ookii::parser_builder &builder)
+        //! {
+        //!     return new compress_command{builder};
+        //! }
+        //!
+        //! // In the application.
+        //! manager.add_plugin_command("compress", "Compresses a file.", "plugins/libcompress.so",
+        //!     "create_compress_command");
+        //! ```
+        //!
+        //! If the library could not be loaded, or doesn't contain the function, create_command()
+        //! writes an error message and returns `nullptr`.
+        //!
+        //! \note This method can only be used if the command_plugin.h header is included, and on
+        //!       platforms where the loader is in a separate library, the application must link
+        //!       to it, for example using the `Ookii.CommandLine::OOKIICL_PLUGIN` CMake target.
+        //!
+        //! \param name The name used to invoke the command.
+        //! \param description The description of the command, used for usage help.
+        //! \param library The path of the shared library. This is passed to the platform's
+        //!        library loading function, so if it doesn't contain a directory, the library is
+        //!        searched for in the platform's usual locations.
+        //! \param symbol The name of the function that creates the command.
+        //! \return A reference to the basic_command_manager.
+        basic_command_manager &add_plugin_command(string_type name, string_type description, std::filesystem::path library, std::string symbol)
+        {
+            auto loader = std::make_shared<details::plugin_loader<command_type, builder_type>>(std::move(library), std::move(symbol));
+            auto creator = [loader](builder_type *builder)
+            {
+                return loader->create(*builder);
+            };
+
+            auto [it, success] = _commands.emplace(name, info_type{name, description, creator});
+            if (!success)
+                throw std::logic_error("Duplicate command name");
+
+            commands_changed();
             return *this;
         }
 
@@ -469,6 +815,7 @@ namespace ookii
             if (!success)
                 throw std::logic_error("Duplicate command name");
 
+            commands_changed();
             return *this;
         }
 
@@ -496,14 +843,18 @@ namespace ookii
 
 
         //! \brief Gets a view of all the commands.
-        auto commands() const noexcept
+        //!
+        //! If a table was added using add_command_table(), this creates a command_info for every
+        //! command in it that wasn't already looked up.
+        auto commands() const
         {
-            return details::range_filter<const info_type &, typename std::map<string_type, info_type, string_less>::const_iterator>{
-                _commands.begin(),
-                _commands.end(),
-                [](const auto &a) -> auto&
+            const auto &listing = get_listing();
+            return details::range_filter<const info_type &, typename std::vector<const info_type *>::const_iterator>{
+                listing.begin(),
+                listing.end(),
+                [](const info_type *info) -> const info_type &
                 {
-                    return a.second;
+                    return *info;
                 },
                 {}
             };
@@ -529,6 +880,16 @@ namespace ookii
             return *_string_provider;
         }
 
+        //! \brief Gets the cache used to store the rendered command list usage help.
+        //!
+        //! The cache is only used by a basic_usage_writer whose basic_usage_writer::use_usage_cache
+        //! field is `true`. It's cleared when a command is added, or when the description or common
+        //! help argument is changed.
+        usage_cache_type &usage_cache() const noexcept
+        {
+            return *_usage_cache;
+        }
+
         //! \brief Gets a value that indicates whether command names are case sensitive.
         //! \return `true` if command names are case sensitive; otherwise, `false`.
         //!
@@ -546,10 +907,84 @@ namespace ookii
         const info_type *get_command(const string_type &name) const
         {
             auto it = _commands.find(name);
-            if (it == _commands.end())
+            if (it != _commands.end())
+                return &it->second;
+
+            auto comp = _commands.key_comp();
+            auto entry = std::lower_bound(_table.begin(), _table.end(), name, [&comp](const auto &entry, const auto &name)
+                {
+                    return comp(entry.name, name);
+                });
+
+            if (entry == _table.end() || comp(name, entry->name))
+                return nullptr;
+
+            return get_table_info(static_cast<size_t>(entry - _table.begin()));
+        }
+
+        //! \brief Gets the basic_command_manager that holds the child commands of a parent
+        //!        command.
+        //!
+        //! The child manager is created, and the parent command's function to add the child
+        //! commands is called, the first time this is called for a command.
+        //!
+        //! \param command The command_info for a command of this basic_command_manager.
+        //! \return The basic_command_manager with the child commands, or `nullptr` if the command
+        //!         is not a parent command.
+        const basic_command_manager *get_child_manager(const info_type &command) const
+        {
+            if (!command.is_parent_command())
+                return nullptr;
+
+            auto it = _lazy->children.find(command.name());
+            if (it == _lazy->children.end())
                 return nullptr;
 
-            return &it->second;
+            auto &slot = it->second;
+            std::call_once(slot.once, [&]()
+                {
+                    string_type full_name = _application_name + static_cast<CharType>(' ') + command.name();
+                    auto child = std::make_unique<basic_command_manager>(full_name, _case_sensitive, _locale, _string_provider);
+                    child->_description = command.description();
+                    child->_common_help_argument = _common_help_argument;
+                    child->_configure_function = _configure_function;
+                    command.register_children(*child);
+                    slot.manager = std::move(child);
+                });
+
+            return slot.manager.get();
+        }
+
+        //! \brief Finds a command, following parent commands to the child command named by the
+        //!        arguments.
+        //!
+        //! If \p name is a parent command, the first argument is the name of the child command,
+        //! and so on for each level of nesting.
+        //!
+        //! \param name The name of the command.
+        //! \param args The arguments after the command name.
+        //! \return A found_command with the command and its manager, and the remaining arguments.
+        //!         Its info field is `nullptr` if a command was not found, or if there are no
+        //!         arguments left to name the child of a parent command.
+        found_command find_command(const string_type &name, std::span<const CharType *const> args) const
+        {
+            found_command result{this, get_command(name), args};
+
+            // Each parent command consumes the next argument as the name of its child.
+            while (result.info != nullptr && result.info->is_parent_command())
+            {
+                result.manager = result.manager->get_child_manager(*result.info);
+                if (result.args.empty())
+                {
+                    result.info = nullptr;
+                    break;
+                }
+
+                result.info = result.manager->get_command(result.args[0]);
+                result.args = result.args.subspan(1);
+            }
+
+            return result;
         }
 
         //! \brief Creates an instance of a command based on the specified arguments.
@@ -610,6 +1045,9 @@ namespace ookii
         //! 
         //! The args span must contain only the arguments for the command; the application name
         //! and command name are assumed to be stripped already.
+        //!
+        //! If the command is a parent command, the first argument is the name of the child command
+        //! to create, and so on for each level of nesting.
         //! 
         //! \param name The name of the command.
         //! \param args A span containing the arguments for the command.
@@ -618,10 +1056,11 @@ namespace ookii
         //! \returns An instance of the subcommand type, or `nullptr` if the an error occurred.
         std::unique_ptr<command_type> create_command(const string_type &name, std::span<const CharType *const> args, usage_writer_type *usage = nullptr) const
         {
-            auto info = get_command(name);
+            auto [manager, info, command_args] = find_command(name, args);
+            args = command_args;
             if (info == nullptr)
             {
-                write_usage(usage);
+                manager->write_usage(usage);
                 return {};
             }
 
@@ -630,13 +1069,20 @@ namespace ookii
             {
                 command = info->create_custom_parsing();
                 auto custom_command = static_cast<command_with_custom_parsing_type*>(command.get());
-                if (!custom_command->parse(args, *this, usage))
+                if (!custom_command->parse(args, *manager, usage))
                     return {};
             }
             else
             {
-                auto builder = create_parser_builder(*info);
+                auto builder = manager->create_parser_builder(*info);
                 command = info->create(builder);
+                if (!command)
+                {
+                    // Only a plugin command whose library couldn't be loaded creates nothing.
+                    write_error(usage, manager->string_provider().unloadable_plugin_command(info->name()));
+                    return {};
+                }
+
                 auto parser = builder.build();
                 if (!parser.parse(args, usage))
                     return {};
@@ -719,6 +1165,276 @@ namespace ookii
             return command->run();
         }
 
+        //! \brief Creates an instance of a command based on the specified arguments, and runs the
+        //!        command asynchronously using an executor.
+        //!
+        //! The command is created, and its arguments parsed, on the calling thread, in the same way
+        //! as create_command(). The returned task then runs basic_command::run_async() on the
+        //! executor once it's started. Commands that only implement basic_command::run() are run
+        //! on the executor as well.
+        //!
+        //! \warning The first argument is assumed to be the application executable name, and is
+        //!          skipped. The second argument must be the command name.
+        //!
+        //! \tparam Executor The type of the executor, which must have an `execute()` method that
+        //!         accepts a function object with no arguments, such as the thread_pool class.
+        //! \param executor The executor used to run the command. It must remain valid until the
+        //!        task finished.
+        //! \param argc The number of arguments.
+        //! \param argv The arguments.
+        //! \param usage A basic_usage_writer instance that will be used to format errors
+        //!        and usage help.
+        //! \returns A task that produces the exit code of the command, or `std::nullopt` if the
+        //!          command could not be created.
+        template<typename Executor>
+        task<std::optional<int>> run_command_async(Executor &executor, int argc, const CharType *const argv[], usage_writer_type *usage = nullptr) const
+        {
+            return run_on(executor, create_command(argc, argv, usage));
+        }
+
+        //! \brief Creates an instance of a command based on the specified arguments, and runs the
+        //!        command asynchronously using an executor.
+        //!
+        //! The command is created, and its arguments parsed, on the calling thread, in the same way
+        //! as create_command(). The returned task then runs basic_command::run_async() on the
+        //! executor once it's started.
+        //!
+        //! \warning The args span must not contain the application name; the first argument must
+        //!          be the command name.
+        //!
+        //! \tparam Executor The type of the executor, which must have an `execute()` method that
+        //!         accepts a function object with no arguments, such as the thread_pool class.
+        //! \param executor The executor used to run the command. It must remain valid until the
+        //!        task finished.
+        //! \param args A span containing the arguments.
+        //! \param usage A basic_usage_writer instance that will be used to format errors
+        //!        and usage help.
+        //! \returns A task that produces the exit code of the command, or `std::nullopt` if the
+        //!          command could not be created.
+        template<typename Executor>
+        task<std::optional<int>> run_command_async(Executor &executor, std::span<const CharType *const> args, usage_writer_type *usage = nullptr) const
+        {
+            return run_on(executor, create_command(args, usage));
+        }
+
+        //! \brief Creates an instance of a command based on the specified arguments, and runs the
+        //!        command asynchronously using an executor.
+        //!
+        //! The command is created, and its arguments parsed, on the calling thread, in the same way
+        //! as create_command(). The returned task then runs basic_command::run_async() on the
+        //! executor once it's started.
+        //!
+        //! \tparam Executor The type of the executor, which must have an `execute()` method that
+        //!         accepts a function object with no arguments, such as the thread_pool class.
+        //! \param executor The executor used to run the command. It must remain valid until the
+        //!        task finished.
+        //! \param name The name of the command.
+        //! \param args A span containing the arguments for the command.
+        //! \param usage A basic_usage_writer instance that will be used to format errors
+        //!        and usage help.
+        //! \returns A task that produces the exit code of the command, or `std::nullopt` if the
+        //!          command could not be created.
+        template<typename Executor>
+        task<std::optional<int>> run_command_async(Executor &executor, const string_type &name, std::span<const CharType *const> args,
+            usage_writer_type *usage = nullptr) const
+        {
+            return run_on(executor, create_command(name, args, usage));
+        }
+
+        //! \brief Runs the commands in a script, using an executor to run them concurrently.
+        //!
+        //! Every line of the script is a command line that starts with a command name, and is split
+        //! into arguments using basic_command_line_tokens::split(). Empty lines, and lines starting
+        //! with a `#` character, are ignored. A line that ends inside quotes, or with a backslash,
+        //! continues on the next line.
+        //!
+        //! All the commands are created, and their arguments parsed, on the calling thread before
+        //! any of them runs. If any line has an error, the error and the line number are written,
+        //! and no commands are run.
+        //!
+        //! By default, the commands run in the order of the script, and each command starts only
+        //! after the previous one finished. A line whose last argument is an unquoted `&` character
+        //! doesn't wait: the next line starts right away, so it runs concurrently with the previous
+        //! one. A line without the `&` waits for itself and all the commands before it to finish.
+        //! A line containing only the word `wait` waits for all the commands before it without
+        //! running a command, so `wait` can't be used as a command name in a script. For example,
+        //! in the following script, the first two commands run concurrently, and the last one runs
+        //! after both of them finished.
+        //!
+        //! ```text
+        //! download file1 &
+        //! download file2 &
+        //! wait
+        //! merge file1 file2
+        //! ```
+        //!
+        //! While the commands run, the standard output and error streams are replaced, so that
+        //! anything a command writes to them is stored in a buffer for that command. The buffers
+        //! are written to the actual streams in the order of the script, as soon as a command and
+        //! all the commands before it have finished. Only output written by the thread that runs
+        //! the command using `std::cout` and `std::cerr` (or `std::wcout` and `std::wcerr`) is
+        //! captured; output written directly to the file descriptors is not.
+        //!
+        //! If a command returns a non-zero exit code and \a fail_fast is `true`, commands that did
+        //! not start yet are skipped, and the output of the commands after the failed one is
+        //! discarded. If a command throws an exception, the remaining commands are skipped in the
+        //! same way, and the exception is rethrown after all running commands finished.
+        //!
+        //! Because the standard streams are replaced, only one script should run at a time.
+        //!
+        //! \tparam Executor The type of the executor, which must have an `execute()` method that
+        //!         accepts a function object with no arguments, such as the thread_pool class.
+        //! \param executor The executor used to run the commands.
+        //! \param script The stream to read the script from.
+        //! \param fail_fast `true` to skip the remaining commands when a command fails; `false` to
+        //!        run all commands.
+        //! \param usage A basic_usage_writer instance that will be used to format errors
+        //!        and usage help.
+        //! \returns The exit code of the first command in the script that returned a non-zero exit
+        //!          code, zero if all commands succeeded, or `std::nullopt` if the script had an
+        //!          error.
+        template<typename Executor>
+        std::optional<int> run_script(Executor &executor, std::basic_istream<CharType, Traits> &script, bool fail_fast = true,
+            usage_writer_type *usage = nullptr) const
+        {
+            auto commands = create_script_commands(script, usage);
+            if (!commands)
+                return {};
+
+            struct script_task
+            {
+                std::basic_stringbuf<CharType, Traits, Alloc> output;
+                std::basic_stringbuf<CharType, Traits, Alloc> error;
+                std::optional<int> exit_code;
+                std::exception_ptr exception;
+                bool done{};
+            };
+
+            using target_type = details::thread_output_target<CharType, Traits>;
+            std::vector<script_task> tasks(commands->size());
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::atomic<bool> cancelled{};
+            int result = 0;
+            std::exception_ptr exception;
+            {
+                auto &output = console_stream<CharType>::cout();
+                auto &error = console_stream<CharType>::cerr();
+                details::thread_redirect_streambuf<CharType, Traits> output_redirect{output, false};
+                details::thread_redirect_streambuf<CharType, Traits> error_redirect{error, true};
+                bool failed = false;
+                for (size_t start = 0; start < tasks.size() && !failed; )
+                {
+                    // Queue every command up to and including the first one that the next line
+                    // has to wait for.
+                    auto end = start;
+                    while (end < tasks.size() && (*commands)[end].concurrent)
+                    {
+                        ++end;
+                    }
+
+                    end = std::min(end + 1, tasks.size());
+                    for (size_t i = start; i < end; ++i)
+                    {
+                        executor.execute([&, i]()
+                        {
+                            auto &task = tasks[i];
+                            if (!cancelled.load(std::memory_order_relaxed))
+                            {
+                                target_type target{&task.output, &task.error};
+                                auto previous = std::exchange(target_type::current, &target);
+                                try
+                                {
+                                    task.exit_code = (*commands)[i].command->run();
+                                }
+                                catch (...)
+                                {
+                                    task.exception = std::current_exception();
+                                }
+
+                                target_type::current = previous;
+                            }
+
+                            std::lock_guard lock{mutex};
+                            task.done = true;
+                            condition.notify_all();
+                        });
+                    }
+
+                    // Every queued task must finish before the streams are restored, even after a
+                    // failure.
+                    for (size_t i = start; i < end; ++i)
+                    {
+                        auto &task = tasks[i];
+                        {
+                            std::unique_lock lock{mutex};
+                            condition.wait(lock, [&task]() { return task.done; });
+                        }
+
+                        if (failed)
+                            continue;
+
+                        auto text = task.output.view();
+                        output.write(text.data(), static_cast<std::streamsize>(text.size())).flush();
+                        text = task.error.view();
+                        error.write(text.data(), static_cast<std::streamsize>(text.size())).flush();
+                        if (task.exception)
+                        {
+                            exception = task.exception;
+                            failed = true;
+                        }
+                        else if (task.exit_code && *task.exit_code != 0 && result == 0)
+                        {
+                            result = *task.exit_code;
+                            failed = fail_fast;
+                        }
+
+                        if (failed)
+                            cancelled = true;
+                    }
+
+                    start = end;
+                }
+            }
+
+            if (exception)
+                std::rethrow_exception(exception);
+
+            return result;
+        }
+
+        //! \brief Runs the commands in a script file, using an executor to run them concurrently.
+        //!
+        //! See run_script(Executor &, std::basic_istream<CharType, Traits> &, bool, usage_writer_type *)
+        //! for more information.
+        //!
+        //! \tparam Executor The type of the executor, which must have an `execute()` method that
+        //!         accepts a function object with no arguments, such as the thread_pool class.
+        //! \param executor The executor used to run the commands.
+        //! \param path The path of the script file.
+        //! \param fail_fast `true` to skip the remaining commands when a command fails; `false` to
+        //!        run all commands.
+        //! \param usage A basic_usage_writer instance that will be used to format errors
+        //!        and usage help.
+        //! \returns The exit code of the first command in the script that returned a non-zero exit
+        //!          code, zero if all commands succeeded, or `std::nullopt` if the script could not
+        //!          be read or had an error.
+        template<typename Executor>
+        std::optional<int> run_script(Executor &executor, const std::filesystem::path &path, bool fail_fast = true,
+            usage_writer_type *usage = nullptr) const
+        {
+            std::basic_ifstream<CharType, Traits> file;
+            file.imbue(_locale);
+            file.open(path);
+            if (!file)
+            {
+                write_error(usage, _string_provider->unreadable_script_file(path.string<CharType, Traits, Alloc>()));
+                return {};
+            }
+
+            return run_script(executor, file, fail_fast, usage);
+        }
+
         //! \brief Writes usage help about the available commands.
         //! \param usage A basic_usage_writer instance that will be used to format the
         //!        usage help.
@@ -795,7 +1511,220 @@ namespace ookii
             }
         };
 
+        // The command is created before this is called, so the arguments don't need to outlive
+        // the task.
+        template<typename Executor>
+        static task<std::optional<int>> run_on(Executor &executor, std::unique_ptr<command_type> command)
+        {
+            if (!command)
+                co_return std::nullopt;
+
+            co_await resume_on(executor);
+            co_return co_await command->run_async();
+        }
+
+        // Creates the commands for every line of a script, or returns std::nullopt if a line has
+        // an error.
+        struct script_command
+        {
+            std::unique_ptr<command_type> command;
+            // Indicates the next line doesn't wait for this command to finish.
+            bool concurrent{};
+        };
+
+        // Checks whether a line ends with an unquoted and unescaped '&' argument.
+        static bool is_concurrent_line(std::basic_string_view<CharType, Traits> line, std::basic_string_view<CharType, Traits> last_argument)
+        {
+            if (last_argument != literal_cast<CharType>("&").data())
+                return false;
+
+            auto end = line.find_last_not_of(literal_cast<CharType>(" \t\r").data());
+            if (end == line.npos || line[end] != '&')
+                return false;
+
+            return end == 0 || line[end - 1] == ' ' || line[end - 1] == '\t';
+        }
+
+        std::optional<std::vector<script_command>> create_script_commands(std::basic_istream<CharType, Traits> &script,
+            usage_writer_type *usage) const
+        {
+            std::vector<script_command> commands;
+            string_type line;
+            string_type command_line;
+            size_t line_number = 0;
+            size_t first_line = 0;
+            while (std::getline(script, line))
+            {
+                ++line_number;
+                if (command_line.empty())
+                {
+                    auto start = line.find_first_not_of(literal_cast<CharType>(" \t\r").data());
+                    if (start == string_type::npos || line[start] == '#')
+                        continue;
+
+                    first_line = line_number;
+                }
+
+                command_line += line;
+                auto tokens = basic_command_line_tokens<CharType, Traits>::split(command_line);
+                if (!tokens)
+                {
+                    // Unterminated quote or trailing backslash, so continue on the next line.
+                    command_line += static_cast<CharType>('\n');
+                    continue;
+                }
+
+                if (tokens->empty())
+                {
+                    command_line.clear();
+                    continue;
+                }
+
+                auto args = tokens->args();
+                if (tokens->size() == 1 && tokens->views()[0] == literal_cast<CharType>("wait").data())
+                {
+                    // Wait for every command before this line.
+                    command_line.clear();
+                    if (!commands.empty())
+                        commands.back().concurrent = false;
+
+                    continue;
+                }
+
+                bool concurrent = is_concurrent_line(command_line, tokens->views().back());
+                command_line.clear();
+                if (concurrent)
+                    args = args.first(args.size() - 1);
+
+                auto command = create_command(args, usage);
+                if (!command)
+                {
+                    write_error(usage, _string_provider->script_line_error(first_line));
+                    return {};
+                }
+
+                commands.push_back({std::move(command), concurrent});
+            }
+
+            if (!command_line.empty())
+            {
+                write_error(usage, _string_provider->unterminated_command_line());
+                write_error(usage, _string_provider->script_line_error(first_line));
+                return {};
+            }
+
+            return commands;
+        }
+
+        static void write_error(usage_writer_type *usage, const string_type &message)
+        {
+            if (usage == nullptr)
+            {
+                usage_writer_type{}.write_error(message);
+            }
+            else
+            {
+                usage->write_error(message);
+            }
+        }
+
+        struct child_slot
+        {
+            std::once_flag once;
+            std::unique_ptr<basic_command_manager> manager;
+        };
+
+        // State that is created on demand by const methods, which may be called by several threads
+        // at once. It's kept in a separate allocation so the manager can still be moved.
+        struct lazy_state
+        {
+            explicit lazy_state(string_less less)
+                : children{less}
+            {
+            }
+
+            ~lazy_state()
+            {
+                for (auto &info : table_infos)
+                {
+                    delete info.load(std::memory_order_relaxed);
+                }
+            }
+
+            // The command_info for each table entry, once it was looked up.
+            std::vector<std::atomic<info_type *>> table_infos;
+            // Child managers of parent commands, which are created when they are first needed.
+            std::map<string_type, child_slot, string_less> children;
+            // All commands sorted by name, including those from the table, used by commands().
+            std::vector<const info_type *> listing;
+            std::atomic<bool> listing_ready{};
+            std::mutex listing_mutex;
+        };
+
+        // Gets the command_info for a table entry, creating it if needed. If two threads do this
+        // at once, both create one but only the first to be stored is kept, so no lock is needed.
+        const info_type *get_table_info(size_t index) const
+        {
+            auto &slot = _lazy->table_infos[index];
+            auto info = slot.load(std::memory_order_acquire);
+            if (info == nullptr)
+            {
+                auto created = std::make_unique<info_type>(_table[index].to_info());
+                if (slot.compare_exchange_strong(info, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                    info = created.release();
+            }
+
+            return info;
+        }
+
+        // Gets every command, sorted by name. Commands added using add_command() take precedence
+        // over table entries with the same name.
+        const std::vector<const info_type *> &get_listing() const
+        {
+            auto &lazy = *_lazy;
+            if (!lazy.listing_ready.load(std::memory_order_acquire))
+            {
+                std::lock_guard lock{lazy.listing_mutex};
+                if (!lazy.listing_ready.load(std::memory_order_relaxed))
+                {
+                    auto comp = _commands.key_comp();
+                    lazy.listing.clear();
+                    lazy.listing.reserve(_commands.size() + _table.size());
+                    auto it = _commands.begin();
+                    for (size_t index = 0; index < _table.size(); ++index)
+                    {
+                        const auto &name = _table[index].name;
+                        for (; it != _commands.end() && comp(it->first, name); ++it)
+                        {
+                            lazy.listing.push_back(&it->second);
+                        }
+
+                        if (it == _commands.end() || comp(name, it->first))
+                            lazy.listing.push_back(get_table_info(index));
+                    }
+
+                    for (; it != _commands.end(); ++it)
+                    {
+                        lazy.listing.push_back(&it->second);
+                    }
+
+                    lazy.listing_ready.store(true, std::memory_order_release);
+                }
+            }
+
+            return lazy.listing;
+        }
+
+        void commands_changed()
+        {
+            _lazy->listing_ready = false;
+            _usage_cache->clear();
+        }
+
+        // Commands from the table are not in this map; they're looked up in the table directly.
         std::map<string_type, info_type, string_less> _commands;
+        std::span<const table_entry_type> _table;
+        std::unique_ptr<lazy_state> _lazy;
         string_type _application_name;
         string_type _description;
         string_type _common_help_argument;
@@ -803,6 +1732,7 @@ namespace ookii
         configure_function _configure_function;
         const string_provider_type *_string_provider;
         bool _case_sensitive;
+        std::unique_ptr<usage_cache_type> _usage_cache{std::make_unique<usage_cache_type>()};
     };
 
     //! \brief Typedef for basic_command_manager using `char` as the character type.
@@ -0,0 +1,333 @@
+//! \file task.h
+//! \brief Provides the ookii::task class and the ookii::resume_on() function, used to run
+//!        commands asynchronously.
+#ifndef OOKII_TASK_H_
+#define OOKII_TASK_H_
+
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace ookii
+{
+    template<typename T>
+    class task;
+
+    namespace details
+    {
+        class task_promise_base
+        {
+        public:
+            struct final_awaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                {
+                    auto &promise = handle.promise();
+                    if (promise._continuation)
+                    {
+                        // The continuation runs on this thread, so it can't be waiting.
+                        promise._done = true;
+                        return promise._continuation;
+                    }
+
+                    // The lock is held while notifying, so the waiting thread can't destroy the
+                    // coroutine until this is done with it.
+                    std::lock_guard lock{promise._mutex};
+                    promise._done = true;
+                    promise._condition.notify_all();
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            final_awaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                _exception = std::current_exception();
+            }
+
+            void set_continuation(std::coroutine_handle<> continuation) noexcept
+            {
+                _continuation = continuation;
+            }
+
+            void wait()
+            {
+                std::unique_lock lock{_mutex};
+                _condition.wait(lock, [this]() { return _done; });
+            }
+
+            void rethrow_if_exception()
+            {
+                if (_exception)
+                    std::rethrow_exception(_exception);
+            }
+
+        private:
+            std::coroutine_handle<> _continuation;
+            std::exception_ptr _exception;
+            std::mutex _mutex;
+            std::condition_variable _condition;
+            bool _done{};
+        };
+
+        template<typename T>
+        class task_promise : public task_promise_base
+        {
+        public:
+            task<T> get_return_object() noexcept;
+
+            template<typename U>
+            void return_value(U &&value)
+            {
+                _value.emplace(std::forward<U>(value));
+            }
+
+            T result()
+            {
+                rethrow_if_exception();
+                return std::move(*_value);
+            }
+
+        private:
+            std::optional<T> _value;
+        };
+
+        template<>
+        class task_promise<void> : public task_promise_base
+        {
+        public:
+            task<void> get_return_object() noexcept;
+
+            void return_void() noexcept
+            {
+            }
+
+            void result()
+            {
+                rethrow_if_exception();
+            }
+        };
+
+        template<typename Executor>
+        class resume_on_awaiter
+        {
+        public:
+            explicit resume_on_awaiter(Executor &executor) noexcept
+                : _executor{executor}
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                _executor.execute([handle]() { handle.resume(); });
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+
+        private:
+            Executor &_executor;
+        };
+    }
+
+    //! \brief A coroutine that produces a value, used to run commands asynchronously.
+    //!
+    //! A task does not run until it is awaited using `co_await`, or until start() or get() is
+    //! called. When awaited, the awaiting coroutine is resumed when the task finishes, on the
+    //! thread that finished it. Use resume_on() to move a coroutine to a different thread.
+    //!
+    //! If the task's coroutine throws an exception, it's rethrown by `co_await` or get().
+    //!
+    //! A task can only be awaited once, and it can't be awaited after start() or get() was called.
+    //! If a task that was started is destroyed before it finished, the destructor waits for it.
+    //!
+    //! \tparam T The type of the value produced by the task, or `void`.
+    template<typename T>
+    class [[nodiscard]] task
+    {
+    public:
+        //! \brief The promise type of the coroutine.
+        using promise_type = details::task_promise<T>;
+
+        //! \brief Initializes a new instance of the task class that has no coroutine.
+        task() = default;
+
+        //! \brief Initializes a new instance of the task class with the specified coroutine.
+        //! \param handle The coroutine handle.
+        explicit task(std::coroutine_handle<promise_type> handle) noexcept
+            : _handle{handle}
+        {
+        }
+
+        task(const task &) = delete;
+        task &operator=(const task &) = delete;
+
+        //! \brief Move constructor.
+        //! \param other The task to move from.
+        task(task &&other) noexcept
+            : _handle{std::exchange(other._handle, {})},
+              _started{std::exchange(other._started, false)}
+        {
+        }
+
+        //! \brief Move assignment operator.
+        //! \param other The task to move from.
+        //! \return A reference to this task.
+        task &operator=(task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                destroy();
+                _handle = std::exchange(other._handle, {});
+                _started = std::exchange(other._started, false);
+            }
+
+            return *this;
+        }
+
+        //! \brief Destroys the coroutine, after waiting for it if it was started.
+        ~task()
+        {
+            destroy();
+        }
+
+        //! \brief Gets a value that indicates whether this task has a coroutine.
+        //! \return `true` if the task has a coroutine; otherwise, `false`.
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(_handle);
+        }
+
+        //! \brief Starts running the task on the current thread, without waiting for it.
+        //!
+        //! The task runs on the current thread until it first suspends, for example when it
+        //! uses resume_on() to move to another thread. Calling start() on a task that was already
+        //! started does nothing.
+        void start()
+        {
+            if (!_handle)
+                throw std::logic_error("The task has no coroutine.");
+
+            if (!_started)
+            {
+                _started = true;
+                _handle.resume();
+            }
+        }
+
+        //! \brief Starts the task if it wasn't started already, and waits for the result.
+        //! \return The value produced by the task.
+        T get()
+        {
+            start();
+            _handle.promise().wait();
+            return _handle.promise().result();
+        }
+
+        //! \brief Gets an awaiter that starts the task and resumes the awaiting coroutine when
+        //!        it finishes.
+        auto operator co_await() && noexcept
+        {
+            struct awaiter
+            {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+                {
+                    handle.promise().set_continuation(continuation);
+                    return handle;
+                }
+
+                T await_resume()
+                {
+                    return handle.promise().result();
+                }
+            };
+
+            _started = true;
+            return awaiter{_handle};
+        }
+
+    private:
+        void destroy() noexcept
+        {
+            if (_handle)
+            {
+                if (_started)
+                    _handle.promise().wait();
+
+                _handle.destroy();
+                _handle = {};
+            }
+        }
+
+        std::coroutine_handle<promise_type> _handle;
+        bool _started{};
+    };
+
+    namespace details
+    {
+        template<typename T>
+        task<T> task_promise<T>::get_return_object() noexcept
+        {
+            return task<T>{std::coroutine_handle<task_promise<T>>::from_promise(*this)};
+        }
+
+        inline task<void> task_promise<void>::get_return_object() noexcept
+        {
+            return task<void>{std::coroutine_handle<task_promise<void>>::from_promise(*this)};
+        }
+    }
+
+    //! \brief Gets an awaitable that resumes the current coroutine using an executor.
+    //!
+    //! The executor can be any type that has an `execute()` method that accepts a function
+    //! object with no arguments, such as the thread_pool class. The executor must remain valid
+    //! until the coroutine was resumed.
+    //!
+    //! \param executor The executor used to resume the coroutine.
+    //! \return An object that can be used with `co_await`.
+    template<typename Executor>
+    auto resume_on(Executor &executor) noexcept
+    {
+        return details::resume_on_awaiter<Executor>{executor};
+    }
+}
+
+#endif
@@ -0,0 +1,202 @@
+//! \file thread_pool.h
+//! \brief Provides the ookii::thread_pool class.
+#ifndef OOKII_THREAD_POOL_H_
+#define OOKII_THREAD_POOL_H_
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ookii
+{
+    //! \brief A fixed-size pool of threads that balances work between threads using work
+    //!        stealing.
+    //!
+    //! Every thread has its own queue. Work queued from outside the pool is distributed over the
+    //! queues in turn, and work queued by a thread of the pool, such as a coroutine that is
+    //! resumed using resume_on(), goes to that thread's own queue, which keeps related work on
+    //! the same thread. A thread runs the work in its own queue in the order it was queued, and
+    //! when its queue is empty, it takes the most recently queued work from another thread's
+    //! queue. As a result, work does not necessarily start in the order it was queued.
+    //!
+    //! Queuing and taking work only locks the queue involved. The number of pending work items is
+    //! tracked using an atomic counter, and a lock shared by the whole pool is only taken when a
+    //! thread has no work and goes to sleep, or when a sleeping thread must be woken up.
+    //!
+    //! This class can be used as the executor for basic_command_manager::run_command_async(),
+    //! basic_command_manager::run_script() and resume_on(), but it can also be used on its own.
+    //!
+    //! When the thread_pool is destroyed, all the work that was already queued is finished before
+    //! the threads exit.
+    class thread_pool
+    {
+    public:
+        //! \brief The type of the work items.
+        using work_type = std::function<void()>;
+
+        //! \brief Initializes a new instance of the thread_pool class.
+        //! \param thread_count The number of threads, or zero to use
+        //!        `std::thread::hardware_concurrency()`.
+        explicit thread_pool(size_t thread_count = 0)
+        {
+            if (thread_count == 0)
+            {
+                thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+
+            _queues.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                _queues.push_back(std::make_unique<work_queue>());
+            }
+
+            _threads.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                _threads.emplace_back([this, i]() { worker(i); });
+            }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        //! \brief Finishes all queued work, and stops the threads.
+        ~thread_pool()
+        {
+            {
+                std::lock_guard lock{_mutex};
+                _stopping = true;
+            }
+
+            _condition.notify_all();
+            for (auto &thread : _threads)
+            {
+                thread.join();
+            }
+        }
+
+        //! \brief Gets the number of threads in the pool.
+        size_t thread_count() const noexcept
+        {
+            return _threads.size();
+        }
+
+        //! \brief Queues work to run on one of the threads.
+        //!
+        //! \param work The function to run. If it throws an exception, `std::terminate()` is
+        //!        called.
+        void execute(work_type work)
+        {
+            auto index = t_current_pool == this
+                ? t_current_index
+                : _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+
+            // The pending count is incremented before the work is queued, so a thread that takes
+            // the work can't decrement it first.
+            _pending.fetch_add(1);
+            {
+                auto &queue = *_queues[index];
+                std::lock_guard lock{queue.mutex};
+                queue.items.push_back(std::move(work));
+            }
+
+            // A thread that is about to sleep increments the sleeping count before it checks the
+            // pending count, so either it sees the new work, or it's seen here. Taking the lock
+            // makes sure it's waiting before it's notified.
+            if (_sleeping.load() != 0)
+            {
+                {
+                    std::lock_guard lock{_mutex};
+                }
+
+                _condition.notify_one();
+            }
+        }
+
+    private:
+        struct work_queue
+        {
+            std::mutex mutex;
+            std::deque<work_type> items;
+        };
+
+        void worker(size_t index) noexcept
+        {
+            t_current_pool = this;
+            t_current_index = index;
+            while (true)
+            {
+                if (auto work = take(index))
+                {
+                    _pending.fetch_sub(1);
+                    work();
+                    continue;
+                }
+
+                // The work was counted but not queued yet.
+                if (_pending.load() != 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock lock{_mutex};
+                _sleeping.fetch_add(1);
+                _condition.wait(lock, [this]() { return _stopping || _pending.load() != 0; });
+                _sleeping.fetch_sub(1);
+                if (_pending.load() == 0)
+                    return;
+            }
+        }
+
+        work_type take(size_t index)
+        {
+            {
+                auto &own = *_queues[index];
+                std::lock_guard lock{own.mutex};
+                if (!own.items.empty())
+                {
+                    auto work = std::move(own.items.front());
+                    own.items.pop_front();
+                    return work;
+                }
+            }
+
+            for (size_t offset = 1; offset < _queues.size(); ++offset)
+            {
+                auto &other = *_queues[(index + offset) % _queues.size()];
+                std::lock_guard lock{other.mutex};
+                if (!other.items.empty())
+                {
+                    auto work = std::move(other.items.back());
+                    other.items.pop_back();
+                    return work;
+                }
+            }
+
+            return {};
+        }
+
+        static inline thread_local thread_pool *t_current_pool{};
+        static inline thread_local size_t t_current_index{};
+
+        std::vector<std::unique_ptr<work_queue>> _queues;
+        std::atomic<size_t> _next_queue{};
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::atomic<size_t> _pending{};
+        std::atomic<size_t> _sleeping{};
+        bool _stopping{};
+        std::vector<std::thread> _threads;
+    };
+}
+
+#endif
@@ -5,6 +5,12 @@
 
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <shared_mutex>
 #include "string_helper.h"
 #include "line_wrapping_stream.h"
 #include "scope_helper.h"
@@ -69,6 +75,306 @@ namespace ookii
         alphabetical_short_name_descending
     };
 
+    //! \brief Identifies an entry in a basic_usage_cache.
+    //!
+    //! Rendered usage help depends on the name of the application or command, the line width of
+    //! the output, whether color is used, which parts of the usage help are written, and the locale
+    //! used to format values such as defaults.
+    //!
+    //! Two typedefs for common character types are provided:
+    //! 
+    //! Type                      | Definition
+    //! ------------------------- | -------------------------------------
+    //! `ookii::usage_cache_key`  | `ookii::basic_usage_cache_key<char>`
+    //! `ookii::wusage_cache_key` | `ookii::basic_usage_cache_key<wchar_t>`
+    //! 
+    //! \tparam CharType The character type used for strings.
+    //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use for strings. Defaults to `std::allocator<CharType>`.
+    template<typename CharType, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
+    struct basic_usage_cache_key
+    {
+        //! \brief The maximum line length of the output stream, or `std::nullopt` if the output
+        //!        stream doesn't use a basic_line_wrapping_streambuf.
+        std::optional<size_t> line_width;
+        //! \brief Indicates whether the usage help contains color virtual terminal sequences.
+        bool use_color{};
+        //! \brief The parts of the usage help that were written.
+        usage_help_request request{};
+        //! \brief The name of the locale used to write the usage help.
+        std::string locale_name;
+        //! \brief The name of the application or command shown in the usage help.
+        //!
+        //! This is basic_command_line_parser::command_name() for a parser, and
+        //! basic_command_manager::application_name() for a command list.
+        std::basic_string<CharType, Traits, Alloc> name;
+
+        //! \brief Compares two basic_usage_cache_key instances.
+        auto operator<=>(const basic_usage_cache_key &) const = default;
+    };
+
+    //! \brief Typedef for basic_usage_cache_key using `char` as the character type.
+    using usage_cache_key = basic_usage_cache_key<char>;
+    //! \brief Typedef for basic_usage_cache_key using `wchar_t` as the character type.
+    using wusage_cache_key = basic_usage_cache_key<wchar_t>;
+
+    //! \brief Stores pre-rendered usage help so it can be written without formatting it again.
+    //!
+    //! Each basic_command_line_parser and basic_command_manager has a cache, which is used by the
+    //! basic_usage_writer if its basic_usage_writer::use_usage_cache field is set to `true`.
+    //!
+    //! The contents of the cache can be saved to a file with save(), and read back on a later run
+    //! with load(). The file is only meaningful for the same version of the application on the
+    //! same platform; it's up to the caller to discard it when the arguments change.
+    //!
+    //! All members of this class can safely be called from multiple threads simultaneously.
+    //!
+    //! Two typedefs for common character types are provided:
+    //! 
+    //! Type                  | Definition
+    //! --------------------- | -------------------------------------
+    //! `ookii::usage_cache`  | `ookii::basic_usage_cache<char>`
+    //! `ookii::wusage_cache` | `ookii::basic_usage_cache<wchar_t>`
+    //! 
+    //! \tparam CharType The character type used for strings.
+    //! \tparam Traits The character traits to use for strings. Defaults to `std::char_traits<CharType>`.
+    //! \tparam Alloc The allocator to use for strings. Defaults to `std::allocator<CharType>`.
+    template<typename CharType, typename Traits = std::char_traits<CharType>, typename Alloc = std::allocator<CharType>>
+    class basic_usage_cache
+    {
+    public:
+        //! \brief The concrete string type used.
+        using string_type = std::basic_string<CharType, Traits, Alloc>;
+        //! \brief The concrete string_view type used.
+        using string_view_type = std::basic_string_view<CharType, Traits>;
+        //! \brief The concrete basic_usage_cache_key type used.
+        using key_type = basic_usage_cache_key<CharType, Traits, Alloc>;
+        //! \brief The type of a cached entry.
+        //!
+        //! The entry keeps the text it refers to alive, unless it was added using store_static().
+        using entry_type = std::shared_ptr<const string_view_type>;
+
+        //! \brief Gets the usage help stored for the specified key.
+        //! \param key The key identifying the usage help.
+        //! \return The rendered usage help, or `nullptr` if it's not in the cache.
+        entry_type find(const key_type &key) const
+        {
+            std::shared_lock lock{_mutex};
+            auto it = _entries.find(key);
+            if (it == _entries.end())
+            {
+                return {};
+            }
+
+            return it->second;
+        }
+
+        //! \brief Adds usage help to the cache.
+        //!
+        //! If the cache already contains an entry for the key, that entry is kept, so that
+        //! concurrent writers end up using the same text.
+        //!
+        //! \param key The key identifying the usage help.
+        //! \param usage The rendered usage help.
+        //! \return The entry stored in the cache for \a key.
+        entry_type store(key_type key, string_type usage)
+        {
+            std::unique_lock lock{_mutex};
+            auto [it, inserted] = _entries.try_emplace(std::move(key), nullptr);
+            if (inserted)
+            {
+                it->second = make_entry(std::move(usage));
+            }
+
+            return it->second;
+        }
+
+        //! \brief Adds usage help to the cache without copying it.
+        //!
+        //! If the cache already contains an entry for the key, that entry is kept.
+        //!
+        //! \param key The key identifying the usage help.
+        //! \param usage The rendered usage help. The cache refers to this text, so it must remain
+        //!        valid for as long as the cache exists; typically, it's a string literal.
+        //! \return The entry stored in the cache for \a key.
+        entry_type store_static(key_type key, string_view_type usage)
+        {
+            std::unique_lock lock{_mutex};
+            auto [it, inserted] = _entries.try_emplace(std::move(key), nullptr);
+            if (inserted)
+            {
+                it->second = std::make_shared<const string_view_type>(usage);
+            }
+
+            return it->second;
+        }
+
+        //! \brief Gets the number of entries in the cache.
+        size_t size() const
+        {
+            std::shared_lock lock{_mutex};
+            return _entries.size();
+        }
+
+        //! \brief Removes all entries from the cache.
+        void clear()
+        {
+            std::unique_lock lock{_mutex};
+            _entries.clear();
+        }
+
+        //! \brief Writes the contents of the cache to a file.
+        //!
+        //! The file uses a binary format specific to the character type and platform.
+        //!
+        //! \param path The path of the file. If it exists, it is overwritten.
+        //! \return `true` if the file was written successfully; otherwise, `false`.
+        bool save(const std::filesystem::path &path) const
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            if (!file)
+            {
+                return false;
+            }
+
+            std::shared_lock lock{_mutex};
+            file.write(c_magic.data(), c_magic.size());
+            write_value(file, static_cast<std::uint32_t>(sizeof(CharType)));
+            write_value(file, static_cast<std::uint64_t>(_entries.size()));
+            for (const auto &[key, usage] : _entries)
+            {
+                write_value(file, key.line_width ? static_cast<std::uint64_t>(*key.line_width) : c_no_line_width);
+                write_value(file, static_cast<std::uint8_t>(key.use_color));
+                write_value(file, static_cast<std::uint8_t>(key.request));
+                write_string(file, std::string_view{key.locale_name});
+                write_string(file, string_view_type{key.name});
+                write_string(file, *usage);
+            }
+
+            return static_cast<bool>(file.flush());
+        }
+
+        //! \brief Adds the contents of a file created by save() to the cache.
+        //!
+        //! Entries read from the file replace any existing entries with the same key. If the file
+        //! is not valid, the cache is not modified.
+        //!
+        //! \param path The path of the file.
+        //! \return `true` if the file was read successfully; otherwise, `false`.
+        bool load(const std::filesystem::path &path)
+        {
+            std::error_code error;
+            auto file_size = std::filesystem::file_size(path, error);
+            if (error)
+            {
+                return false;
+            }
+
+            std::ifstream file{path, std::ios::binary};
+            std::array<char, c_magic.size()> magic{};
+            if (!file.read(magic.data(), magic.size()) || magic != c_magic)
+            {
+                return false;
+            }
+
+            std::uint32_t char_size{};
+            std::uint64_t count{};
+            if (!read_value(file, char_size) || char_size != sizeof(CharType) || !read_value(file, count))
+            {
+                return false;
+            }
+
+            std::map<key_type, entry_type> entries;
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                key_type key;
+                std::uint64_t line_width{};
+                std::uint8_t use_color{};
+                std::uint8_t request{};
+                string_type usage;
+                if (!read_value(file, line_width) || !read_value(file, use_color) || !read_value(file, request) ||
+                    request > static_cast<std::uint8_t>(usage_help_request::none) ||
+                    !read_string(file, key.locale_name, file_size) || !read_string(file, key.name, file_size) ||
+                    !read_string(file, usage, file_size))
+                {
+                    return false;
+                }
+
+                if (line_width != c_no_line_width)
+                {
+                    key.line_width = static_cast<size_t>(line_width);
+                }
+
+                key.use_color = use_color != 0;
+                key.request = static_cast<usage_help_request>(request);
+                entries.insert_or_assign(std::move(key), make_entry(std::move(usage)));
+            }
+
+            std::unique_lock lock{_mutex};
+            entries.merge(_entries);
+            _entries.swap(entries);
+            return true;
+        }
+
+    private:
+        struct owned_entry
+        {
+            string_type text;
+            string_view_type view;
+        };
+
+        static entry_type make_entry(string_type usage)
+        {
+            auto owned = std::make_shared<owned_entry>(std::move(usage));
+            owned->view = owned->text;
+            return {owned, &owned->view};
+        }
+
+        template<typename T>
+        static void write_value(std::ostream &stream, T value)
+        {
+            stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template<typename T>
+        static bool read_value(std::istream &stream, T &value)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(value)));
+        }
+
+        template<typename T, typename StringTraits>
+        static void write_string(std::ostream &stream, std::basic_string_view<T, StringTraits> value)
+        {
+            write_value(stream, static_cast<std::uint64_t>(value.size()));
+            stream.write(reinterpret_cast<const char *>(value.data()), value.size() * sizeof(T));
+        }
+
+        template<typename T, typename StringTraits, typename StringAlloc>
+        static bool read_string(std::istream &stream, std::basic_string<T, StringTraits, StringAlloc> &value, std::uintmax_t max_size)
+        {
+            // Check the size against the file size so a corrupt file can't cause a huge allocation.
+            std::uint64_t size{};
+            if (!read_value(stream, size) || size > max_size / sizeof(T))
+            {
+                return false;
+            }
+
+            value.resize(static_cast<size_t>(size));
+            return static_cast<bool>(stream.read(reinterpret_cast<char *>(value.data()), value.size() * sizeof(T)));
+        }
+
+        static constexpr std::array<char, 8> c_magic{ 'O', 'C', 'L', 'U', 'S', 'A', 'G', 'E' };
+        static constexpr std::uint64_t c_no_line_width = std::numeric_limits<std::uint64_t>::max();
+
+        mutable std::shared_mutex _mutex;
+        std::map<key_type, entry_type> _entries;
+    };
+
+    //! \brief Typedef for basic_usage_cache using `char` as the character type.
+    using usage_cache = basic_usage_cache<char>;
+    //! \brief Typedef for basic_usage_cache using `wchar_t` as the character type.
+    using wusage_cache = basic_usage_cache<wchar_t>;
+
     //! \brief Creates usage help for the basic_command_line_parser and basic_command_manager
     //! classes.
     //!
@@ -132,6 +438,8 @@ namespace ookii
         using command_manager_type = basic_command_manager<CharType, Traits, Alloc>;
         //! \brief The concrete command_info type used.
         using command_info_type = command_info<CharType, Traits, Alloc>;
+        //! \brief The concrete basic_usage_cache type used.
+        using usage_cache_type = basic_usage_cache<CharType, Traits, Alloc>;
 
         //! \brief Initializes a new instance of the basic_usage_writer class.
         //!
@@ -139,8 +447,8 @@ namespace ookii
         //! and the standard input stream.
         //!
         //! \param use_color `true` to enable color output using virtual terminal sequences, `false`
-        //!        to disable it, and `std::nullopt` to automatically enable it if supported using
-        //!        the ookii::vt::enable_color() method.
+        //!        to disable it, and `std::nullopt` to automatically enable it if supported
+        //!        according to the ookii::vt::capability_cache class.
         basic_usage_writer(std::optional<bool> use_color = {})
             : _owned_output{line_wrapping_stream_type::for_cout()},
               _owned_error{line_wrapping_stream_type::for_cerr()},
@@ -150,6 +458,34 @@ namespace ookii
         {
         }
 
+        //! \brief Initializes a new instance of the basic_usage_writer class that writes directly
+        //!        to the specified file descriptors.
+        //!
+        //! This instance will write to a line_wrapping_ostream created using
+        //! basic_line_wrapping_ostream::for_fd(), which collects the output in a large buffer
+        //! and writes it using only a few system calls, rather than going through `std::cout` and
+        //! `std::cerr`. This reduces the cost of writing usage help for applications with many
+        //! arguments, but not the cost of formatting it, which is usually larger. The output is
+        //! written when the usage is complete, or at the latest when this instance is destroyed.
+        //!
+        //! This constructor is only available if \a CharType is `char`.
+        //!
+        //! \param output_fd The file descriptor used for usage help, for example `STDOUT_FILENO`.
+        //! \param error_fd The file descriptor used for errors, for example `STDERR_FILENO`.
+        //! \param use_color `true` to enable color output using virtual terminal sequences, `false`
+        //!        to disable it, and `std::nullopt` to automatically enable it if supported
+        //!        according to the ookii::vt::capability_cache class for the standard output and
+        //!        error streams.
+        basic_usage_writer(int output_fd, int error_fd, std::optional<bool> use_color = {})
+            requires std::is_same_v<CharType, char>
+            : _owned_output{line_wrapping_stream_type::for_fd(output_fd)},
+              _owned_error{line_wrapping_stream_type::for_fd(error_fd)},
+              output{*_owned_output},
+              error{*_owned_error},
+              _use_color{use_color}
+        {
+        }
+
         //! \brief Initializes a new instance of the basic_usage_writer class with the specified stream.
         //!
         //! This instance will write both errors and usage to the same stream.
@@ -271,6 +607,24 @@ namespace ookii
         //! The default value is `true`.
         bool blank_line_after_description{true};
 
+        //! \brief Indicates whether to store rendered usage help in, and reuse it from, the cache of
+        //! the parser or command manager.
+        //!
+        //! If `true`, the write_parser_usage() and write_command_list_usage() methods look for the
+        //! usage help in basic_command_line_parser::usage_cache() or
+        //! basic_command_manager::usage_cache(), using the line width of the output stream, whether
+        //! color is used, the usage_help_request and the locale as the key. If it's found, the
+        //! cached text is written to the output stream in a single operation. Otherwise, the usage
+        //! help is written normally and added to the cache.
+        //!
+        //! The other fields of this class, and any methods a derived class overrides, are not part
+        //! of the key. Only enable this if every basic_usage_writer that writes usage help for the
+        //! same parser or command manager produces the same output. Usage help written with a
+        //! locale that has no name is never cached.
+        //! 
+        //! The default value is `false`.
+        bool use_usage_cache{};
+
         //! \brief The separator to use between names of arguments and commands.
         //! 
         //! The default value is ", ".
@@ -1209,25 +1563,7 @@ namespace ookii
                 return;
             }
 
-            if (argument_description_list_order == description_list_sort_mode::usage_order)
-            {
-                for (const auto &arg : parser().arguments())
-                {
-                    if (check_filter(arg))
-                    {
-                        f(arg);
-                    }
-                }
-
-                return;
-            }
-
-            std::vector<const argument_type *> arguments;
-            arguments.reserve(parser().argument_count());
-            auto source = parser().arguments();
-            std::transform(source.begin(), source.end(), std::back_inserter(arguments), [](const auto &arg) { return &arg; });
-            std::sort(arguments.begin(), arguments.end(), get_sort_function());
-            for (const auto &arg : arguments)
+            for (const auto arg : parser().arguments_in_order(argument_description_list_order))
             {
                 if (check_filter(*arg))
                 {
@@ -1293,40 +1629,6 @@ namespace ookii
             return false;
         }
 
-        std::function<bool(const argument_type *, const argument_type *)> get_sort_function() const
-        {
-            auto comparer = parser().argument_comparer();
-            switch (argument_description_list_order)
-            {
-            case description_list_sort_mode::alphabetical:
-                return [comparer](const argument_type *left, const argument_type *right)
-                {
-                    return comparer(left->name(), right->name());
-                };
-
-            case description_list_sort_mode::alphabetical_descending:
-                return [comparer](const argument_type *left, const argument_type *right)
-                {
-                    return comparer(right->name(), left->name());
-                };
-
-            case description_list_sort_mode::alphabetical_short_name:
-                return [comparer](const argument_type *left, const argument_type *right)
-                {
-                    return comparer(left->short_or_long_name(), right->short_or_long_name());
-                };
-
-            case description_list_sort_mode::alphabetical_short_name_descending:
-                return [comparer](const argument_type *left, const argument_type *right)
-                {
-                    return comparer(right->short_or_long_name(), left->short_or_long_name());
-                };
-
-            default:
-                throw std::logic_error("Invalid sort mode.");
-            }
-        }
-
         void write_usage_internal(const std::locale &loc, usage_help_request request = usage_help_request::full)
         {
             auto old_output_loc = output.imbue(loc);
@@ -1348,8 +1650,21 @@ namespace ookii
                 old_error_loc = error.imbue(loc);
             }
 
-            auto color = enable_color();
+            enable_color();
             output << set_indent(0) << reset_indent;
+            if (use_usage_cache && loc.name() != "*")
+            {
+                auto &cache = _parser != nullptr ? _parser->usage_cache() : _command_manager->usage_cache();
+                write_cached_usage(cache, loc.name(), request);
+            }
+            else
+            {
+                write_usage_core(request);
+            }
+        }
+
+        void write_usage_core(usage_help_request request)
+        {
             if (_parser != nullptr)
             {
                 write_parser_usage_core(request);
@@ -1360,26 +1675,65 @@ namespace ookii
             }
         }
 
-        vt::virtual_terminal_support enable_color()
+        void write_cached_usage(usage_cache_type &cache, std::string locale_name, usage_help_request request)
         {
-            if (!_use_color)
+            auto wrapping_buffer = details::get_line_wrapping_streambuf(output);
+            const auto &name = _parser != nullptr ? _parser->command_name() : _command_manager->application_name();
+            typename usage_cache_type::key_type key{{}, use_color(), request, std::move(locale_name), name};
+            if (wrapping_buffer != nullptr)
+            {
+                key.line_width = wrapping_buffer->max_line_length();
+            }
+
+            auto usage = cache.find(key);
+            if (!usage)
             {
-                auto support = vt::virtual_terminal_support::enable_color(standard_stream::output);
-                _use_color = support.is_supported();
-                return support;
+                usage = cache.store(std::move(key), render_usage(wrapping_buffer, request));
             }
 
-            return {};
+            // The text is already wrapped and indented, so writing it through the output stream's
+            // line wrapping buffer (if there is one) leaves it unchanged.
+            output.write(usage->data(), usage->size()).flush();
         }
 
-        vt::virtual_terminal_support enable_error_color()
+        string_type render_usage(const basic_line_wrapping_streambuf<CharType, Traits> *wrapping_buffer, usage_help_request request)
+        {
+            std::basic_stringbuf<CharType, Traits, Alloc> rendered;
+            std::optional<basic_line_wrapping_streambuf<CharType, Traits>> wrapping;
+            std::basic_streambuf<CharType, Traits> *target = &rendered;
+            if (wrapping_buffer != nullptr)
+            {
+                wrapping.emplace();
+                wrapping->init(&rendered, wrapping_buffer->max_line_length(), wrapping_buffer->count_formatting());
+                wrapping->pubimbue(output.getloc());
+                target = &*wrapping;
+            }
+
+            {
+                auto old_buffer = output.rdbuf(target);
+                details::scope_exit restore{[this, old_buffer]() { output.rdbuf(old_buffer); }};
+                write_usage_core(request);
+                if (wrapping)
+                {
+                    wrapping->sync(true);
+                }
+            }
+
+            return rendered.str();
+        }
+
+        // The capabilities are cached for the process, so these are cheap after the first call.
+        void enable_color()
         {
             if (!_use_color)
             {
-                return vt::virtual_terminal_support::enable_color(standard_stream::error);
+                _use_color = vt::capability_cache::get(standard_stream::output).color;
             }
+        }
 
-            return {};
+        bool enable_error_color()
+        {
+            return !_use_color && vt::capability_cache::get(standard_stream::error).color;
         }
 
         const parser_type *_parser{};
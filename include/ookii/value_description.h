@@ -57,6 +57,27 @@ namespace ookii
         }
     };
 
+    //! \brief Specialization of value_description for string views.
+    //! 
+    //! This template sets the value description of any string view type to "string" instead of
+    //! the template name.
+    //! 
+    //! \tparam CharType The character type to use for the value description.
+    //! \tparam Traits The character traits to use for the value description.
+    //! \tparam Alloc The allocator to use for for the value description.
+    //! \tparam CharType2 The character type to use for the target string view type.
+    //! \tparam Traits2 The character traits to use for the target string view type.
+    template<typename CharType, typename Traits, typename Alloc, typename CharType2, typename Traits2>
+    struct value_description<std::basic_string_view<CharType2, Traits2>, CharType, Traits, Alloc>
+    {
+        //! \copydoc value_description::get()
+        static std::basic_string<CharType, Traits, Alloc> get()
+        {
+            constexpr auto result = literal_cast<CharType>("string");
+            return {result.data()};
+        }
+    };
+
     //! \brief Specialization of value_description for `std::optional<T>`.
     //! 
     //! The value description of `std::optional<T>` is the same as for T.
@@ -8,6 +8,11 @@
 #include "console_helper.h"
 #include "scope_helper.h"
 #include "format_helper.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <locale>
 
@@ -16,12 +21,31 @@ namespace ookii::vt
 {
     namespace details
     {
+        // Checks whether the TERM environment variable allows virtual terminal sequences.
+        inline bool check_term()
+        {
+            auto term = ookii::details::get_environment_variable("TERM");
+
+            // If "TERM=dumb" is set, assume no support.
+            if (term && *term == "dumb")
+            {
+                return false;
+            }
+
+#ifdef _WIN32
+            return true;
+#else
+            // Except on Windows, TERM not set is assumed to mean no support.
+            return term.has_value();
+#endif
+        }
+
         template<typename CharType, typename Traits>
         struct vt_helper
         {
             static constexpr CharType c_escape = '\x1b';
 
-            static CharType *find_csi_end(CharType *begin, CharType *end, const std::locale &loc)
+            static const CharType *find_csi_end(const CharType *begin, const CharType *end, const std::locale &loc)
             {
                 for (auto current = begin; current < end; ++current)
                 {
@@ -35,7 +59,7 @@ namespace ookii::vt
                 return nullptr;
             }
 
-            static CharType *find_osc_end(CharType *begin, CharType *end)
+            static const CharType *find_osc_end(const CharType *begin, const CharType *end)
             {
                 bool has_escape = false;
                 for (auto current = begin; current < end; ++current)
@@ -66,11 +90,13 @@ namespace ookii::vt
                 return nullptr;
             }
 
-            static CharType *find_sequence_end(CharType *begin, CharType *end, const std::locale &loc)
+            static const CharType *find_sequence_end(const CharType *begin, const CharType *end, const std::locale &loc)
             {
+                // An escape character at the end of the range could still be the start of a
+                // longer sequence.
                 if (begin == end)
                 {
-                    return begin;
+                    return nullptr;
                 }
 
                 switch (*begin)
@@ -294,31 +320,10 @@ namespace ookii::vt
                 return {};
             }
 
-            bool has_term = false;
-#ifdef _WIN32
-            char term[10]{};
-            size_t required;
-            // If the buffer is too small, it can't be equal to "dumb", so we don't care.
-            getenv_s(&required, term, "TERM");
-            has_term = required > 0;
-#else
-            auto term = getenv("TERM");
-            has_term = term != nullptr;
-#endif
-
-            // If "TERM=dumb" is set, assume no support.
-            if (has_term && strcmp(term, "dumb") == 0)
-            {
-                return {};
-            }
-
-#ifndef _WIN32
-            // Except on Windows, TERM not set is assumed to mean no support.
-            if (!has_term)
+            if (!details::check_term())
             {
                 return {};
             }
-#endif
 
             return {stream, set_console_vt_support(stream, true)};
         }
@@ -337,15 +342,7 @@ namespace ookii::vt
         //! are supported.
         static virtual_terminal_support enable_color(standard_stream stream)
         {
-            bool has_env;
-#ifdef _WIN32
-            size_t required;
-            getenv_s(&required, nullptr, 0, "NO_COLOR");
-            has_env = required > 0;
-#else
-            has_env = getenv("NO_COLOR") != nullptr;
-#endif
-            if (has_env)
+            if (ookii::details::get_environment_variable("NO_COLOR"))
             {
                 return {stream, vt_result::failed};
             }
@@ -389,8 +386,127 @@ namespace ookii::vt
         {
         }
 
-        standard_stream _stream;
-        vt_result _result;
+        standard_stream _stream{};
+        vt_result _result{vt_result::failed};
+    };
+
+    //! \brief Describes which virtual terminal features can be used with a stream.
+    struct terminal_capabilities
+    {
+        //! \brief Virtual terminal sequences are supported.
+        bool virtual_terminal{};
+        //! \brief Color may be used. This requires virtual terminal support, and that the
+        //!        "NO_COLOR" environment variable does not exist.
+        bool color{};
+        //! \brief 24-bit color is supported, according to the "COLORTERM" environment variable.
+        bool true_color{};
+    };
+
+    //! \brief Determines the virtual terminal capabilities of the standard streams once, and
+    //!        caches them for the whole process.
+    //!
+    //! Unlike virtual_terminal_support::enable_color(), which checks the stream and environment
+    //! every time it's called, this class only does so the first time the capabilities of a
+    //! stream are requested. Afterwards, getting them is a single atomic load. The cached values
+    //! can be replaced using set(), for example to honor a command line option that forces color
+    //! on or off.
+    //!
+    //! The checks are the same as those used by virtual_terminal_support::enable_color(). On
+    //! Windows, virtual terminal support is enabled for the console the first time it's checked,
+    //! and is left enabled for the lifetime of the process.
+    class capability_cache
+    {
+    public:
+        //! \brief Gets the capabilities of the specified stream, determining them if they are not
+        //!        cached.
+        //!
+        //! This function is thread safe. If it's called for the first time from multiple threads
+        //! simultaneously, the capabilities may be determined more than once, but all callers
+        //! get the same result.
+        //!
+        //! \param stream The standard_stream to get the capabilities of.
+        static terminal_capabilities get(standard_stream stream)
+        {
+            auto &state = get_state(stream);
+            auto value = state.load(std::memory_order_acquire);
+            if ((value & c_determined) == 0)
+            {
+                auto probed = encode(probe(stream));
+
+                // Don't overwrite a value that was set or determined by another thread meanwhile.
+                if (state.compare_exchange_strong(value, probed, std::memory_order_acq_rel))
+                {
+                    value = probed;
+                }
+            }
+
+            return decode(value);
+        }
+
+        //! \brief Replaces the cached capabilities of the specified stream.
+        //!
+        //! \param stream The standard_stream to set the capabilities of.
+        //! \param capabilities The capabilities to use.
+        static void set(standard_stream stream, terminal_capabilities capabilities) noexcept
+        {
+            get_state(stream).store(encode(capabilities), std::memory_order_release);
+        }
+
+        //! \brief Discards the cached capabilities of the specified stream, so they will be
+        //!        determined again the next time get() is called.
+        //!
+        //! \param stream The standard_stream to reset.
+        static void reset(standard_stream stream) noexcept
+        {
+            get_state(stream).store(0, std::memory_order_release);
+        }
+
+    private:
+        static terminal_capabilities probe(standard_stream stream)
+        {
+            terminal_capabilities result{};
+            if ((stream != standard_stream::output && stream != standard_stream::error) ||
+                !ookii::details::is_console(stream) || !details::check_term() ||
+                set_console_vt_support(stream, true) == vt_result::failed)
+            {
+                return result;
+            }
+
+            result.virtual_terminal = true;
+            result.color = !ookii::details::get_environment_variable("NO_COLOR");
+            if (result.color)
+            {
+                auto color_term = ookii::details::get_environment_variable("COLORTERM");
+                result.true_color = color_term && (*color_term == "truecolor" || *color_term == "24bit");
+            }
+
+            return result;
+        }
+
+        static std::uint8_t encode(terminal_capabilities capabilities) noexcept
+        {
+            return static_cast<std::uint8_t>(c_determined |
+                (capabilities.virtual_terminal ? c_virtual_terminal : 0) |
+                (capabilities.color ? c_color : 0) |
+                (capabilities.true_color ? c_true_color : 0));
+        }
+
+        static terminal_capabilities decode(std::uint8_t value) noexcept
+        {
+            return {(value & c_virtual_terminal) != 0, (value & c_color) != 0, (value & c_true_color) != 0};
+        }
+
+        static std::atomic<std::uint8_t> &get_state(standard_stream stream) noexcept
+        {
+            return _states[static_cast<int>(stream)];
+        }
+
+        static constexpr std::uint8_t c_virtual_terminal = 0x1;
+        static constexpr std::uint8_t c_color = 0x2;
+        static constexpr std::uint8_t c_true_color = 0x4;
+        static constexpr std::uint8_t c_determined = 0x80;
+
+        static inline std::atomic<std::uint8_t> _states[3]{};
     };
 }
 
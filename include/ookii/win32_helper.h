@@ -28,8 +28,12 @@
 
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <filesystem>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 #include "format_helper.h"
 
@@ -49,6 +53,15 @@ namespace ookii::details
     }
 #endif
 
+    // Windows has no signal for console resizing, so this is not supported; the console width
+    // cache can use polling instead.
+    OOKII_PLATFORM_FUNC(bool set_console_resize_handler([[maybe_unused]] void (*callback)()) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        return false;
+    }
+#endif
+
 #ifdef _UNICODE
     using tstring = std::wstring;
 #else
@@ -142,6 +155,109 @@ namespace ookii::details
     }
 #endif
 
+    OOKII_PLATFORM_FUNC(bool map_file(const std::filesystem::path &path, const char *&data, size_t &size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        data = nullptr;
+        size = 0;
+        auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || static_cast<ULONGLONG>(file_size.QuadPart) > SIZE_MAX)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        // An empty file can't be mapped, but that's not an error.
+        bool result = true;
+        if (file_size.QuadPart > 0)
+        {
+            result = false;
+            auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                // The view stays valid after the handles are closed.
+                auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view != nullptr)
+                {
+                    data = static_cast<const char *>(view);
+                    size = static_cast<size_t>(file_size.QuadPart);
+                    result = true;
+                }
+
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+        return result;
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(void unmap_file(const char *data, [[maybe_unused]] size_t size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        if (data != nullptr)
+        {
+            UnmapViewOfFile(data);
+        }
+    }
+#endif
+
+    // Watching for file changes is not implemented on Windows; basic_reloadable_options falls
+    // back to polling the file's modification time instead.
+    OOKII_PLATFORM_FUNC(int start_file_watch([[maybe_unused]] const std::filesystem::path &directory) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        return -1;
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(bool wait_for_file_change([[maybe_unused]] int watch, [[maybe_unused]] const std::filesystem::path &file_name,
+        [[maybe_unused]] int timeout_ms) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        return false;
+    }
+#endif
+
+    OOKII_PLATFORM_FUNC(void stop_file_watch([[maybe_unused]] int watch) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+    }
+#endif
+
+
+    OOKII_PLATFORM_FUNC(bool write_fd(int fd, const char *first, size_t first_size, const char *second, size_t second_size) noexcept)
+#ifdef OOKII_PLATFORM_FUNC_HAS_BODY
+    {
+        for (auto [data, size] : {std::pair{first, first_size}, std::pair{second, second_size}})
+        {
+            while (size > 0)
+            {
+                auto chunk = static_cast<unsigned int>(std::min<size_t>(size, INT_MAX));
+                auto written = _write(fd, data, chunk);
+                if (written < 0)
+                {
+                    return false;
+                }
+
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+
+        return true;
+    }
+#endif
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -3,7 +3,6 @@
 
 #pragma once
 
-#include "parent_command.h"
 #include "base_command.h"
 
 // Command to add courses. Since it inherits from base_command, it has a Path argument in addition
@@ -103,29 +102,14 @@ private:
     int _id;
 };
 
-// This is the top-level "course" command. It derives from parent_command so all it has to do is
-// register its children.
-// Because this is a command with custom parsing, it doesn't use code generation, and therefore has
-// no [command] attribute.
-class course_command : public parent_command<course_command>
+// Adds the child commands of the top-level "course" command. This is passed to
+// command_manager::add_parent_command() in main.cpp, which calls it the first time the "course"
+// command is used.
+inline void register_course_commands(ookii::command_manager &manager)
 {
-public:
-    virtual void register_children(ookii::command_manager &manager) override
-    {
-        manager
-            .add_command<add_course_command>()
-            .add_command<remove_course_command>();
-    }
-
-    static std::string name()
-    {
-        return "course";
-    }
-
-    static std::string description()
-    {
-        return "Add or remove a course.";
-    }
-};
+    manager
+        .add_command<add_course_command>()
+        .add_command<remove_course_command>();
+}
 
 #endif
\ No newline at end of file
@@ -4,16 +4,16 @@
 #include "list_command.h"
 
 // Although this sample uses the code New-Subcommand.ps1 script, we can't generate a main() function,
-// because we want to add the non-generated parent commands.
+// because we want to add the parent commands, which don't use code generation.
 int main(int argc, char *argv[])
 {
     // This will set the options from the [global] block, and only register the list command.
     auto manager = ookii::register_commands(ookii::command_line_parser::get_executable_name(argc, argv));
 
-    // Add non-generated top-level commands.
+    // Add the top-level parent commands. Their children are only registered when they are used.
     manager
-        .add_command<course_command>()
-        .add_command<student_command>();
+        .add_parent_command("course", "Add or remove a course.", register_course_commands)
+        .add_parent_command("student", "Add or remove a student.", register_student_commands);
 
     return manager.run_command(argc, argv).value_or(1);
 }
@@ -3,7 +3,6 @@
 
 #pragma once
 
-#include "parent_command.h"
 #include "base_command.h"
 
 // Command to add students. Since it inherits from base_command, it has a Path argument in addition
@@ -178,30 +177,15 @@ private:
     float _grade;
 };
 
-// This is the top-level "student" command. It derives from parent_command so all it has to do is
-// register its children.
-// Because this is a command with custom parsing, it doesn't use code generation, and therefore has
-// no [command] attribute.
-class student_command : public parent_command<student_command>
+// Adds the child commands of the top-level "student" command. This is passed to
+// command_manager::add_parent_command() in main.cpp, which calls it the first time the "student"
+// command is used.
+inline void register_student_commands(ookii::command_manager &manager)
 {
-public:
-    virtual void register_children(ookii::command_manager &manager) override
-    {
-        manager
-            .add_command<add_student_command>()
-            .add_command<remove_student_command>()
-            .add_command<add_student_course_command>();
-    }
-
-    static std::string name()
-    {
-        return "student";
-    }
-
-    static std::string description()
-    {
-        return "Add or remove a student.";
-    }
-};
+    manager
+        .add_command<add_student_command>()
+        .add_command<remove_student_command>()
+        .add_command<add_student_course_command>();
+}
 
 #endif
\ No newline at end of file
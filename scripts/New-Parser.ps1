@@ -73,7 +73,22 @@ param(
     # that the provided values are used as is, so the path must be relative to the generated output
     # or the file must be on the include path. Usually, it's easier to include required headers
     # from the header passed to -Path or -LiteralPath.
-    [Parameter()][string[]]$AdditionalHeaders = @()
+    [Parameter()][string[]]$AdditionalHeaders = @(),
+    # Specifies the path to a file created by the ookii::basic_usage_cache::save() method. The
+    # usage help in this file is embedded in the generated code as string literals, and added to
+    # the usage cache of the parser, so usage help can be written without formatting it at
+    # runtime when the name, line width, color setting and locale match. The file must be created
+    # by a build of the application using the same arguments and character type; embedded usage
+    # help is not updated when the arguments change. Can only be used if there is a single
+    # arguments type.
+    [Parameter()][string]$UsageCachePath,
+    # Also generates a parse_direct() method for each arguments type, which parses the arguments
+    # without creating a parser, using a generated switch to look up argument names and code that
+    # converts values directly into the fields. The generated parse() method uses it first, and
+    # only creates a parser if it fails, for example to report an error or show usage help. Types
+    # must use the OOKII_GENERATED_DIRECT_METHODS macro to declare the method. Types that use
+    # long/short mode or action arguments get a parse_direct() method that always returns false.
+    [Parameter()][switch]$DirectParse
 )
 begin {
     . (Join-Path $PSScriptRoot common.ps1)
@@ -88,6 +103,9 @@ begin {
     }
 
     $headers += "#include <ookii/command_line.h>"
+    if ($DirectParse) {
+        $headers += "#include <ookii/command_line_generated.h>"
+    }
 
     $context = [CodeGenContext]::new();
     if ($WideChar) {
@@ -101,6 +119,10 @@ begin {
     }
 
     $context.NameTransform = $NameTransform
+    if ($UsageCachePath) {
+        $context.PrerenderedUsage = Read-UsageCache $UsageCachePath $context
+    }
+
     $context.TypeAttribute = "arguments"
     
     $infoCount = 0
@@ -126,6 +148,9 @@ process {
             $info.GenerateParser($context)
             $context.Writer.WriteLine("}")
             $context.Writer.WriteLine()
+            if ($DirectParse) {
+                $info.GenerateDirectParser($context)
+            }
         }
     }
 }
@@ -134,6 +159,10 @@ end {
         throw "No arguments types found."
     }
 
+    if ($UsageCachePath -and $infoCount -gt 1) {
+        throw "Can't use a usage cache file with more than one arguments type."
+    }
+
     if ($EntryPoint) {
         if ($infoCount -gt 1) {
             throw "Can't generate entry point with more than one arguments type."
@@ -66,6 +66,12 @@ param(
     # on the command line parameters. When using this option, there is no need to provide any 
     # entry point manually.
     [Parameter()][switch]$GenerateMain,
+    # Generates a static table of commands, sorted by name, that is passed to
+    # basic_command_manager::add_command_table(), instead of calling add_command() for every
+    # command. Commands are then found using a binary search, and nothing is created for a command
+    # until it's used, so startup cost doesn't depend on the number of commands. With this option,
+    # commands that don't have an explicit name use their type name.
+    [Parameter()][switch]$CommandTable,
     # Supplies additional header files that should be included in the generated result file before
     # any other header files. Use this to include, for example, a precompiled header file. Note
     # that the provided values are used as is, so the path must be relative to the generated output
@@ -146,6 +152,31 @@ end {
         $case = "true"
     }
 
+    $registered = @($commands | Where-Object { $_.Register })
+    if ($CommandTable -and $registered.Length -gt 0) {
+        # The table must be sorted using the same comparison as the command manager.
+        $comparer = if ($global.CaseSensitive) {
+            [System.StringComparer]::Ordinal
+        } else {
+            [System.StringComparer]::OrdinalIgnoreCase
+        }
+
+        [string[]]$names = $registered | ForEach-Object { $_.GetTableName() }
+        [System.Array]::Sort($names, $registered, $comparer)
+        $context.Writer.WriteLine("namespace")
+        $context.Writer.WriteLine("{")
+        $context.Writer.WriteLine("    using command_entry = ::ookii::command_table_entry<$($context.CharType)>;")
+        $context.Writer.WriteLine()
+        $context.Writer.WriteLine("    constexpr command_entry c_commands[] = {")
+        $registered | ForEach-Object {
+            $_.GenerateTableEntry($context)
+        }
+
+        $context.Writer.WriteLine("    };")
+        $context.Writer.WriteLine("}")
+        $context.Writer.WriteLine()
+    }
+
     $context.Writer.WriteLine("ookii::basic_command_manager<$($context.CharType)> ookii::register_commands(std::basic_string<$($context.CharType)> application_name, ::ookii::basic_localized_string_provider<$($context.CharType)> *string_provider, const std::locale& locale)")
     $context.Writer.WriteLine("{")
     $context.Writer.WriteLine("    basic_command_manager<$($context.CharType)> manager{application_name, $case, locale, string_provider};")
@@ -154,9 +185,13 @@ end {
         $global.GenerateGlobal($context)
     }
 
-    $commands | ForEach-Object {
-        if ($_.Register) { 
-            $_.GenerateRegistration($context) 
+    if ($CommandTable) {
+        if ($registered.Length -gt 0) {
+            $context.Writer.WriteLine("        .add_command_table(c_commands)")
+        }
+    } else {
+        $registered | ForEach-Object {
+            $_.GenerateRegistration($context)
         }
     }
     
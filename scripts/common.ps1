@@ -35,6 +35,15 @@ enum UsageHelpRequest {
     None
 }
 
+class UsageCacheEntry {
+    [Nullable[uint64]] $LineWidth
+    [bool] $UseColor
+    [string] $Request
+    [string] $LocaleName
+    [string] $Name
+    [string] $Usage
+}
+
 class CodeGenContext {
     [string] $CharType
     [string] $FieldPrefix
@@ -44,6 +53,7 @@ class CodeGenContext {
     [string] $ExtraIndent
     [NameTransformMode] $NameTransform
     [System.IO.TextWriter] $Writer
+    [UsageCacheEntry[]] $PrerenderedUsage
 }
 
 class AttributeInfo {
@@ -365,9 +375,189 @@ class CommandInfo {
         $this.GenerateArguments($Context)
         $Context.Writer.WriteLine("    ;")
         $Context.Writer.WriteLine("")
+        $this.GeneratePrerenderedUsage($Context)
         $Context.Writer.WriteLine("    return builder;")
     }
 
+    [bool] CanParseDirect() {
+        if ($this.ParsingMode -eq [ParsingMode]::LongShort) {
+            return $false
+        }
+
+        foreach ($arg in $this.Arguments) {
+            if ($arg.Kind -eq [ArgumentKind]::Action -or -not $arg.HasLongName) {
+                return $false
+            }
+        }
+
+        return $true
+    }
+
+    [void] GenerateDirectParser([CodeGenContext]$Context) {
+        $char = $Context.CharType
+        $prefix = $Context.StringPrefix
+        $Context.Writer.WriteLine("bool $($this.TypeName)::parse_direct(std::span<const $char *const> args, const std::locale &locale)")
+        $Context.Writer.WriteLine("{")
+        if (-not $this.CanParseDirect()) {
+            $Context.Writer.WriteLine("    // Long/short mode and action arguments are not supported, so the arguments are always")
+            $Context.Writer.WriteLine("    // parsed using create_builder().")
+            $Context.Writer.WriteLine("    return false;")
+            $Context.Writer.WriteLine("}")
+            $Context.Writer.WriteLine()
+            return
+        }
+
+        $Context.Writer.WriteLine("    enum class argument_id : size_t")
+        $Context.Writer.WriteLine("    {")
+        foreach ($arg in $this.Arguments) {
+            $Context.Writer.WriteLine("        $($arg.MemberName),")
+        }
+
+        $Context.Writer.WriteLine("    };")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("    using argument_info = ookii::details::direct_argument;")
+        $Context.Writer.WriteLine("    static constexpr argument_info arguments[] = {")
+        foreach ($arg in $this.Arguments) {
+            $flags = @()
+            if ($arg.Required) { $flags += "argument_info::required" }
+            if ($arg.Positional) { $flags += "argument_info::positional" }
+            if ($arg.CancelParsing) { $flags += "argument_info::cancel_parsing" }
+            if ($arg.DefaultValue) { $flags += "argument_info::has_default" }
+            if ($flags.Length -eq 0) { $flags += "argument_info::none" }
+            $create = if ($arg.Kind -eq [ArgumentKind]::MultiValue) { "create_multi_value" } else { "create" }
+            $Context.Writer.WriteLine("        argument_info::$create<decltype($($this.TypeName)::$($arg.MemberName))>($($flags -join " | ")),")
+        }
+
+        $Context.Writer.WriteLine("    };")
+        $Context.Writer.WriteLine()
+        $positional = @($this.Arguments | Where-Object { $_.Positional } | ForEach-Object { "argument_id::$($_.MemberName)" })
+        if ($positional.Length -gt 0) {
+            $Context.Writer.WriteLine("    static constexpr std::array<argument_id, $($positional.Length)> positional{ $($positional -join ", ") };")
+        } else {
+            $Context.Writer.WriteLine("    static constexpr std::array<argument_id, 0> positional{};")
+        }
+
+        if ($this.Prefixes.Length -gt 0) {
+            # The direct parser expects the longest prefix first, like basic_command_line_parser.
+            $sorted = $this.Prefixes | Sort-Object -Property Length -Descending -Stable | ForEach-Object { "$prefix`"$_`"" }
+            $Context.Writer.WriteLine("    static constexpr std::basic_string_view<$char> prefixes[] = { $($sorted -join ", ") };")
+            $prefixes = "prefixes"
+        } else {
+            $prefixes = "ookii::details::direct_default_prefixes<$char>()"
+        }
+
+        $Context.Writer.WriteLine("    ookii::details::direct_parser<$char, argument_id, std::size(arguments)> parser{arguments, positional, $prefixes, locale};")
+        if ($this.CaseSensitive) {
+            $Context.Writer.WriteLine("    parser.case_sensitive = true;")
+        }
+
+        if (-not $this.AllowWhiteSpaceSeparator) {
+            $Context.Writer.WriteLine("    parser.allow_white_space_separator = false;")
+        }
+
+        if ($this.AllowDuplicateArguments) {
+            $Context.Writer.WriteLine("    parser.allow_duplicate_arguments = true;")
+        }
+
+        if ($this.Separator) {
+            $Context.Writer.WriteLine("    parser.argument_value_separator = $prefix'$($this.Separator)';")
+        }
+
+        # The parser clears multi-value arguments before parsing.
+        foreach ($arg in $this.Arguments) {
+            if ($arg.Kind -eq [ArgumentKind]::MultiValue) {
+                $Context.Writer.WriteLine("    this->$($arg.MemberName).clear();")
+            }
+        }
+
+        $Context.Writer.WriteLine("    auto find = [&parser](std::basic_string_view<$char> name) -> std::optional<argument_id>")
+        $Context.Writer.WriteLine("    {")
+        $Context.Writer.WriteLine("        switch (name.size())")
+        $Context.Writer.WriteLine("        {")
+        $names = foreach ($arg in $this.Arguments) {
+            foreach ($name in (@($arg.Name) + $arg.Aliases)) {
+                if ($name) {
+                    [PSCustomObject]@{ Name = $name; Member = $arg.MemberName }
+                }
+            }
+        }
+
+        foreach ($group in ($names | Group-Object -Property { $_.Name.Length } | Sort-Object -Property { [int]$_.Name })) {
+            $Context.Writer.WriteLine("        case $($group.Name):")
+            foreach ($entry in $group.Group) {
+                $Context.Writer.WriteLine("            if (parser.name_equals(name, $prefix`"$($entry.Name)`"))")
+                $Context.Writer.WriteLine("                return argument_id::$($entry.Member);")
+            }
+
+            $Context.Writer.WriteLine("            break;")
+        }
+
+        $Context.Writer.WriteLine("        }")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("        return {};")
+        $Context.Writer.WriteLine("    };")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("    auto set = [this, &locale](argument_id id, std::optional<std::basic_string_view<$char>> value)")
+        $Context.Writer.WriteLine("    {")
+        $Context.Writer.WriteLine("        switch (id)")
+        $Context.Writer.WriteLine("        {")
+        foreach ($arg in $this.Arguments) {
+            $function = if ($arg.Kind -eq [ArgumentKind]::MultiValue) { "direct_add_value" } else { "direct_set_value" }
+            $Context.Writer.WriteLine("        case argument_id::$($arg.MemberName):")
+            $Context.Writer.WriteLine("            return ookii::details::$function(this->$($arg.MemberName), value, locale);")
+        }
+
+        $Context.Writer.WriteLine("        }")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("        return false;")
+        $Context.Writer.WriteLine("    };")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("    auto set_default = [this](argument_id id)")
+        $Context.Writer.WriteLine("    {")
+        $Context.Writer.WriteLine("        switch (id)")
+        $Context.Writer.WriteLine("        {")
+        foreach ($arg in $this.Arguments) {
+            if ($arg.DefaultValue) {
+                $Context.Writer.WriteLine("        case argument_id::$($arg.MemberName):")
+                if ($arg.Kind -eq [ArgumentKind]::MultiValue) {
+                    $Context.Writer.WriteLine("            this->$($arg.MemberName).push_back($($arg.DefaultValue));")
+                } else {
+                    $Context.Writer.WriteLine("            this->$($arg.MemberName) = $($arg.DefaultValue);")
+                }
+
+                $Context.Writer.WriteLine("            break;")
+            }
+        }
+
+        $Context.Writer.WriteLine("        default:")
+        $Context.Writer.WriteLine("            break;")
+        $Context.Writer.WriteLine("        }")
+        $Context.Writer.WriteLine("    };")
+        $Context.Writer.WriteLine()
+        $Context.Writer.WriteLine("    return parser.parse(args, find, set, set_default);")
+        $Context.Writer.WriteLine("}")
+        $Context.Writer.WriteLine()
+    }
+
+    [void] GeneratePrerenderedUsage([CodeGenContext]$Context) {
+        $index = 0
+        foreach ($entry in $Context.PrerenderedUsage) {
+            $Context.Writer.WriteLine("    static constexpr std::basic_string_view<$($Context.CharType)> usage$index{")
+            foreach ($line in (ConvertTo-StringLiteral $entry.Usage $Context.StringPrefix)) {
+                $Context.Writer.WriteLine("        $line")
+            }
+
+            $Context.Writer.WriteLine("    };")
+            $lineWidth = if ($null -ne $entry.LineWidth) { $entry.LineWidth } else { "std::nullopt" }
+            $color = if ($entry.UseColor) { "true" } else { "false" }
+            $locale = ConvertTo-StringLiteral $entry.LocaleName ""
+            $name = ConvertTo-StringLiteral $entry.Name $Context.StringPrefix
+            $Context.Writer.WriteLine("    builder.prerendered_usage({ $lineWidth, $color, ookii::usage_help_request::$($entry.Request), $locale, $name }, usage$index);")
+            $Context.Writer.WriteLine("")
+            $index += 1
+        }
+    }
+
     [void] GenerateParserAttributes([CodeGenContext]$Context) {
         switch ($this.ParsingMode) {
             DefaultMode {
@@ -496,6 +686,23 @@ class CommandInfo {
         $Context.Writer.WriteLine("        .add_command<$($this.TypeName)>($name, $commandDescription)")
     }
 
+    [string] GetTableName() {
+        if ($this.CommandName) {
+            return $this.CommandName
+        }
+
+        return $this.TypeName
+    }
+
+    [void] GenerateTableEntry([CodeGenContext]$Context) {
+        $arguments = "$($Context.StringPrefix)`"$($this.GetTableName())`""
+        if ($this.Description) {
+            $arguments += ", $($Context.StringPrefix)`"$($this.Description)`""
+        }
+
+        $Context.Writer.WriteLine("        command_entry::create<$($this.TypeName)>($arguments),")
+    }
+
     [void] GenerateGlobal([CodeGenContext]$Context) {
         if ($this.Description) {
             $Context.Writer.WriteLine("        .description($($Context.StringPrefix)`"$($this.Description)`")")
@@ -846,3 +1053,94 @@ function ConvertTo-SnakeOrDashCase([string]$Name, [char]$separator) {
         $first = $false
     }))
 }
+
+# Read the entries from a file created by basic_usage_cache::save().
+function Read-UsageCache([string]$Path, [CodeGenContext]$Context) {
+    $stream = [System.IO.File]::OpenRead((Convert-Path -LiteralPath $Path))
+    $reader = [System.IO.BinaryReader]::new($stream)
+    try {
+        $magic = [System.Text.Encoding]::ASCII.GetString($reader.ReadBytes(8))
+        if ($magic -ne "OCLUSAGE") {
+            throw "The file $Path is not a usage cache file."
+        }
+
+        $charSize = $reader.ReadUInt32()
+        $encoding = switch ($charSize) {
+            1 { [System.Text.Encoding]::UTF8 }
+            2 { [System.Text.Encoding]::Unicode }
+            4 { [System.Text.Encoding]::UTF32 }
+            default { throw "Unsupported character size $charSize in usage cache file $Path." }
+        }
+
+        if (($charSize -eq 1) -ne ($Context.CharType -eq "char")) {
+            throw "The usage cache file $Path does not use the character type $($Context.CharType)."
+        }
+
+        $count = $reader.ReadUInt64()
+        for ($i = 0; $i -lt $count; $i += 1) {
+            $entry = [UsageCacheEntry]::new()
+            $lineWidth = $reader.ReadUInt64()
+            if ($lineWidth -ne [uint64]::MaxValue) {
+                $entry.LineWidth = $lineWidth
+            }
+
+            $entry.UseColor = $reader.ReadByte() -ne 0
+            $entry.Request = switch ($reader.ReadByte()) {
+                0 { "full" }
+                1 { "syntax_only" }
+                2 { "none" }
+                default { throw "Invalid usage help request in usage cache file $Path." }
+            }
+
+            $length = [int]$reader.ReadUInt64()
+            $entry.LocaleName = [System.Text.Encoding]::UTF8.GetString($reader.ReadBytes($length))
+            $length = [int]$reader.ReadUInt64()
+            $entry.Name = $encoding.GetString($reader.ReadBytes($length * $charSize))
+            $length = [int]$reader.ReadUInt64()
+            $entry.Usage = $encoding.GetString($reader.ReadBytes($length * $charSize))
+            $entry
+        }
+    } finally {
+        $reader.Dispose()
+    }
+}
+
+# Convert a string to one or more C++ string literals, one for each line. Anything other than
+# printable ASCII is escaped, so the result doesn't depend on the source character set.
+function ConvertTo-StringLiteral([string]$Value, [string]$Prefix) {
+    $builder = [System.Text.StringBuilder]::new()
+    $wide = $Prefix -eq "L"
+    if ($wide) {
+        $codePoints = for ($i = 0; $i -lt $Value.Length; $i += 1) {
+            if ([char]::IsHighSurrogate($Value[$i]) -and $i + 1 -lt $Value.Length) {
+                [char]::ConvertToUtf32($Value[$i], $Value[$i + 1])
+                $i += 1
+            } else {
+                [int]$Value[$i]
+            }
+        }
+    } else {
+        $codePoints = [System.Text.Encoding]::UTF8.GetBytes($Value) | ForEach-Object { [int]$_ }
+    }
+
+    foreach ($codePoint in $codePoints) {
+        switch ($codePoint) {
+            0x5c { [void]$builder.Append("\\"); break }
+            0x22 { [void]$builder.Append("\`""); break }
+            0x0a {
+                [void]$builder.Append("\n")
+                "$Prefix`"$($builder.ToString())`""
+                [void]$builder.Clear()
+                break
+            }
+            { $_ -ge 0x20 -and $_ -lt 0x7f } { [void]$builder.Append([char]$codePoint); break }
+            { $_ -lt 0x80 -or -not $wide } { [void]$builder.Append("\" + [Convert]::ToString($codePoint, 8).PadLeft(3, "0")); break }
+            { $_ -le 0xffff } { [void]$builder.Append("\u{0:X4}" -f $codePoint); break }
+            default { [void]$builder.Append("\U{0:X8}" -f $codePoint) }
+        }
+    }
+
+    if ($builder.Length -gt 0 -or $codePoints.Count -eq 0) {
+        "$Prefix`"$($builder.ToString())`""
+    }
+}
@@ -59,6 +59,16 @@ Describe "New-Parser" {
         &$scriptPath (Join-Path $inputPath "auto_arguments.h") -OutputPath $output
         Compare-Files $output "parser_auto_arguments.cpp"
     }
+    It "Generates a direct parser" {
+        $output = Join-Path $outputPath "parser_direct.cpp"
+        &$scriptPath (Join-Path $inputPath "direct_arguments.h") -OutputPath $output -DirectParse
+        Compare-Files $output "parser_direct.cpp"
+    }
+    It "Embeds pre-rendered usage help" {
+        $output = Join-Path $outputPath "parser_usage_cache.cpp"
+        &$scriptPath $input1 -OutputPath $output -UsageCachePath (Join-Path $inputPath "usage_cache.bin")
+        Compare-Files $output "parser_usage_cache.cpp"
+    }
     It "Can use additional headers" {
         $output = Join-Path $outputPath "parser_headers.cpp"
         &$scriptPath $inputs -OutputPath $output -NameTransform PascalCase -AdditionalHeaders "foo.h","bar.h"
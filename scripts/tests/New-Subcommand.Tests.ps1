@@ -39,6 +39,11 @@ Describe "New-Parser" {
         &$scriptPath $inputs -OutputPath $output -NameTransform PascalCase -GenerateMain -WideChar
         Compare-Files $output "sc_wmain.cpp"
     }
+    It "Generates a command table" {
+        $output = Join-Path $outputPath "sc_table.cpp"
+        &$scriptPath $inputs -OutputPath $output -CommandTable
+        Compare-Files $output "sc_table.cpp"
+    }
     It "Generates global parser config" {
         $output = Join-Path $outputPath "sc_global.cpp"
         &$scriptPath (Join-Path $inputPath "subcommand_global.h") -OutputPath $output -NameTransform PascalCase
@@ -1,3 +1,5 @@
+#include <ookii/command_line_generated.h>
+
 // [arguments: name]
 // Description of the arguments
 // with a line break.
@@ -31,5 +33,5 @@ struct my_arguments
 
     int not_an_arg{5};
 
-    OOKII_GENERATED_METHODS(my_arguments);
+    OOKII_GENERATED_METHODS_EX(my_arguments, char);
 };
@@ -0,0 +1,54 @@
+#include <ookii/command_line_generated.h>
+
+// Arguments for the -DirectParse test. The generated code is also compiled by the unit tests, so
+// this header uses the character type of the generated code explicitly.
+// [arguments]
+struct direct_arguments
+{
+    // [argument: Source]
+    // [required, positional]
+    std::string source;
+
+    // [argument: Count]
+    // [positional]
+    // [default: 7]
+    int count{1};
+
+    // [argument: Values]
+    // [multi_value]
+    // [alias: v]
+    // [default: 3]
+    std::vector<int> values{42};
+
+    // [argument: Verbose]
+    // [alias: b]
+    bool verbose{};
+
+    // [argument: Flag]
+    std::optional<bool> flag;
+
+    // [argument: Switches]
+    // [multi_value]
+    std::vector<bool> switches;
+
+    // [argument: Ratio]
+    // [default: 0.5f]
+    float ratio{};
+
+    // [argument: Cancel]
+    // [cancel_parsing]
+    bool cancel{};
+
+    OOKII_GENERATED_DIRECT_METHODS_EX(direct_arguments, char);
+};
+
+// [arguments]
+// [prefixes: --, -]
+// [case_sensitive, no_whitespace_separator, allow_duplicate_arguments, argument_value_separator: =]
+struct direct_options_arguments
+{
+    // [argument]
+    int some_arg;
+
+    OOKII_GENERATED_DIRECT_METHODS_EX(direct_options_arguments, char);
+};
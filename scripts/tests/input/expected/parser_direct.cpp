@@ -0,0 +1,212 @@
+// This file is generated by New-Parser.ps1; do not edit manually.
+#include <ookii/command_line.h>
+#include <ookii/command_line_generated.h>
+#include "../input/direct_arguments.h"
+    
+ookii::basic_parser_builder<char> direct_arguments::create_builder(std::basic_string<char> command_name, ookii::basic_localized_string_provider<char> *string_provider, const std::locale &locale)
+{
+    ookii::basic_parser_builder<char> builder{command_name, string_provider};
+    builder
+        .locale(locale)
+        .add_argument(this->source, "Source").required().positional()
+        .add_argument(this->count, "Count").positional().default_value(7)
+        .add_multi_value_argument(this->values, "Values").default_value(3).alias("v")
+        .add_argument(this->verbose, "Verbose").alias("b")
+        .add_argument(this->flag, "Flag")
+        .add_multi_value_argument(this->switches, "Switches")
+        .add_argument(this->ratio, "Ratio").default_value(0.5f)
+        .add_argument(this->cancel, "Cancel").cancel_parsing()
+    ;
+
+    return builder;
+}
+
+bool direct_arguments::parse_direct(std::span<const char *const> args, const std::locale &locale)
+{
+    enum class argument_id : size_t
+    {
+        source,
+        count,
+        values,
+        verbose,
+        flag,
+        switches,
+        ratio,
+        cancel,
+    };
+
+    using argument_info = ookii::details::direct_argument;
+    static constexpr argument_info arguments[] = {
+        argument_info::create<decltype(direct_arguments::source)>(argument_info::required | argument_info::positional),
+        argument_info::create<decltype(direct_arguments::count)>(argument_info::positional | argument_info::has_default),
+        argument_info::create_multi_value<decltype(direct_arguments::values)>(argument_info::has_default),
+        argument_info::create<decltype(direct_arguments::verbose)>(argument_info::none),
+        argument_info::create<decltype(direct_arguments::flag)>(argument_info::none),
+        argument_info::create_multi_value<decltype(direct_arguments::switches)>(argument_info::none),
+        argument_info::create<decltype(direct_arguments::ratio)>(argument_info::has_default),
+        argument_info::create<decltype(direct_arguments::cancel)>(argument_info::cancel_parsing),
+    };
+
+    static constexpr std::array<argument_id, 2> positional{ argument_id::source, argument_id::count };
+    ookii::details::direct_parser<char, argument_id, std::size(arguments)> parser{arguments, positional, ookii::details::direct_default_prefixes<char>(), locale};
+    this->values.clear();
+    this->switches.clear();
+    auto find = [&parser](std::basic_string_view<char> name) -> std::optional<argument_id>
+    {
+        switch (name.size())
+        {
+        case 1:
+            if (parser.name_equals(name, "v"))
+                return argument_id::values;
+            if (parser.name_equals(name, "b"))
+                return argument_id::verbose;
+            break;
+        case 4:
+            if (parser.name_equals(name, "Flag"))
+                return argument_id::flag;
+            break;
+        case 5:
+            if (parser.name_equals(name, "Count"))
+                return argument_id::count;
+            if (parser.name_equals(name, "Ratio"))
+                return argument_id::ratio;
+            break;
+        case 6:
+            if (parser.name_equals(name, "Source"))
+                return argument_id::source;
+            if (parser.name_equals(name, "Values"))
+                return argument_id::values;
+            if (parser.name_equals(name, "Cancel"))
+                return argument_id::cancel;
+            break;
+        case 7:
+            if (parser.name_equals(name, "Verbose"))
+                return argument_id::verbose;
+            break;
+        case 8:
+            if (parser.name_equals(name, "Switches"))
+                return argument_id::switches;
+            break;
+        }
+
+        return {};
+    };
+
+    auto set = [this, &locale](argument_id id, std::optional<std::basic_string_view<char>> value)
+    {
+        switch (id)
+        {
+        case argument_id::source:
+            return ookii::details::direct_set_value(this->source, value, locale);
+        case argument_id::count:
+            return ookii::details::direct_set_value(this->count, value, locale);
+        case argument_id::values:
+            return ookii::details::direct_add_value(this->values, value, locale);
+        case argument_id::verbose:
+            return ookii::details::direct_set_value(this->verbose, value, locale);
+        case argument_id::flag:
+            return ookii::details::direct_set_value(this->flag, value, locale);
+        case argument_id::switches:
+            return ookii::details::direct_add_value(this->switches, value, locale);
+        case argument_id::ratio:
+            return ookii::details::direct_set_value(this->ratio, value, locale);
+        case argument_id::cancel:
+            return ookii::details::direct_set_value(this->cancel, value, locale);
+        }
+
+        return false;
+    };
+
+    auto set_default = [this](argument_id id)
+    {
+        switch (id)
+        {
+        case argument_id::count:
+            this->count = 7;
+            break;
+        case argument_id::values:
+            this->values.push_back(3);
+            break;
+        case argument_id::ratio:
+            this->ratio = 0.5f;
+            break;
+        default:
+            break;
+        }
+    };
+
+    return parser.parse(args, find, set, set_default);
+}
+
+ookii::basic_parser_builder<char> direct_options_arguments::create_builder(std::basic_string<char> command_name, ookii::basic_localized_string_provider<char> *string_provider, const std::locale &locale)
+{
+    ookii::basic_parser_builder<char> builder{command_name, string_provider};
+    builder
+        .locale(locale)
+        .prefixes({ "--", "-" })
+        .case_sensitive(true)
+        .allow_whitespace_separator(false)
+        .allow_duplicate_arguments(true)
+        .argument_value_separator('=')
+        .add_argument(this->some_arg, "some_arg")
+    ;
+
+    return builder;
+}
+
+bool direct_options_arguments::parse_direct(std::span<const char *const> args, const std::locale &locale)
+{
+    enum class argument_id : size_t
+    {
+        some_arg,
+    };
+
+    using argument_info = ookii::details::direct_argument;
+    static constexpr argument_info arguments[] = {
+        argument_info::create<decltype(direct_options_arguments::some_arg)>(argument_info::none),
+    };
+
+    static constexpr std::array<argument_id, 0> positional{};
+    static constexpr std::basic_string_view<char> prefixes[] = { "--", "-" };
+    ookii::details::direct_parser<char, argument_id, std::size(arguments)> parser{arguments, positional, prefixes, locale};
+    parser.case_sensitive = true;
+    parser.allow_white_space_separator = false;
+    parser.allow_duplicate_arguments = true;
+    parser.argument_value_separator = '=';
+    auto find = [&parser](std::basic_string_view<char> name) -> std::optional<argument_id>
+    {
+        switch (name.size())
+        {
+        case 8:
+            if (parser.name_equals(name, "some_arg"))
+                return argument_id::some_arg;
+            break;
+        }
+
+        return {};
+    };
+
+    auto set = [this, &locale](argument_id id, std::optional<std::basic_string_view<char>> value)
+    {
+        switch (id)
+        {
+        case argument_id::some_arg:
+            return ookii::details::direct_set_value(this->some_arg, value, locale);
+        }
+
+        return false;
+    };
+
+    auto set_default = [this](argument_id id)
+    {
+        switch (id)
+        {
+        default:
+            break;
+        }
+    };
+
+    return parser.parse(args, find, set, set_default);
+}
+
+
@@ -0,0 +1,77 @@
+// This file is generated by New-Parser.ps1; do not edit manually.
+#include <ookii/command_line.h>
+#include "../input/arguments.h"
+    
+ookii::basic_parser_builder<char> my_arguments::create_builder(std::basic_string<char> command_name, ookii::basic_localized_string_provider<char> *string_provider, const std::locale &locale)
+{
+    command_name = "name";
+    ookii::basic_parser_builder<char> builder{command_name, string_provider};
+    builder
+        .locale(locale)
+        .description("Description of the arguments with a line break.\n\nAnd a paragraph.")
+        .add_argument(this->test_arg, "test_arg").required().positional().description("Argument description with a line break.\n\nAnd another paragraph.")
+        .add_argument(this->__test__arg2__, "__test__arg2__").positional().default_value(1).value_description("desc").alias("test").description("Short description.")
+        .add_multi_value_argument(this->test_arg3, "foo").alias("t").alias("v")
+        .add_argument(this->_testArg4, "_testArg4").cancel_parsing()
+        .add_argument(this->TestArg5, "TestArg5").default_value("foo")
+    ;
+
+    static constexpr std::basic_string_view<char> usage0{
+        "Description of the arguments with a line break.\n"
+        "\n"
+        "And a paragraph.\n"
+        "\n"
+        "Usage: name [-test_arg] <string> [[-__test__arg2__] <desc>] [-foo <float>...]\n"
+        "   [-help] [-TestArg5 <string>] [-_testArg4]\n"
+        "\n"
+        "    -test_arg <string>\n"
+        "        Argument description with a line break.\n"
+        "\n"
+        "And another paragraph.\n"
+        "\n"
+        "    -__test__arg2__ <desc> (-test)\n"
+        "        Short description. Default value: 1.\n"
+        "\n"
+        "    -foo <float> (-t, -v)\n"
+        "\n"
+        "\n"
+        "    -help [<bool>] (-?, -h)\n"
+        "        Displays this help message.\n"
+        "\n"
+        "    -TestArg5 <string>\n"
+        "         Default value: foo.\n"
+        "\n"
+    };
+    builder.prerendered_usage({ 80, false, ookii::usage_help_request::full, "C", "name" }, usage0);
+
+    static constexpr std::basic_string_view<char> usage1{
+        "Description of the arguments with a line break.\n"
+        "\n"
+        "And a paragraph.\n"
+        "\n"
+        "\033[36mUsage:\033[0m name [-test_arg] <string> [[-__test__arg2__] <desc>] [-foo <float>...]\n"
+        "   [-help] [-TestArg5 <string>] [-_testArg4]\n"
+        "\n"
+        "    \033[32m-test_arg <string>\033[0m\n"
+        "        Argument description with a line break.\n"
+        "\n"
+        "And another paragraph.\n"
+        "\n"
+        "    \033[32m-__test__arg2__ <desc> (-test)\033[0m\n"
+        "        Short description. Default value: 1.\n"
+        "\n"
+        "    \033[32m-foo <float> (-t, -v)\033[0m\n"
+        "\n"
+        "\n"
+        "    \033[32m-help [<bool>] (-?, -h)\033[0m\n"
+        "        Displays this help message.\n"
+        "\n"
+        "    \033[32m-TestArg5 <string>\033[0m\n"
+        "         Default value: foo.\n"
+        "\n"
+    };
+    builder.prerendered_usage({ 80, true, ookii::usage_help_request::full, "C", "name" }, usage1);
+
+    return builder;
+}
+
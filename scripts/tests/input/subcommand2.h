@@ -18,7 +18,7 @@ private:
 class third_command : public other_command
 {
 public:
-    other_command(builder_type &builder);
+    third_command(builder_type &builder);
 
     virtual int run() override;
 
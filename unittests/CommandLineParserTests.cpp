@@ -1,14 +1,28 @@
 #include "common.h"
 #include "framework.h"
 #include <ookii/command_line.h>
+#include <ookii/reloadable_options.h>
+#include <atomic>
+#include <thread>
 #include "custom_types.h"
 #include "argument_types.h"
 #include "expected_usage.h"
+// Types used by the code generated by New-Parser.ps1 in scripts/tests/input/expected.
+#include "arguments.h"
+#include "direct_arguments.h"
 using namespace std;
 using namespace ookii;
 
 int ActionArguments::action_value = 0;
 
+struct ReloadOptions
+{
+    int value{};
+    int copy{};
+    tstring name;
+    tstring_view label;
+};
+
 class CommandLineParserTests : public test::TestClass
 {
 public:
@@ -490,6 +504,110 @@ public:
         VERIFY_EQUAL(c_usageExpectedColor, stream.view());
     }
 
+    TEST_METHOD(TestUsageCache)
+    {
+        UsageArguments args{};
+        auto parser = args.create_parser();
+
+        tline_wrapping_ostringstream stream{40};
+        basic_usage_writer<tchar_t> usage{stream};
+        usage.use_usage_cache = true;
+        parser.write_usage(&usage);
+        VERIFY_EQUAL(c_usageExpected, stream.view());
+        VERIFY_EQUAL(1u, parser.usage_cache().size());
+
+        // Written from the cache.
+        stream.str(TEXT(""));
+        parser.write_usage(&usage);
+        VERIFY_EQUAL(c_usageExpected, stream.view());
+        VERIFY_EQUAL(1u, parser.usage_cache().size());
+
+        // Different color setting.
+        stream.str(TEXT(""));
+        basic_usage_writer<tchar_t> usage2{stream, true};
+        usage2.use_usage_cache = true;
+        parser.write_usage(&usage2);
+        VERIFY_EQUAL(c_usageExpectedColor, stream.view());
+        VERIFY_EQUAL(2u, parser.usage_cache().size());
+
+        // Different width.
+        LongShortArguments args2{};
+        auto parser2 = args2.create_parser();
+        tline_wrapping_ostringstream stream2{0};
+        basic_usage_writer<tchar_t> usage3{stream2};
+        usage3.use_usage_cache = true;
+        parser2.write_usage(&usage3);
+        stream2.str(TEXT(""));
+        parser2.write_usage(&usage3);
+        VERIFY_EQUAL(c_usageExpectedLongShort, stream2.view());
+
+        // Save and load.
+        auto path = std::filesystem::temp_directory_path() / "ookii_usage_cache_test.bin";
+        VERIFY_TRUE(parser.usage_cache().save(path));
+        auto parser3 = args.create_parser();
+        VERIFY_TRUE(parser3.usage_cache().load(path));
+        std::filesystem::remove(path);
+        VERIFY_EQUAL(2u, parser3.usage_cache().size());
+        basic_usage_cache_key<tchar_t> key{40, true, usage_help_request::full, parser3.locale().name(), parser3.command_name()};
+        auto entry = parser3.usage_cache().find(key);
+        VERIFY_NOT_NULL(entry);
+        VERIFY_EQUAL(c_usageExpectedColor, *entry);
+        VERIFY_FALSE(parser3.usage_cache().load(path));
+    }
+
+    TEST_METHOD(TestInitialValues)
+    {
+        int value{5};
+        tstring name{TEXT("initial")};
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_argument(value, TEXT("Value"))
+            .add_argument(name, TEXT("Name"))
+            .build();
+
+        // Nothing is restored if the values weren't captured.
+        VerifyParseResult(parser.parse({ TEXT("-Value"), TEXT("6") }), parser);
+        parser.restore_initial_values();
+        VERIFY_EQUAL(6, value);
+
+        value = 5;
+        parser.capture_initial_values();
+        VerifyParseResult(parser.parse({ TEXT("-Value"), TEXT("7"), TEXT("-Name"), TEXT("foo") }), parser);
+        VERIFY_EQUAL(7, value);
+        VERIFY_EQUAL(TEXT("foo"), name);
+        parser.restore_initial_values();
+        VERIFY_EQUAL(5, value);
+        VERIFY_EQUAL(TEXT("initial"), name);
+    }
+
+    TEST_METHOD(TestPrerenderedUsage)
+    {
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .prerendered_usage({40, false, usage_help_request::full, std::locale{}.name(), TEXT("TestCommand")}, TEXT("Prerendered usage.\n"))
+            .build();
+
+        tline_wrapping_ostringstream stream{40};
+        basic_usage_writer<tchar_t> usage{stream};
+        usage.use_usage_cache = true;
+        parser.write_usage(&usage);
+        VERIFY_EQUAL(TEXT("Prerendered usage.\n"), stream.view());
+
+        // Not used if the width doesn't match.
+        tline_wrapping_ostringstream stream2{80};
+        basic_usage_writer<tchar_t> usage2{stream2};
+        usage2.use_usage_cache = true;
+        parser.write_usage(&usage2);
+        VERIFY_EQUAL(TEXT("Usage: TestCommand [-Help]\n\n    -Help [<bool>] (-?, -h)\n        Displays this help message.\n\n"), stream2.view());
+
+        // Not used if the name doesn't match.
+        auto parser2 = basic_parser_builder<tchar_t>{TEXT("OtherCommand")}
+            .prerendered_usage({40, false, usage_help_request::full, std::locale{}.name(), TEXT("TestCommand")}, TEXT("Prerendered usage.\n"))
+            .build();
+
+        stream.str(TEXT(""));
+        parser2.write_usage(&usage);
+        VERIFY_EQUAL(TEXT("Usage: OtherCommand [-Help]\n\n    -Help [<bool>] (-?, -h)\n        Displays this help message.\n\n"), stream.view());
+    }
+
     TEST_METHOD(TestUsageLongShort)
     {
         LongShortArguments args{};
@@ -512,6 +630,26 @@ public:
         VERIFY_EQUAL(c_usageExpectedLongShortColor, stream.view());
     }
 
+    TEST_METHOD(TestCapabilityCache)
+    {
+        // The probed value depends on how the tests are run, but must be stable.
+        auto probed = vt::capability_cache::get(standard_stream::output);
+        VERIFY_EQUAL(probed.color, vt::capability_cache::get(standard_stream::output).color);
+        VERIFY_FALSE(vt::capability_cache::get(standard_stream::input).virtual_terminal);
+
+        vt::capability_cache::set(standard_stream::output, {true, true, false});
+        auto capabilities = vt::capability_cache::get(standard_stream::output);
+        VERIFY_TRUE(capabilities.virtual_terminal);
+        VERIFY_TRUE(capabilities.color);
+        VERIFY_FALSE(capabilities.true_color);
+
+        vt::capability_cache::reset(standard_stream::output);
+        capabilities = vt::capability_cache::get(standard_stream::output);
+        VERIFY_EQUAL(probed.virtual_terminal, capabilities.virtual_terminal);
+        VERIFY_EQUAL(probed.color, capabilities.color);
+        VERIFY_EQUAL(probed.true_color, capabilities.true_color);
+    }
+
     TEST_METHOD(TestUsageLongShortSyntaxShortName)
     {
         LongShortArguments args{};
@@ -612,6 +750,35 @@ public:
         VERIFY_EQUAL(c_usageExpectedLongShortAlphabeticalShortNameDescending, stream.view());
     }
 
+    TEST_METHOD(TestArgumentsInOrder)
+    {
+        UsageArguments args{};
+        auto parser = args.create_parser();
+
+        const auto &usage = parser.arguments_in_order(description_list_sort_mode::usage_order);
+        VERIFY_EQUAL(parser.argument_count(), usage.size());
+        size_t index = 0;
+        for (const auto &arg : parser.arguments())
+        {
+            VERIFY_TRUE(&arg == usage[index]);
+            ++index;
+        }
+
+        const auto &sorted = parser.arguments_in_order(description_list_sort_mode::alphabetical);
+        const tchar_t *expected[] = { TEXT("FloatArg"), TEXT("Help"), TEXT("IntArg"), TEXT("IntArg2"), TEXT("MultiArg"), TEXT("OptionalSwitchArg"), TEXT("StringArg"), TEXT("SwitchArg") };
+        VERIFY_EQUAL(std::size(expected), sorted.size());
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            VERIFY_EQUAL(expected[i], sorted[i]->name());
+        }
+
+        // The result is cached, and survives moving the parser.
+        VERIFY_TRUE(&sorted == &parser.arguments_in_order(description_list_sort_mode::alphabetical));
+        auto moved = std::move(parser);
+        VERIFY_TRUE(&sorted == &moved.arguments_in_order(description_list_sort_mode::alphabetical));
+        VERIFY_THROWS(moved.arguments_in_order(static_cast<description_list_sort_mode>(42)), std::logic_error);
+    }
+
     TEST_METHOD(TestWindowsOptionPrefix)
     {
         tstring arg;
@@ -860,6 +1027,35 @@ public:
         VerifyParseResult(parser.parse({ TEXT("-c") }), parser, parse_error::unknown_argument, TEXT("c"));;
     }
 
+    TEST_METHOD(TestBarePrefix)
+    {
+        tstring value;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_argument(value, TEXT("Value")).positional()
+            .build();
+
+        // A single dash is a value, usually meaning the standard input.
+        VerifyParseResult(parser.parse({ TEXT("-") }), parser);
+        VERIFY_EQUAL(TEXT("-"), value);
+        VerifyParseResult(parser.parse({ TEXT("-Value"), TEXT("-") }), parser);
+        VERIFY_EQUAL(TEXT("-"), value);
+
+        auto long_short_parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .mode(parsing_mode::long_short)
+            .add_argument(value, TEXT("value")).short_name().positional()
+            .build();
+
+        value.clear();
+        VerifyParseResult(long_short_parser.parse({ TEXT("-") }), long_short_parser);
+        VERIFY_EQUAL(TEXT("-"), value);
+        VerifyParseResult(long_short_parser.parse({ TEXT("--value"), TEXT("-") }), long_short_parser);
+        VERIFY_EQUAL(TEXT("-"), value);
+
+        // The long prefix on its own is still an error.
+        VerifyParseResult(long_short_parser.parse({ TEXT("--") }), long_short_parser, parse_error::unknown_argument, TEXT(""));
+        VerifyParseResult(long_short_parser.parse({ TEXT("--value"), TEXT("--") }), long_short_parser, parse_error::missing_value, TEXT("value"));
+    }
+
     TEST_METHOD(TestActionArguments)
     {
         ActionArguments args{};
@@ -947,7 +1143,683 @@ public:
         VERIFY_EQUAL(TEXT(""), error.str());
     }
 
+    TEST_METHOD(TestEnvironmentVariable)
+    {
+        int arg{};
+        bool sw{};
+        std::vector<int> multi;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_argument(arg, TEXT("Arg")).environment_variable(TEXT("OOKII_TEST_ARG")).default_value(1)
+            .add_argument(sw, TEXT("Switch")).environment_variable(TEXT("OOKII_TEST_SWITCH"))
+            .add_multi_value_argument(multi, TEXT("Multi")).environment_variable(TEXT("OOKII_TEST_MULTI")).separator(',')
+            .build();
+
+        SetEnvVar("OOKII_TEST_ARG", nullptr);
+        SetEnvVar("OOKII_TEST_SWITCH", nullptr);
+        SetEnvVar("OOKII_TEST_MULTI", nullptr);
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser);
+        VERIFY_EQUAL(1, arg);
+        VERIFY_EQUAL((int)value_source::default_value, (int)parser.get_argument(TEXT("Arg"))->source());
+        VERIFY_FALSE(parser.get_argument(TEXT("Arg"))->has_value());
+        VERIFY_EQUAL((int)value_source::none, (int)parser.get_argument(TEXT("Switch"))->source());
+
+        SetEnvVar("OOKII_TEST_ARG", "5");
+        SetEnvVar("OOKII_TEST_SWITCH", "true");
+        SetEnvVar("OOKII_TEST_MULTI", "1,2");
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser);
+        VERIFY_EQUAL(5, arg);
+        VERIFY_TRUE(parser.get_argument(TEXT("Arg"))->has_value());
+        VERIFY_EQUAL((int)value_source::environment, (int)parser.get_argument(TEXT("Arg"))->source());
+        VERIFY_TRUE(sw);
+        VERIFY_EQUAL(2u, multi.size());
+        VERIFY_EQUAL(2, multi[1]);
+
+        // The command line takes precedence.
+        VerifyParseResult(parser.parse({ TEXT("-Arg"), TEXT("6"), TEXT("-Multi"), TEXT("3") }), parser);
+        VERIFY_EQUAL(6, arg);
+        VERIFY_EQUAL((int)value_source::command_line, (int)parser.get_argument(TEXT("Arg"))->source());
+        VERIFY_EQUAL(1u, multi.size());
+        VERIFY_EQUAL(3, multi[0]);
+
+        SetEnvVar("OOKII_TEST_ARG", "foo");
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser, parse_error::invalid_value, TEXT("Arg"));
+
+        SetEnvVar("OOKII_TEST_ARG", nullptr);
+        SetEnvVar("OOKII_TEST_SWITCH", nullptr);
+        SetEnvVar("OOKII_TEST_MULTI", nullptr);
+    }
+
+    TEST_METHOD(TestConfigFile)
+    {
+        auto path1 = std::filesystem::temp_directory_path() / "ookii_config_test1.conf";
+        auto path2 = std::filesystem::temp_directory_path() / "ookii_config_test2.conf";
+        {
+            std::ofstream file{path1};
+            file << "# Comment\n\n  arg = 5  \r\nswitch\nmulti=1\n; Other comment\nmulti=2\nText=hello world\n";
+        }
+
+        {
+            std::ofstream file{path2};
+            file << "Arg=7\nOther=8\n";
+        }
+
+        int arg{};
+        int other{};
+        bool sw{};
+        std::vector<int> multi;
+        tstring text;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .config_file(path1)
+            .config_file(path2)
+            .config_file(std::filesystem::temp_directory_path() / "ookii_config_test_missing.conf")
+            .add_argument(arg, TEXT("Arg")).required().environment_variable(TEXT("OOKII_TEST_CONFIG_ARG"))
+            .add_argument(other, TEXT("Other"))
+            .add_argument(sw, TEXT("Switch"))
+            .add_multi_value_argument(multi, TEXT("Multi"))
+            .add_argument(text, TEXT("Text"))
+            .build();
+
+        SetEnvVar("OOKII_TEST_CONFIG_ARG", nullptr);
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser);
+        VERIFY_EQUAL(5, arg);
+        VERIFY_EQUAL((int)value_source::config_file, (int)parser.get_argument(TEXT("Arg"))->source());
+        VERIFY_EQUAL(8, other);
+        VERIFY_TRUE(sw);
+        VERIFY_EQUAL(2u, multi.size());
+        VERIFY_EQUAL(1, multi[0]);
+        VERIFY_EQUAL(2, multi[1]);
+        VERIFY_EQUAL(TEXT("hello world"), text);
+
+        // The environment and the command line take precedence.
+        SetEnvVar("OOKII_TEST_CONFIG_ARG", "9");
+        VerifyParseResult(parser.parse({ TEXT("-Multi"), TEXT("3") }), parser);
+        VERIFY_EQUAL(9, arg);
+        VERIFY_EQUAL((int)value_source::environment, (int)parser.get_argument(TEXT("Arg"))->source());
+        VERIFY_EQUAL(1u, multi.size());
+        VERIFY_EQUAL(3, multi[0]);
+        SetEnvVar("OOKII_TEST_CONFIG_ARG", nullptr);
+
+        {
+            std::ofstream file{path2};
+            file << "Unknown=1\n";
+        }
+
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser, parse_error::unknown_argument, TEXT("Unknown"));
+
+        {
+            std::ofstream file{path2};
+            file << "Other=foo\n";
+        }
+
+        VerifyParseResult(parser.parse(std::initializer_list<const tchar_t *>{}), parser, parse_error::invalid_value, TEXT("Other"));
+        std::filesystem::remove(path1);
+        std::filesystem::remove(path2);
+    }
+
+    TEST_METHOD(TestReloadableOptions)
+    {
+        auto path = std::filesystem::temp_directory_path() / "ookii_reload_test.conf";
+        auto write_config = [&path](std::string_view value)
+        {
+            std::ofstream file{path};
+            file << "Value=" << value << "\nCopy=" << value << "\nLabel=label" << value << "\n";
+        };
+
+        write_config("1");
+        basic_reloadable_options<ReloadOptions, tchar_t> options{[&path](ReloadOptions &o)
+            {
+                return basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+                    .config_file(path)
+                    .add_argument(o.value, TEXT("Value"))
+                    .add_argument(o.copy, TEXT("Copy"))
+                    .add_argument(o.name, TEXT("Name"))
+                    .add_argument(o.label, TEXT("Label"))
+                    .build();
+            }, { TEXT("-Name"), TEXT("cli") }};
+
+        VERIFY_EQUAL(0, options.current()->value);
+        auto generation = options.generation();
+        VERIFY_TRUE(options.reload());
+        VERIFY_EQUAL(generation + 1, options.generation());
+        VERIFY_EQUAL(1, options.current()->value);
+        VERIFY_EQUAL(TEXT("cli"), options.current()->name);
+
+        // A string_view from the configuration file points into the parser, which must live as
+        // long as the snapshot.
+        auto snapshot = options.current();
+        VERIFY_EQUAL(TEXT("label1"), snapshot->label);
+        write_config("2");
+        VERIFY_TRUE(options.reload());
+        VERIFY_EQUAL(TEXT("label2"), options.current()->label);
+        VERIFY_EQUAL(TEXT("label1"), snapshot->label);
+        snapshot.reset();
+
+        // Readers must always see a consistent snapshot, and never go back to an older one.
+        std::atomic<bool> done{};
+        std::atomic<int> errors{};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.emplace_back([&]()
+                {
+                    decltype(options)::reader reader{options};
+                    int last = 0;
+                    while (!done.load())
+                    {
+                        const auto &snapshot = reader.get();
+                        if (snapshot.value != snapshot.copy || snapshot.value < last || snapshot.name != TEXT("cli"))
+                        {
+                            ++errors;
+                        }
+
+                        last = snapshot.value;
+                    }
+                });
+        }
+
+        for (int i = 2; i <= 50; ++i)
+        {
+            write_config(std::to_string(i));
+            VERIFY_TRUE(options.reload());
+        }
+
+        done = true;
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+
+        VERIFY_EQUAL(0, errors.load());
+        VERIFY_EQUAL(50, options.current()->value);
+
+        // A failed reload keeps the current snapshot.
+        write_config("foo");
+        VERIFY_EQUAL((int)parse_error::invalid_value, (int)options.reload().error);
+        VERIFY_EQUAL(50, options.current()->value);
+
+        std::atomic<int> reloads{};
+        options.watch(path, [&reloads](const auto &result)
+            {
+                if (result)
+                {
+                    ++reloads;
+                }
+            }, std::chrono::milliseconds{10});
+
+        write_config("60");
+        for (int i = 0; i < 500 && options.current()->value != 60; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+
+        options.stop_watching();
+        VERIFY_EQUAL(60, options.current()->value);
+        VERIFY_TRUE(reloads.load() > 0);
+        std::filesystem::remove(path);
+    }
+
+    TEST_METHOD(TestStringViewArguments)
+    {
+        tstring_view arg;
+        std::optional<tstring_view> optional_arg;
+        std::vector<tstring_view> multi;
+        tstring_view env_arg;
+        auto path = std::filesystem::temp_directory_path() / "ookii_string_view_test.conf";
+        {
+            std::ofstream file{path};
+            file << "Optional=from file\n";
+        }
+
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .config_file(path)
+            .add_argument(arg, TEXT("Arg")).positional()
+            .add_argument(optional_arg, TEXT("Optional"))
+            .add_multi_value_argument(multi, TEXT("Multi")).separator(',')
+            .add_argument(env_arg, TEXT("Env")).environment_variable(TEXT("OOKII_TEST_STRING_VIEW"))
+            .build();
+
+        VERIFY_TRUE(parser.get_argument(TEXT("Arg"))->refers_to_input());
+        VERIFY_TRUE(parser.get_argument(TEXT("Multi"))->refers_to_input());
+        VERIFY_EQUAL(TEXT("string"), parser.get_argument(TEXT("Arg"))->value_description());
+
+        // Values from the command line point directly into argv.
+        SetEnvVar("OOKII_TEST_STRING_VIEW", "from env");
+        const tchar_t *argv[] = { TEXT("TestCommand"), TEXT("foo"), TEXT("-Multi:a,bc"), TEXT("-Multi"), TEXT("d") };
+        VerifyParseResult(parser.parse(5, argv), parser);
+        VERIFY_EQUAL(TEXT("foo"), arg);
+        VERIFY_TRUE(arg.data() == argv[1]);
+        VERIFY_EQUAL(3u, multi.size());
+        VERIFY_EQUAL(TEXT("bc"), multi[1]);
+        VERIFY_TRUE(multi[1].data() == argv[2] + 9);
+        VERIFY_TRUE(multi[2].data() == argv[4]);
+
+        // Values from the environment and config files are kept by the parser.
+        SetEnvVar("OOKII_TEST_STRING_VIEW", nullptr);
+        std::filesystem::remove(path);
+        VERIFY_EQUAL(TEXT("from env"), env_arg);
+        VERIFY_EQUAL(TEXT("from file"), *optional_arg);
+
+        // Temporary strings returned by an iterator are kept as well.
+        std::vector<tstring> args{ TEXT("bar"), TEXT("-Multi"), TEXT("x") };
+        struct value_iterator
+        {
+            std::vector<tstring>::const_iterator it;
+
+            tstring operator*() const { return *it; }
+            value_iterator &operator++() { ++it; return *this; }
+            value_iterator operator++(int) { auto temp = *this; ++it; return temp; }
+            bool operator==(const value_iterator &other) const { return it == other.it; }
+            bool operator!=(const value_iterator &other) const { return it != other.it; }
+        };
+
+        VerifyParseResult(parser.parse(value_iterator{args.cbegin()}, value_iterator{args.cend()}), parser);
+        args.clear();
+        VERIFY_EQUAL(TEXT("bar"), arg);
+        VERIFY_EQUAL(1u, multi.size());
+        VERIFY_EQUAL(TEXT("x"), multi[0]);
+    }
+
+    TEST_METHOD(TestSplitCommandLine)
+    {
+        auto tokens = split_command_line(tstring_view{TEXT("  foo 'bar baz'\t\"a \\\"b\\\" \\$c \\d\" e\\ f '' g\"h\"'i' \\\n j\\\nk ")});
+        VERIFY_TRUE(tokens.has_value());
+        const tstring_view expected[] = { TEXT("foo"), TEXT("bar baz"), TEXT("a \"b\" $c \\d"), TEXT("e f"), TEXT(""), TEXT("ghi"), TEXT("jk") };
+        VERIFY_EQUAL(std::size(expected), tokens->size());
+        for (size_t i = 0; i < tokens->size(); ++i)
+        {
+            VERIFY_EQUAL(expected[i], (*tokens)[i]);
+            VERIFY_EQUAL(expected[i], tstring_view{tokens->args()[i]});
+        }
+
+        // The tokens remain valid when moved.
+        auto moved = std::move(*tokens);
+        VERIFY_EQUAL(TEXT("bar baz"), moved[1]);
+
+        VERIFY_TRUE(split_command_line(tstring_view{TEXT("   ")})->empty());
+        VERIFY_FALSE(split_command_line(tstring_view{TEXT("foo 'bar")}).has_value());
+        VERIFY_FALSE(split_command_line(tstring_view{TEXT("foo \"bar\\\"")}).has_value());
+        VERIFY_FALSE(split_command_line(tstring_view{TEXT("foo\\")}).has_value());
+
+        tstring arg1;
+        int arg2{};
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_argument(arg1, TEXT("Arg1")).positional()
+            .add_argument(arg2, TEXT("Arg2"))
+            .build();
+
+        auto args = split_command_line(tstring_view{TEXT("\"hello world\" -Arg2 '5'")});
+        VerifyParseResult(parser.parse(*args), parser);
+        VERIFY_EQUAL(TEXT("hello world"), arg1);
+        VERIFY_EQUAL(5, arg2);
+        VerifyParseResult(parser.parse(args->args()), parser);
+        VERIFY_EQUAL(TEXT("hello world"), arg1);
+    }
+
+    TEST_METHOD(TestValueFromFile)
+    {
+        auto path = std::filesystem::temp_directory_path() / "ookii_value_file_test.txt";
+        {
+            std::ofstream file{path};
+            file << "-----BEGIN CERTIFICATE-----\nabc=\n";
+        }
+
+        tstring_view view_arg;
+        tstring string_arg;
+        int int_arg{};
+        tstring plain_arg;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_argument(view_arg, TEXT("View")).allow_value_from_file()
+            .add_argument(string_arg, TEXT("String")).allow_value_from_file(TEXT("file:"))
+            .add_argument(int_arg, TEXT("Int")).allow_value_from_file()
+            .add_argument(plain_arg, TEXT("Plain"))
+            .build();
+
+        VERIFY_EQUAL(TEXT("@"), parser.get_argument(TEXT("View"))->value_file_prefix());
+        VERIFY_EQUAL(TEXT(""), parser.get_argument(TEXT("Plain"))->value_file_prefix());
+
+        auto file_name = path.string<tchar_t>();
+        auto at_file = TEXT("@") + file_name;
+        auto prefixed_file = TEXT("file:") + file_name;
+        VerifyParseResult(parser.parse({ TEXT("-View"), at_file.c_str(), TEXT("-String"), prefixed_file.c_str(),
+            TEXT("-Plain"), at_file.c_str() }), parser);
+
+        VERIFY_EQUAL(TEXT("-----BEGIN CERTIFICATE-----\nabc=\n"), view_arg);
+        VERIFY_EQUAL(TEXT("-----BEGIN CERTIFICATE-----\nabc=\n"), string_arg);
+        VERIFY_EQUAL(at_file, plain_arg);
+
+        // Values without the prefix are used as is.
+        VerifyParseResult(parser.parse({ TEXT("-View"), TEXT("value"), TEXT("-String"), at_file.c_str() }), parser);
+        VERIFY_EQUAL(TEXT("value"), view_arg);
+        VERIFY_EQUAL(at_file, string_arg);
+
+        // The contents are converted like any other value.
+        {
+            std::ofstream file{path};
+            file << "42";
+        }
+
+        VerifyParseResult(parser.parse({ TEXT("-Int"), at_file.c_str() }), parser);
+        VERIFY_EQUAL(42, int_arg);
+
+        std::filesystem::remove(path);
+        VerifyParseResult(parser.parse({ TEXT("-View"), at_file.c_str() }), parser, parse_error::unreadable_value_file, TEXT("View"));
+        VERIFY_THROWS(basic_parser_builder<tchar_t>{TEXT("TestCommand")}.add_argument(plain_arg, TEXT("Plain")).allow_value_from_file(TEXT("")), std::invalid_argument);
+    }
+
+    TEST_METHOD(TestValuesFromStream)
+    {
+        auto lines_path = std::filesystem::temp_directory_path() / "ookii_stream_test_lines.txt";
+        auto nul_path = std::filesystem::temp_directory_path() / "ookii_stream_test_nul.txt";
+        {
+            std::ofstream file{lines_path, std::ios::binary};
+            file << "a\r\n\nb c\nd";
+        }
+
+        {
+            std::ofstream file{nul_path, std::ios::binary};
+            file << "e" << '\0' << "f\n" << '\0';
+        }
+
+        std::vector<tstring> files;
+        std::vector<tstring> nul_files;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_multi_value_argument(files, TEXT("File")).positional()
+            .add_multi_value_argument(files, TEXT("FilesFrom")).values_from_stream()
+            .add_multi_value_argument(nul_files, TEXT("Null")).values_from_stream('\0')
+            .build();
+
+        auto multi_arg = static_cast<const multi_value_command_line_argument<std::vector<tstring>, tchar_t> *>(parser.get_argument(TEXT("FilesFrom")));
+        VERIFY_EQUAL('\n', *multi_arg->stream_delimiter());
+
+        auto lines_file = lines_path.string<tchar_t>();
+        auto nul_file = nul_path.string<tchar_t>();
+        VerifyParseResult(parser.parse({ TEXT("x"), TEXT("-FilesFrom"), lines_file.c_str(), TEXT("-Null"), nul_file.c_str() }), parser);
+        const std::vector<tstring> expected{ TEXT("x"), TEXT("a"), TEXT("b c"), TEXT("d") };
+        VERIFY_RANGE_EQUAL(expected, files);
+        VERIFY_EQUAL(2u, nul_files.size());
+        VERIFY_EQUAL(TEXT("e"), nul_files[0]);
+        VERIFY_EQUAL(TEXT("f\n"), nul_files[1]);
+
+        // Read from the standard input, with values that cross the block boundary, and one value
+        // that doesn't fit in a single block.
+        std::string input;
+        for (int i = 0; i < 20000; ++i)
+        {
+            input += std::to_string(i);
+            input += '\n';
+        }
+
+        input += std::string(100000, '9');
+        std::stringbuf input_buffer{input};
+        auto old_buffer = std::cin.rdbuf(&input_buffer);
+        int count = 0;
+        long long sum = 0;
+        size_t long_size = 0;
+        std::vector<tstring_view> view_sink;
+        auto parser2 = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_multi_value_argument(view_sink, TEXT("Values")).values_from_stream([&](tstring_view &&value)
+                {
+                    if (value.size() > 10)
+                    {
+                        long_size = value.size();
+                    }
+                    else
+                    {
+                        sum += std::stoi(tstring{value});
+                    }
+
+                    ++count;
+                    return true;
+                })
+            .build();
+
+        auto result = parser2.parse({ TEXT("-Values"), TEXT("-") });
+        std::cin.rdbuf(old_buffer);
+        VerifyParseResult(result, parser2);
+        VERIFY_EQUAL(20001, count);
+        VERIFY_EQUAL(19999LL * 20000 / 2, sum);
+        VERIFY_EQUAL(100000u, long_size);
+        VERIFY_TRUE(view_sink.empty());
+
+        // Conversion errors and missing files.
+        std::vector<int> numbers;
+        auto parser3 = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .add_multi_value_argument(numbers, TEXT("Numbers")).values_from_stream()
+            .build();
+
+        VerifyParseResult(parser3.parse({ TEXT("-Numbers"), lines_file.c_str() }), parser3, parse_error::invalid_value, TEXT("Numbers"));
+        std::filesystem::remove(lines_path);
+        std::filesystem::remove(nul_path);
+        VerifyParseResult(parser3.parse({ TEXT("-Numbers"), lines_file.c_str() }), parser3, parse_error::unreadable_value_file, TEXT("Numbers"));
+    }
+
+    TEST_METHOD(TestDirectParse)
+    {
+        std::vector<std::vector<const char *>> cases{
+            { "foo" },
+            { "foo", "5" },
+            { "-count", "5", "foo" },
+            { "-Source:foo", "-Count", "-5" },
+            { "foo", "-v", "1", "-Values:2", "-VALUES", "-3" },
+            { "foo", "-b", "-Flag:false", "-Switches", "-Switches:false" },
+            { "foo", "-Ratio", "2.5", "-Verbose:true" },
+            { "foo", "-" },
+            { "foo", "/" },
+            // These fail, or are handled by the full parser.
+            { },
+            { "foo", "5", "6" },
+            { "foo", "-Unknown" },
+            { "foo", "-Count" },
+            { "foo", "-Count", "-b" },
+            { "foo", "-Count", "bar" },
+            { "foo", "-Verbose", "-b" },
+            { "foo", "-Cancel" },
+            { "foo", "-Help" },
+        };
+
+        for (const auto &args : cases)
+        {
+            direct_arguments direct{};
+            auto direct_result = direct.parse_direct(args, {});
+            direct_arguments full{};
+            auto result = full.create_builder("TestCommand", nullptr, {}).build().parse(args);
+            VERIFY_EQUAL(static_cast<bool>(result), direct_result);
+            if (direct_result)
+            {
+                // The generated code uses char, so compare strings without logging them.
+                VERIFY_TRUE(full.source == direct.source);
+                VERIFY_EQUAL(full.count, direct.count);
+                VERIFY_RANGE_EQUAL(full.values, direct.values);
+                VERIFY_EQUAL(full.verbose, direct.verbose);
+                VERIFY_EQUAL(full.flag.has_value(), direct.flag.has_value());
+                VERIFY_EQUAL(full.flag.value_or(false), direct.flag.value_or(false));
+                VERIFY_RANGE_EQUAL(full.switches, direct.switches);
+                VERIFY_EQUAL(full.ratio, direct.ratio);
+            }
+        }
+
+        // The generated parse() method uses the direct parser when possible.
+        std::vector<const char *> args{ "TestCommand", "foo", "-v", "9" };
+        auto parsed = direct_arguments::parse(static_cast<int>(args.size()), args.data());
+        VERIFY_TRUE(parsed.has_value());
+        VERIFY_TRUE(parsed->source == "foo");
+        VERIFY_EQUAL(7, parsed->count);
+        VERIFY_RANGE_EQUAL(std::vector<int>{ 9 }, parsed->values);
+
+        // Custom prefixes and options.
+        std::vector<std::vector<const char *>> options_cases{
+            { "--some_arg=5" },
+            { "-some_arg=5", "--some_arg=6" },
+            { "--some_arg:5" },
+            { "--Some_Arg=5" },
+            { "--some_arg", "5" },
+            { "--" },
+        };
+
+        for (const auto &args : options_cases)
+        {
+            direct_options_arguments direct{};
+            auto direct_result = direct.parse_direct(args, {});
+            direct_options_arguments full{};
+            auto result = full.create_builder("TestCommand", nullptr, {}).build().parse(args);
+            VERIFY_EQUAL(static_cast<bool>(result), direct_result);
+            if (direct_result)
+            {
+                VERIFY_EQUAL(full.some_arg, direct.some_arg);
+            }
+        }
+    }
+
+    TEST_METHOD(TestGeneratedUsageCache)
+    {
+        // The usage help embedded by New-Parser.ps1 -UsageCachePath is used instead of rendering it.
+        my_arguments args{};
+        auto parser = args.create_builder("name", nullptr, std::locale::classic()).build();
+        VERIFY_EQUAL(2u, parser.usage_cache().size());
+
+        line_wrapping_ostringstream stream{80};
+        usage_writer usage{stream};
+        usage.use_usage_cache = true;
+        parser.write_usage(&usage);
+        VERIFY_EQUAL(2u, parser.usage_cache().size());
+        VERIFY_TRUE(stream.str().starts_with("Description of the arguments with a line break.\n\nAnd a paragraph.\n\nUsage: name "));
+
+        // Other widths are rendered as normal.
+        line_wrapping_ostringstream stream2{40};
+        usage_writer usage2{stream2};
+        usage2.use_usage_cache = true;
+        parser.write_usage(&usage2);
+        VERIFY_EQUAL(3u, parser.usage_cache().size());
+
+        // The generated parse() method also works for types without a parse_direct() method.
+        std::vector<const char *> argv{ "name", "foo", "5" };
+        auto parsed = my_arguments::parse(static_cast<int>(argv.size()), argv.data());
+        VERIFY_TRUE(parsed.has_value());
+        VERIFY_TRUE(parsed->test_arg == "foo");
+        VERIFY_EQUAL(5, parsed->__test__arg2__);
+    }
+
+    TEST_METHOD(TestParseLimits)
+    {
+        tstring text;
+        std::vector<int> multi;
+        std::vector<bool> switches;
+        auto parser = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .max_token_count(4)
+            .max_value_length(5)
+            .max_value_count(3)
+            .max_total_value_length(12)
+            .add_argument(text, TEXT("Text")).positional()
+            .add_multi_value_argument(multi, TEXT("Multi")).separator(',')
+            .add_multi_value_argument(switches, TEXT("Switch"))
+            .build();
+
+        VERIFY_EQUAL(4u, parser.max_token_count());
+        VERIFY_EQUAL(5u, parser.max_value_length());
+        VERIFY_EQUAL(3u, parser.max_value_count());
+        VERIFY_EQUAL(12u, parser.max_total_value_length());
+
+        VerifyParseResult(parser.parse({ TEXT("abc"), TEXT("-Multi"), TEXT("1,2,3") }), parser);
+        VERIFY_EQUAL(3u, multi.size());
+
+        // A value for a named argument in a separate token counts as well.
+        auto result = parser.parse({ TEXT("abc"), TEXT("-Multi"), TEXT("1"), TEXT("-Multi"), TEXT("2") });
+        VerifyParseResult(result, parser, parse_error::too_many_tokens);
+        VERIFY_EQUAL(TEXT("The command line contains more arguments than are allowed."), result.get_error_message());
+
+        result = parser.parse({ TEXT("abcdef") });
+        VerifyParseResult(result, parser, parse_error::value_too_long, TEXT("Text"));
+        VERIFY_EQUAL(TEXT("The value provided for the argument 'Text' is too long."), result.get_error_message());
+
+        // The count is checked before any of the values are converted.
+        VerifyParseResult(parser.parse({ TEXT("-Multi:1,2"), TEXT("-Multi:3,x") }), parser, parse_error::too_many_values, TEXT("Multi"));
+        VERIFY_EQUAL(2u, multi.size());
+        VerifyParseResult(parser.parse({ TEXT("-Switch"), TEXT("-Switch"), TEXT("-Switch"), TEXT("-Switch") }), parser,
+            parse_error::too_many_values, TEXT("Switch"));
+
+        VerifyParseResult(parser.parse({ TEXT("abcde"), TEXT("-Multi:1,2"), TEXT("-Multi:12345") }), parser, parse_error::total_value_length_exceeded, TEXT("Multi"));
+
+        // Values from files and streams.
+        auto path = std::filesystem::temp_directory_path() / "ookii_limits_test.txt";
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "1\n2\n" << std::string(100000, '3') << "\n4\n";
+        }
+
+        tstring file_value;
+        std::vector<int> stream_values;
+        auto parser2 = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .max_value_length(1000)
+            .max_value_count(3)
+            .add_argument(file_value, TEXT("File")).allow_value_from_file()
+            .add_multi_value_argument(stream_values, TEXT("Stream")).values_from_stream()
+            .build();
+
+        auto file_name = path.string<tchar_t>();
+        auto at_file = TEXT("@") + file_name;
+        VerifyParseResult(parser2.parse({ TEXT("-File"), at_file.c_str() }), parser2, parse_error::value_too_long, TEXT("File"));
+        VerifyParseResult(parser2.parse({ TEXT("-Stream"), file_name.c_str() }), parser2, parse_error::value_too_long, TEXT("Stream"));
+        VERIFY_EQUAL(2u, stream_values.size());
+
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "1\n2\n3\n4\n";
+        }
+
+        VerifyParseResult(parser2.parse({ TEXT("-Stream"), file_name.c_str() }), parser2, parse_error::too_many_values, TEXT("Stream"));
+        VERIFY_EQUAL(3u, stream_values.size());
+        std::filesystem::remove(path);
+
+        // The total limit alone also stops reading a value that never ends.
+        std::vector<tstring> endless_values;
+        auto parser3 = basic_parser_builder<tchar_t>{TEXT("TestCommand")}
+            .max_total_value_length(100000)
+            .add_multi_value_argument(endless_values, TEXT("Stream")).values_from_stream()
+            .build();
+
+        EndlessStreambuf endless;
+        auto old_input = std::cin.rdbuf(&endless);
+        ookii::details::scope_exit restore{[old_input]() { std::cin.rdbuf(old_input); }};
+        VerifyParseResult(parser3.parse({ TEXT("-Stream"), TEXT("-") }), parser3, parse_error::total_value_length_exceeded, TEXT("Stream"));
+    }
+
 private:
+    // A stream that returns the same character forever.
+    class EndlessStreambuf : public std::streambuf
+    {
+    public:
+        EndlessStreambuf()
+        {
+            std::fill(std::begin(_block), std::end(_block), 'x');
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            setg(_block, _block, std::end(_block));
+            return traits_type::to_int_type(_block[0]);
+        }
+
+    private:
+        char _block[4096];
+    };
+
+    static void SetEnvVar(const char *name, const char *value)
+    {
+#ifdef _WIN32
+        _putenv_s(name, value == nullptr ? "" : value);
+#else
+        if (value == nullptr)
+        {
+            unsetenv(name);
+        }
+        else
+        {
+            setenv(name, value, 1);
+        }
+#endif
+    }
+
     static void VerifyArgument(const basic_command_line_parser<tchar_t> &parser, const tstring &name, bool required, bool is_switch, bool multi_value, std::optional<size_t> position)
     {
         const auto &arg = *parser.get_argument(name);
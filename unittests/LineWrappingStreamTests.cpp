@@ -2,6 +2,17 @@
 #include "framework.h"
 #include "unicode.h"
 #include <ookii/line_wrapping_stream.h>
+#include <filesystem>
+#include <fstream>
+#ifndef _WIN32
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
 using namespace std;
 using namespace ookii;
 
@@ -46,6 +57,13 @@ public:
         VERIFY_EQUAL(c_noSpaceWrapResult, stream.str());
     }
 
+    TEST_METHOD(TestWrappingOtherWhiteSpace)
+    {
+        tline_wrapping_ostringstream stream{10};
+        stream << TEXT("abcde\tfghij\vklmno") << endl;
+        VERIFY_EQUAL(TEXT("abcde\nfghij\nklmno\n"), stream.str());
+    }
+
     TEST_METHOD(TestIndentNoSpace)
     {
         tline_wrapping_ostringstream stream{40};
@@ -120,6 +138,82 @@ public:
         VERIFY_EQUAL(c_blankLineIndentResult, stream.str());
     }
 
+    TEST_METHOD(TestBulkWrite)
+    {
+        // Writing character by character uses overflow(), while writing strings uses xsputn(),
+        // and both must produce the same result, regardless of what's already in the buffer.
+        tline_wrapping_ostringstream expected{40};
+        tline_wrapping_ostringstream actual{40};
+        expected << set_indent(4);
+        actual << set_indent(4);
+        for (auto prefix : { tstring_view{}, tstring_view{TEXT("abc ")}, tstring_view{TEXT("abc\n")} })
+        {
+            for (auto input : { c_input, c_blankLineInput, c_noSpaceInput, c_inputFormatting })
+            {
+                for (auto ch : prefix)
+                {
+                    expected.put(ch);
+                    actual.put(ch);
+                }
+
+                for (auto ch : input)
+                {
+                    expected.put(ch);
+                }
+
+                actual.write(input.data(), input.size());
+            }
+        }
+
+        expected << ookii::flush(true);
+        actual << ookii::flush(true);
+        VERIFY_EQUAL(expected.str(), actual.str());
+    }
+
+    TEST_METHOD(TestLongInput)
+    {
+        // A long string with no white space must be broken at the maximum line length.
+        constexpr size_t lineCount = 25000;
+        tstring input(lineCount * 40, TEXT('a'));
+        tline_wrapping_ostringstream stream{40};
+        stream << TEXT("x ") << input << endl;
+        auto result = stream.str();
+        VERIFY_EQUAL((lineCount + 1) * 41 - 39, result.size());
+        VERIFY_EQUAL(TEXT("x\naaaa"), result.substr(0, 6));
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            VERIFY_EQUAL(TEXT('\n'), result[2 + i * 41 + 40]);
+        }
+
+        // A long VT sequence must be kept intact and not counted.
+        tstring sequence = TEXT("\x1b]0;") + tstring(1000000, TEXT('b')) + TEXT("\x1b\\");
+        tline_wrapping_ostringstream vtStream{40};
+        vtStream << TEXT("abc ") << sequence << TEXT("def ghi") << sequence << TEXT("\n");
+        VERIFY_EQUAL(TEXT("abc ") + sequence + TEXT("def ghi") + sequence + TEXT("\n"), vtStream.str());
+    }
+
+    TEST_METHOD(TestChangeMaxLineLength)
+    {
+        tline_wrapping_ostringstream stream{40};
+        stream << TEXT("Lorem ipsum dolor sit amet, consectetur adipiscing ") << flush;
+        VERIFY_EQUAL(TEXT("Lorem ipsum dolor sit amet, consectetur\n"), stream.str());
+
+        // The unfinished line is wrapped using the new length.
+        stream.max_line_length(10);
+        VERIFY_EQUAL(TEXT("Lorem ipsum dolor sit amet, consectetur\nadipiscing\n"), stream.str());
+        stream << TEXT("elit sed do") << endl;
+        VERIFY_EQUAL(TEXT("Lorem ipsum dolor sit amet, consectetur\nadipiscing\nelit sed\ndo\n"), stream.str());
+
+        // Removing the limit writes the unfinished line without a line break.
+        stream << set_indent(2) << TEXT("abc def ghi jkl") << flush;
+        stream.max_line_length(0);
+        stream << TEXT(" mno pqr") << endl << TEXT("stu") << endl;
+        VERIFY_EQUAL(TEXT("Lorem ipsum dolor sit amet, consectetur\nadipiscing\nelit sed\ndo\n  abc def\n  ghi jkl mno pqr\n  stu\n"), stream.str());
+
+        // The length doesn't change for streams that don't use the console width.
+        VERIFY_FALSE(stream.update_console_width());
+    }
+
     TEST_METHOD(TestDestructor)
     {
         tstringstream inner;
@@ -131,7 +225,154 @@ public:
         VERIFY_EQUAL(c_wrapResult, inner.str());
     }
 
+#ifndef _WIN32
+    TEST_METHOD(TestFdStreambuf)
+    {
+        auto path = filesystem::temp_directory_path() / "ookii_fd_streambuf_test.txt";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        VERIFY_TRUE(fd >= 0);
+        string long_text(100, 'x');
+        {
+            fd_streambuf buffer{fd, 16};
+            ostream stream{&buffer};
+            stream << "hello " << 42;
+
+            // Nothing is written until the buffer is full or flushed.
+            VERIFY_EQUAL(0u, filesystem::file_size(path));
+
+            // Writes that don't fit in the buffer are written together with the buffer.
+            stream << long_text;
+            VERIFY_EQUAL(108u, filesystem::file_size(path));
+            stream << '!';
+        }
+
+        {
+            auto stream = line_wrapping_ostream::for_fd(fd);
+            stream.max_line_length(40);
+            stream << set_indent(2) << c_input;
+        }
+
+        close(fd);
+        string contents;
+        {
+            ifstream file{path};
+            contents.assign(istreambuf_iterator<char>{file}, istreambuf_iterator<char>{});
+        }
+
+        filesystem::remove(path);
+        line_wrapping_ostringstream expected{40};
+        expected << set_indent(2) << c_input;
+        expected.flush(true);
+        VERIFY_EQUAL("hello 42" + long_text + "!" + expected.str(), contents);
+    }
+
+    TEST_METHOD(TestConsoleWidthCacheInvalidate)
+    {
+        TestTerminal terminal{100};
+        console_width_cache::invalidate();
+        VERIFY_EQUAL(100, console_width_cache::width());
+
+        // The old width is used until the cache is invalidated.
+        terminal.resize(120);
+        VERIFY_EQUAL(100, console_width_cache::width());
+        console_width_cache::invalidate();
+        VERIFY_EQUAL(120, console_width_cache::width());
+    }
+
+    TEST_METHOD(TestConsoleWidthCachePollInterval)
+    {
+        TestTerminal terminal{100};
+        console_width_cache::invalidate();
+        VERIFY_EQUAL(100, console_width_cache::width());
+        console_width_cache::poll_interval(chrono::milliseconds{500});
+        terminal.resize(120);
+        VERIFY_EQUAL(100, console_width_cache::width());
+        this_thread::sleep_for(chrono::milliseconds{600});
+        VERIFY_EQUAL(120, console_width_cache::width());
+    }
+
+    TEST_METHOD(TestConsoleWidthCacheWatchResize)
+    {
+        TestTerminal terminal{100};
+
+        // A handler that was installed before must still be called.
+        s_previousHandlerCalled = 0;
+        struct sigaction action{};
+        action.sa_sigaction = [](int, siginfo_t *info, void *)
+        {
+            s_previousHandlerCalled = info != nullptr && info->si_signo == SIGWINCH ? 1 : -1;
+        };
+
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_SIGINFO;
+        struct sigaction old_action{};
+        VERIFY_EQUAL(0, sigaction(SIGWINCH, &action, &old_action));
+
+        // This also removes the handler installed by watch_resize(), so later tests see the
+        // signal disposition they started with.
+        ookii::details::scope_exit restore{[&old_action]() { sigaction(SIGWINCH, &old_action, nullptr); }};
+
+        VERIFY_TRUE(console_width_cache::watch_resize());
+        console_width_cache::invalidate();
+        VERIFY_EQUAL(100, console_width_cache::width());
+
+        // The process doesn't own the terminal, so it won't send the signal itself.
+        terminal.resize(120);
+        VERIFY_EQUAL(100, console_width_cache::width());
+        VERIFY_EQUAL(0, raise(SIGWINCH));
+        VERIFY_EQUAL(120, console_width_cache::width());
+        VERIFY_EQUAL(1, static_cast<int>(s_previousHandlerCalled));
+    }
+#endif
+
 private:
+#ifndef _WIN32
+    // Replaces the standard output with a pseudo terminal, so the console width can be controlled.
+    class TestTerminal
+    {
+    public:
+        TestTerminal(unsigned short columns)
+        {
+            _master = posix_openpt(O_RDWR | O_NOCTTY);
+            VERIFY_TRUE(_master >= 0);
+            VERIFY_EQUAL(0, grantpt(_master));
+            VERIFY_EQUAL(0, unlockpt(_master));
+            _slave = open(ptsname(_master), O_RDWR | O_NOCTTY);
+            VERIFY_TRUE(_slave >= 0);
+            resize(columns);
+            tcout.flush();
+            _stdout = dup(STDOUT_FILENO);
+            dup2(_slave, STDOUT_FILENO);
+        }
+
+        ~TestTerminal()
+        {
+            dup2(_stdout, STDOUT_FILENO);
+            close(_stdout);
+            close(_slave);
+            close(_master);
+            console_width_cache::poll_interval(chrono::milliseconds{0});
+            console_width_cache::invalidate();
+        }
+
+        void resize(unsigned short columns)
+        {
+            winsize size{};
+            size.ws_row = 24;
+            size.ws_col = columns;
+            VERIFY_EQUAL(0, ioctl(_master, TIOCSWINSZ, &size));
+        }
+
+    private:
+        int _master{-1};
+        int _slave{-1};
+        int _stdout{-1};
+    };
+
+    static inline volatile sig_atomic_t s_previousHandlerCalled{};
+#endif
+
+
     void TestWrite(tstring_view input, tstring_view expected, size_t max_length, size_t indent)
     {
         tline_wrapping_ostringstream stream{max_length};
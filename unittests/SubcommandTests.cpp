@@ -1,11 +1,42 @@
 #include "common.h"
 #include "framework.h"
 #include <ookii/command_line.h>
+#include <ookii/command_shell.h>
+#include <ookii/thread_pool.h>
+#include <thread>
 #include "custom_types.h"
 #include "command_types.h"
+#ifndef _WIN32
+#include <ookii/command_host.h>
+#include <ookii/command_plugin.h>
+#include <dlfcn.h>
+#endif
+#ifndef _UNICODE
+// Types used by the code generated by New-Subcommand.ps1 in scripts/tests/input/expected.
+#include <ookii/command_line_generated.h>
+#include "subcommand.h"
+#include "subcommand2.h"
+#endif
 using namespace std;
 using namespace ookii;
 
+#ifndef _UNICODE
+int my_command::run()
+{
+    return __test__arg2__;
+}
+
+int other_command::run()
+{
+    return _some_arg;
+}
+
+int third_command::run()
+{
+    return _other_arg;
+}
+#endif
+
 class SubcommandTests : public test::TestClass
 {
 public:
@@ -170,6 +201,656 @@ public:
         VERIFY_EQUAL(TEXT("Hello"), actual->Value);
     }
 
+    TEST_METHOD(TestCommandTable)
+    {
+        using entry = command_table_entry<tchar_t>;
+        static constexpr entry table[] = {
+            entry::create<Command2>(TEXT("AnotherCommand"), TEXT("This is a very long description that probably needs to be wrapped.")),
+            entry::create<Command1>(TEXT("Command1")),
+            entry::create<CustomParsingCommand>(TEXT("CustomParsingCommand")),
+            entry::create<Command3>(TEXT("LastCommand"), TEXT("Foo")),
+        };
+
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager.add_command_table(table);
+        VERIFY_THROWS(manager.add_command_table(table), std::logic_error);
+
+        // Case insensitive binary search.
+        auto info = manager.get_command(TEXT("lastcommand"));
+        VERIFY_NOT_NULL(info);
+        VERIFY_EQUAL(TEXT("LastCommand"), info->name());
+        VERIFY_EQUAL(TEXT("Foo"), info->description());
+        VERIFY_FALSE(info->use_custom_argument_parsing());
+        VERIFY_TRUE(info == manager.get_command(TEXT("LastCommand")));
+        VERIFY_NULL(manager.get_command(TEXT("Command2")));
+        VERIFY_NULL(manager.get_command(TEXT("ZZZ")));
+
+        auto result = run_command(manager, { TEXT("AnotherCommand"), TEXT("-Value"), TEXT("42") });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(42, *result);
+
+        auto command = create_command(manager, { TEXT("CustomParsingCommand"), TEXT("Hello") });
+        VERIFY_NOT_NULL(command);
+        VERIFY_EQUAL(TEXT("Hello"), static_cast<CustomParsingCommand*>(command.get())->Value);
+
+        // Enumerating loads the remaining commands, merged with the ones added normally.
+        manager.add_command<Command3>(TEXT("ExtraCommand"));
+        std::vector<tstring> names;
+        for (const auto &command : manager.commands())
+        {
+            names.push_back(command.name());
+        }
+
+        std::vector<tstring> expected{ TEXT("AnotherCommand"), TEXT("Command1"), TEXT("CustomParsingCommand"), TEXT("ExtraCommand"), TEXT("LastCommand") };
+        VERIFY_RANGE_EQUAL(expected, names);
+
+        // A command added using add_command() replaces the table entry with the same name, even
+        // if the entry was already used.
+        manager.add_command<Command1>(TEXT("LastCommand"), TEXT("Replaced"));
+        VERIFY_EQUAL(TEXT("Replaced"), manager.get_command(TEXT("lastcommand"))->description());
+        names.clear();
+        tstring last_description;
+        for (const auto &command : manager.commands())
+        {
+            names.push_back(command.name());
+            last_description = command.description();
+        }
+
+        VERIFY_RANGE_EQUAL(expected, names);
+        VERIFY_EQUAL(TEXT("Replaced"), last_description);
+
+        // The table must be sorted using the manager's comparison.
+        static constexpr entry unsorted[] = {
+            entry::create<Command1>(TEXT("b")),
+            entry::create<Command3>(TEXT("A")),
+        };
+
+        basic_command_manager<tchar_t> manager2{TEXT("TestApp")};
+        VERIFY_THROWS(manager2.add_command_table(unsorted), std::invalid_argument);
+        manager2.add_command_table(std::span{unsorted + 1, 1});
+        VERIFY_NOT_NULL(manager2.get_command(TEXT("a")));
+    }
+
+    TEST_METHOD(TestGeneratedCommandTable)
+    {
+#ifndef _UNICODE
+        // register_commands() is generated with -CommandTable, and throws if the generated table
+        // isn't sorted the way the manager expects.
+        auto manager = ookii::register_commands("TestApp");
+        auto info = manager.get_command("NAME");
+        VERIFY_NOT_NULL(info);
+        VERIFY_EQUAL("name"s, info->name());
+        VERIFY_EQUAL("Description of the command with a line break.\n\nAnd a paragraph."s, info->description());
+        VERIFY_NOT_NULL(manager.get_command("third_command"));
+        VERIFY_NULL(manager.get_command("other_command"));
+
+        std::vector<std::string> names;
+        for (const auto &command : manager.commands())
+        {
+            names.push_back(command.name());
+        }
+
+        std::vector<std::string> expected{ "name", "third_command" };
+        VERIFY_RANGE_EQUAL(expected, names);
+
+        auto result = run_command(manager, { "name", "foo", "5" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(5, *result);
+
+        // The command inherits the parser options set by other_command's constructor.
+        result = run_command(manager, { "third_command", "-_other_arg=7" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(7, *result);
+#endif
+    }
+
+    TEST_METHOD(TestNestedCommands)
+    {
+        int leaf_registrations = 0;
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager
+            .common_help_argument(TEXT("-Help"))
+            .add_command<Command1>()
+            .add_parent_command(TEXT("Parent"), TEXT("Parent description."), [&](basic_command_manager<tchar_t> &children)
+                {
+                    children
+                        .add_command<Command3>(TEXT("Child"))
+                        .add_parent_command(TEXT("Nested"), TEXT("Nested description."), [&](basic_command_manager<tchar_t> &leaves)
+                            {
+                                ++leaf_registrations;
+                                leaves
+                                    .add_command<Command2>()
+                                    .add_command<CustomParsingCommand>();
+                            });
+                })
+            .add_parent_command(TEXT("Unused"), {}, [](auto &)
+                {
+                    VERIFY_FALSE(true);
+                });
+
+        auto info = manager.get_command(TEXT("parent"));
+        VERIFY_NOT_NULL(info);
+        VERIFY_TRUE(info->is_parent_command());
+        VERIFY_FALSE(manager.get_command(TEXT("Command1"))->is_parent_command());
+        VERIFY_NULL(manager.get_child_manager(*manager.get_command(TEXT("Command1"))));
+
+        // The child manager is only created once.
+        auto child = manager.get_child_manager(*info);
+        VERIFY_NOT_NULL(child);
+        VERIFY_TRUE(child == manager.get_child_manager(*info));
+        VERIFY_EQUAL(TEXT("TestApp Parent"), child->application_name());
+        VERIFY_EQUAL(TEXT("Parent description."), child->description());
+        VERIFY_EQUAL(TEXT("-Help"), child->common_help_argument());
+        VERIFY_EQUAL(0, leaf_registrations);
+
+        auto result = run_command(manager, { TEXT("parent"), TEXT("nested"), TEXT("AnotherCommand"), TEXT("-Value"), TEXT("42") });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(42, *result);
+        VERIFY_EQUAL(1, leaf_registrations);
+
+        auto command = create_command(manager, { TEXT("Parent"), TEXT("Nested"), TEXT("CustomParsingCommand"), TEXT("Hello") });
+        VERIFY_NOT_NULL(command);
+        VERIFY_EQUAL(TEXT("Hello"), static_cast<CustomParsingCommand*>(command.get())->Value);
+        VERIFY_EQUAL(1, leaf_registrations);
+
+        command = create_command(manager, { TEXT("Parent"), TEXT("Child") });
+        VERIFY_NOT_NULL(command);
+        VERIFY_NOT_NULL(dynamic_cast<Command3*>(command.get()));
+
+        // A parent command without a child, or with an unknown child, shows the child commands.
+        tline_wrapping_ostringstream output{0};
+        basic_usage_writer<tchar_t> usage{output};
+        VERIFY_NULL(create_command(manager, { TEXT("Parent"), TEXT("Nested") }, &usage));
+        VERIFY_EQUAL(c_nestedUsageExpected, output.str());
+        output.str({});
+        VERIFY_NULL(create_command(manager, { TEXT("Parent"), TEXT("Nested"), TEXT("Foo") }, &usage));
+        VERIFY_EQUAL(c_nestedUsageExpected, output.str());
+
+        VERIFY_THROWS(manager.add_parent_command(TEXT("Parent"), {}, [](auto &) {}), std::logic_error);
+    }
+
+    TEST_METHOD(TestCommandShell)
+    {
+        ShellCommand::CreateCount = 0;
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager
+            .add_command<ShellCommand>(TEXT("Shell"))
+            .add_parent_command(TEXT("Parent"), {}, [](basic_command_manager<tchar_t> &children)
+                {
+                    children
+                        .add_command<Command2>()
+                        .add_command<CustomParsingCommand>();
+                });
+
+        tline_wrapping_ostringstream output{0};
+        basic_usage_writer<tchar_t> usage{output};
+        basic_command_shell<tchar_t> shell{manager, &usage};
+        auto result = shell.run_line(TEXT("Shell 'first name' -Value 5 -Item 1 -Item 2"));
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(7, *result);
+
+        // The same command object is used again, and arguments that aren't supplied get their
+        // initial values back.
+        result = shell.run_line(TEXT("shell -Item 3"));
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(101, *result);
+        VERIFY_EQUAL(1, ShellCommand::CreateCount);
+
+        result = shell.run_line(TEXT("Parent AnotherCommand -Value 42"));
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(42, *result);
+        result = shell.run_line(TEXT("Parent CustomParsingCommand \"a b\""));
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(0, *result);
+
+        // Errors don't remove the command from the cache.
+        VERIFY_FALSE(shell.run_line(TEXT("Parent AnotherCommand")));
+        VERIFY_FALSE(shell.run_line(TEXT("Unknown")));
+        VERIFY_FALSE(shell.run_line(TEXT("Shell 'unterminated")));
+        VERIFY_FALSE(shell.run_line(TEXT("  ")));
+        VERIFY_EQUAL(7u, shell.history().size());
+        VERIFY_EQUAL(TEXT("Shell 'unterminated"), shell.history().back());
+
+        shell.clear_cache();
+        result = shell.run_line(TEXT("Shell"));
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(100, *result);
+        VERIFY_EQUAL(2, ShellCommand::CreateCount);
+
+        // Lines with an open quote continue on the next line, and the exit command stops reading.
+        tstringstream input{TEXT("\nShell -Value 'x\ny'\nShell -Value \\\n3\nexit\nShell -Value 4\n")};
+        output.str({});
+        shell.prompt({});
+        shell.max_history(2);
+        result = shell.run(input);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(3, *result);
+        VERIFY_EQUAL(2u, shell.history().size());
+        VERIFY_EQUAL(TEXT("Shell -Value 'x\ny'"), shell.history().front());
+    }
+
+    TEST_METHOD(TestRunCommandAsync)
+    {
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager
+            .add_command<AsyncCommand>()
+            .add_command<Command2>();
+
+        // Async commands can still be run synchronously.
+        auto result = run_command(manager, { TEXT("AsyncCommand"), TEXT("-Value"), TEXT("5") });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(10, *result);
+
+        thread_pool pool{2};
+        VERIFY_EQUAL(2u, pool.thread_count());
+        const tchar_t *async_args[] = { TEXT("AsyncCommand"), TEXT("-Value"), TEXT("21") };
+        const tchar_t *sync_args[] = { TEXT("AnotherCommand"), TEXT("-Value"), TEXT("7") };
+        std::vector<task<std::optional<int>>> tasks;
+        for (int i = 0; i < 10; ++i)
+        {
+            tasks.push_back(manager.run_command_async(pool, i % 2 == 0 ? async_args : sync_args));
+            tasks.back().start();
+        }
+
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            result = tasks[i].get();
+            VERIFY_NOT_NULL(result);
+            VERIFY_EQUAL(i % 2 == 0 ? 42 : 7, *result);
+        }
+
+        // The command runs on the executor.
+        auto command = create_command(manager, { TEXT("AsyncCommand"), TEXT("-Value"), TEXT("1") });
+        auto async = static_cast<AsyncCommand*>(command.get());
+        auto run_on_pool = [&]() -> task<int>
+        {
+            co_await resume_on(pool);
+            co_return co_await async->run_async();
+        };
+
+        VERIFY_EQUAL(2, run_on_pool().get());
+        VERIFY_TRUE(std::this_thread::get_id() != async->ThreadId);
+
+        // Errors creating the command produce std::nullopt, and exceptions are propagated.
+        tline_wrapping_ostringstream output{0};
+        basic_usage_writer<tchar_t> usage{output};
+        const tchar_t *invalid_args[] = { TEXT("AsyncCommand") };
+        VERIFY_FALSE(manager.run_command_async(pool, invalid_args, &usage).get());
+        const tchar_t *negative_args[] = { TEXT("AsyncCommand"), TEXT("-Value"), TEXT("-1") };
+        auto failing = manager.run_command_async(pool, negative_args);
+        VERIFY_THROWS(failing.get(), std::invalid_argument);
+    }
+
+    TEST_METHOD(TestRunScript)
+    {
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager.add_command<EchoCommand>();
+        thread_pool pool{4};
+        tstringstream output;
+        tstringstream error;
+        auto &cout = console_stream<tchar_t>::cout();
+        auto &cerr = console_stream<tchar_t>::cerr();
+        auto old_output = cout.rdbuf(output.rdbuf());
+        auto old_error = cerr.rdbuf(error.rdbuf());
+        ookii::details::scope_exit restore{[&]()
+            {
+                cout.rdbuf(old_output);
+                cerr.rdbuf(old_error);
+            }};
+
+        // Output is written in the order of the script, even if commands finish in another order.
+        tstringstream script{TEXT("# Comment\n\nEcho first -Delay 50\n  Echo 'second\nline'\nEcho third -Delay 10\n")};
+        auto result = manager.run_script(pool, script);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(0, *result);
+        VERIFY_EQUAL(TEXT("first\nsecond\nline\nthird\n"), output.str());
+
+        // With fail fast, the output after the failed command is discarded.
+        output.str({});
+        script = tstringstream{TEXT("Echo one -Delay 20\nEcho two -ExitCode 3\nEcho three\nEcho four -ExitCode 4\n")};
+        result = manager.run_script(pool, script);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(3, *result);
+        VERIFY_EQUAL(TEXT("one\n"), output.str());
+        VERIFY_EQUAL(TEXT("two\n"), error.str());
+
+        output.str({});
+        error.str({});
+        script = tstringstream{TEXT("Echo one -Delay 20\nEcho two -ExitCode 3\nEcho three\nEcho four -ExitCode 4\n")};
+        result = manager.run_script(pool, script, false);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(3, *result);
+        VERIFY_EQUAL(TEXT("one\nthree\n"), output.str());
+        VERIFY_EQUAL(TEXT("two\nfour\n"), error.str());
+
+        // Nothing runs if a line has an error.
+        output.str({});
+        tline_wrapping_ostringstream usage_output{0};
+        basic_usage_writer<tchar_t> usage{usage_output};
+        script = tstringstream{TEXT("Echo one\nEcho\n")};
+        VERIFY_FALSE(manager.run_script(pool, script, true, &usage));
+        VERIFY_EQUAL(TEXT(""), output.str());
+        VERIFY_TRUE(usage_output.str().ends_with(TEXT("The script was not run because of an error in line 2.\n\n")));
+
+        usage_output.str({});
+        script = tstringstream{TEXT("Echo 'one\n")};
+        VERIFY_FALSE(manager.run_script(pool, script, true, &usage));
+        VERIFY_EQUAL(TEXT("The command line contains an unterminated quote.\n\nThe script was not run because of an error in line 1.\n\n"),
+            usage_output.str());
+
+        script = tstringstream{TEXT("Echo one\nEcho two -Throw\n")};
+        VERIFY_THROWS(manager.run_script(pool, script), std::runtime_error);
+        VERIFY_TRUE(cout.rdbuf() == output.rdbuf());
+
+        // Lines run one at a time unless they end with '&', and 'wait' waits for the commands
+        // before it.
+        output.str({});
+        EchoCommand::MaxRunning = 0;
+        script = tstringstream{TEXT("Echo one -Delay 20\nEcho two -Delay 20\nEcho three\n")};
+        result = manager.run_script(pool, script);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(0, *result);
+        VERIFY_EQUAL(1, EchoCommand::MaxRunning.load());
+
+        output.str({});
+        EchoCommand::MaxRunning = 0;
+        script = tstringstream{TEXT("Echo one -Delay 100 &\nEcho two -Delay 100 &\nwait\nEcho three -Delay 20 &\nEcho '&'\nEcho \\&\n")};
+        result = manager.run_script(pool, script);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(0, *result);
+        VERIFY_EQUAL(2, EchoCommand::MaxRunning.load());
+        VERIFY_EQUAL(TEXT("one\ntwo\nthree\n&\n&\n"), output.str());
+
+        // A command that must wait isn't started after a concurrent command fails.
+        output.str({});
+        error.str({});
+        script = tstringstream{TEXT("Echo one -Delay 50 -ExitCode 2 &\nEcho two\nEcho three\n")};
+        result = manager.run_script(pool, script);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(2, *result);
+        VERIFY_EQUAL(TEXT(""), output.str());
+        VERIFY_EQUAL(TEXT("one\n"), error.str());
+    }
+
+    TEST_METHOD(TestConcurrentCreateCommand)
+    {
+        using entry = command_table_entry<tchar_t>;
+        static constexpr entry table[] = {
+            entry::create<Command2>(TEXT("AnotherCommand")),
+            entry::create<Command1>(TEXT("Command1")),
+            entry::create<CustomParsingCommand>(TEXT("CustomParsingCommand")),
+        };
+
+        std::atomic<int> leaf_registrations{};
+        basic_command_manager<tchar_t> manager{TEXT("TestApp")};
+        manager
+            .configure_parser([](auto &parser) { parser.mode(parsing_mode::long_short); })
+            .add_command_table(table)
+            .add_command<Command3>(TEXT("ExtraCommand"))
+            .add_parent_command(TEXT("Parent"), {}, [&](basic_command_manager<tchar_t> &children)
+                {
+                    ++leaf_registrations;
+                    children.add_command<Command2>();
+                });
+
+        // Nothing is loaded yet, so all the threads race to load the table entries, the child
+        // manager and the command list.
+        constexpr int thread_count = 8;
+        constexpr int iterations = 200;
+        std::atomic<int> failures{};
+        std::vector<tstring> usage_text(thread_count);
+        std::vector<std::thread> threads;
+        for (int index = 0; index < thread_count; ++index)
+        {
+            threads.emplace_back([&, index]()
+                {
+                    tline_wrapping_ostringstream output{0};
+                    basic_usage_writer<tchar_t> usage{output};
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        auto number = to_string(index * iterations + i);
+                        tstring value{number.begin(), number.end()};
+                        auto result = run_command(manager, { TEXT("anothercommand"), TEXT("--value"), value.c_str() }, &usage);
+                        if (!result || *result != index * iterations + i)
+                            ++failures;
+
+                        result = run_command(manager, { TEXT("Parent"), TEXT("AnotherCommand"), TEXT("--value"), value.c_str() }, &usage);
+                        if (!result || *result != index * iterations + i)
+                            ++failures;
+
+                        auto command = create_command(manager, { TEXT("CustomParsingCommand"), value.c_str() }, &usage);
+                        if (!command || static_cast<CustomParsingCommand*>(command.get())->Value != value)
+                            ++failures;
+
+                        if (manager.get_command(TEXT("Command1")) != manager.get_command(TEXT("command1")))
+                            ++failures;
+
+                        int count = 0;
+                        for (const auto &info : manager.commands())
+                        {
+                            count += info.name().empty() ? 0 : 1;
+                        }
+
+                        if (count != 5)
+                            ++failures;
+
+                        output.str({});
+                        manager.write_usage(&usage);
+                        if (i == 0)
+                            usage_text[index] = output.str();
+                        else if (output.str() != usage_text[index])
+                            ++failures;
+                    }
+                });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        VERIFY_EQUAL(0, failures.load());
+        VERIFY_EQUAL(1, leaf_registrations.load());
+        for (const auto &text : usage_text)
+        {
+            VERIFY_EQUAL(usage_text[0], text);
+        }
+
+        VERIFY_TRUE(usage_text[0].find(TEXT("    ExtraCommand\n")) != tstring::npos);
+    }
+
+#ifndef _WIN32
+    TEST_METHOD(TestCommandHost)
+    {
+        auto socket_path = filesystem::temp_directory_path() / ("ookii_host_test_" + to_string(getpid()) + ".sock");
+        basic_command_manager<char> manager{"TestApp"};
+        manager.add_command<Command2>();
+        optional<command_host> host{in_place, manager, socket_path};
+        host->request_timeout(200ms);
+        thread runner{[&host]() { host->run(); }};
+
+        int output[2];
+        VERIFY_EQUAL(0, pipe(output));
+        // The client runs in a new process, because a command running in the host process
+        // replaces environ, which the client reads.
+        auto run = [&](std::initializer_list<const char *> args, int input = STDIN_FILENO) -> optional<int>
+        {
+            vector<const char *> arguments{args};
+            auto pid = fork();
+            if (pid == 0)
+            {
+                auto exit_code = run_hosted_command(socket_path, static_cast<int>(arguments.size()), arguments.data(), input, output[1], output[1]);
+                _exit(exit_code ? *exit_code : 255);
+            }
+
+            int status;
+            VERIFY_EQUAL(pid, waitpid(pid, &status, 0));
+            VERIFY_TRUE(WIFEXITED(status));
+            if (WEXITSTATUS(status) == 255)
+                return {};
+
+            return WEXITSTATUS(status);
+        };
+
+        auto result = run({ "TestApp", "AnotherCommand", "-Value", "42" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(42, *result);
+
+        // The cached parser is reused.
+        result = run({ "TestApp", "AnotherCommand", "-Value", "43" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(43, *result);
+
+        // A failed command writes usage help to the client's output.
+        result = run({ "TestApp", "Unknown" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(1, *result);
+
+        // A client that stops sending is disconnected, and a request that's too large is rejected,
+        // without blocking other clients.
+        auto address = details::make_socket_address(socket_path);
+        auto connect_raw = [&]()
+        {
+            details::unique_fd connection{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+            VERIFY_EQUAL(0, connect(connection.get(), reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+            return connection;
+        };
+
+        auto stalled = connect_raw();
+        result = run({ "TestApp", "AnotherCommand", "-Value", "44" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(44, *result);
+        char value;
+        VERIFY_EQUAL(0, read(stalled.get(), &value, 1));
+
+        auto oversized = connect_raw();
+        details::host_request_header header{details::c_max_host_request_size + 1, 1, 0};
+        const int fds[details::c_host_fd_count]{STDIN_FILENO, output[1], output[1]};
+        VERIFY_TRUE(details::send_with_fds(oversized.get(), header, fds));
+        VERIFY_EQUAL(0, read(oversized.get(), &value, 1));
+        host->stop();
+        runner.join();
+        host.reset();
+
+        // Commands can also run in a new process.
+        host.emplace(manager, socket_path);
+        host->isolate_commands(true);
+        runner = thread{[&host]() { host->run(); }};
+        result = run({ "TestApp", "AnotherCommand", "-Value", "45" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(45, *result);
+        host->stop();
+        runner.join();
+        host.reset();
+        VERIFY_FALSE(filesystem::exists(socket_path));
+        VERIFY_NULL(run({ "TestApp" }));
+
+        // The command runs with the client's environment and working directory, and the host's
+        // are restored afterwards when it runs in the host process.
+        host.emplace([](int argc, const char *const argv[])
+            {
+                if (argv[1] == "read"sv)
+                {
+                    string input{istreambuf_iterator<char>{cin}, istreambuf_iterator<char>{}};
+                    return static_cast<int>(input.size());
+                }
+
+                cout << argv[1] << ' ' << getenv("OOKII_HOST_TEST") << ' ' << filesystem::current_path().string() << endl;
+                return argc;
+            }, socket_path);
+
+        setenv("OOKII_HOST_TEST", "value", 1);
+        auto environment = environ;
+        runner = thread{[&host]() { host->run(); }};
+        result = run({ "TestApp", "hello" });
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(2, *result);
+
+        // Reaching the end of one client's input doesn't affect the next client.
+        for (int i = 0; i < 2; ++i)
+        {
+            int input[2];
+            VERIFY_EQUAL(0, pipe(input));
+            VERIFY_EQUAL(3, write(input[1], "abc", 3));
+            close(input[1]);
+            result = run({ "TestApp", "read" }, input[0]);
+            close(input[0]);
+            VERIFY_NOT_NULL(result);
+            VERIFY_EQUAL(3, *result);
+        }
+
+        host->stop();
+        runner.join();
+        host.reset();
+        VERIFY_TRUE(environment == environ);
+        unsetenv("OOKII_HOST_TEST");
+
+        close(output[1]);
+        string text;
+        char buffer[1024];
+        ssize_t count;
+        while ((count = read(output[0], buffer, sizeof(buffer))) > 0)
+        {
+            text.append(buffer, static_cast<size_t>(count));
+        }
+
+        close(output[0]);
+        VERIFY_TRUE(text.starts_with("Usage: TestApp <command> [arguments]"));
+        VERIFY_TRUE(text.ends_with("\nhello value " + filesystem::current_path().string() + "\n"));
+    }
+
+    TEST_METHOD(TestPluginCommand)
+    {
+        auto is_loaded = []()
+        {
+            auto library = dlopen(OOKII_TEST_PLUGIN, RTLD_NOW | RTLD_NOLOAD);
+            if (library == nullptr)
+                return false;
+
+            dlclose(library);
+            return true;
+        };
+
+        basic_command_manager<char> manager{"TestApp"};
+        manager
+            .add_command<Command1>()
+            .add_plugin_command("Plugin", "Plugin description.", OOKII_TEST_PLUGIN, "CreatePluginCommand")
+            .add_plugin_command("MissingSymbol", {}, OOKII_TEST_PLUGIN, "Missing")
+            .add_plugin_command("MissingLibrary", {}, "ookii_missing_plugin.so", "CreatePluginCommand");
+
+        VERIFY_THROWS(manager.add_plugin_command("Plugin", {}, OOKII_TEST_PLUGIN, "CreatePluginCommand"), std::logic_error);
+
+        // Listing the commands doesn't load the library.
+        line_wrapping_ostringstream output{0};
+        line_wrapping_ostringstream error{0};
+        basic_usage_writer<char> usage{output, error};
+        manager.write_usage(&usage);
+        VERIFY_TRUE(output.str().find("    Plugin\n        Plugin description.\n") != string::npos);
+        VERIFY_NOT_NULL(manager.get_command("plugin"));
+        VERIFY_FALSE(is_loaded());
+
+        auto result = run_command(manager, { "Plugin", "-Value", "21" }, &usage);
+        VERIFY_NOT_NULL(result);
+        VERIFY_EQUAL(42, *result);
+        VERIFY_TRUE(is_loaded());
+
+        // Usage help of the plugin's arguments works like any other command.
+        output.str({});
+        VERIFY_NULL(run_command(manager, { "Plugin" }, &usage));
+        VERIFY_TRUE(output.str().find("Usage: TestApp Plugin -Value <int>") != string::npos);
+
+        output.str({});
+        error.str({});
+        VERIFY_NULL(run_command(manager, { "MissingSymbol" }, &usage));
+        VERIFY_EQUAL("The command 'MissingSymbol' could not be loaded.\n\n", error.str());
+        VERIFY_EQUAL("", output.str());
+
+        error.str({});
+        VERIFY_NULL(create_command(manager, { "MissingLibrary" }, &usage));
+        VERIFY_EQUAL("The command 'MissingLibrary' could not be loaded.\n\n", error.str());
+    }
+#endif
+
     static std::optional<int> run_command(const basic_command_manager<tchar_t> &manager, std::initializer_list<const tchar_t*> args, basic_usage_writer<tchar_t> *usage = nullptr)
     {
         std::vector<const tchar_t*> arguments{TEXT("Executable")};
@@ -184,6 +865,20 @@ public:
         return manager.create_command(static_cast<int>(arguments.size()), arguments.data(), usage);
     }
 
+    static constexpr tstring_view c_nestedUsageExpected = TEXT(R"(Nested description.
+
+Usage: TestApp Parent Nested <command> [arguments]
+
+The following commands are available:
+
+    AnotherCommand
+        This is a very long description that probably needs to be wrapped.
+
+    CustomParsingCommand
+
+Run 'TestApp Parent Nested <command> -Help' for more information about a command.
+)");
+
     static constexpr tstring_view c_usageExpected = TEXT(R"(Application description.
 
 Usage: TestApp <command> [arguments]
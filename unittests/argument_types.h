@@ -1,6 +1,6 @@
 #pragma once
 
-#include <ookii/command_line.h>
+#include <ookii/command_line_generated.h>
 
 struct UsageArguments
 {
@@ -88,4 +88,4 @@ struct ActionArguments
                 TEXT("Action"))
             .build();
     }
-};
\ No newline at end of file
+};
@@ -68,4 +68,102 @@ public:
     }
 
     ookii::tstring Value{};
-};
\ No newline at end of file
+};
+class ShellCommand : public ookii::basic_command<ookii::tchar_t>
+{
+public:
+    ShellCommand(builder_type &builder)
+    {
+        ++CreateCount;
+        builder
+            .add_argument(Name, TEXT("Name")).positional()
+            .add_argument(Value, TEXT("Value"))
+            .add_multi_value_argument(Items, TEXT("Item"));
+    }
+
+    int run() override
+    {
+        return Value + static_cast<int>(Items.size());
+    }
+
+    static inline int CreateCount{};
+
+    ookii::tstring Name{TEXT("initial")};
+    int Value{100};
+    std::vector<int> Items;
+};
+
+class AsyncCommand : public ookii::basic_async_command<ookii::tchar_t>
+{
+public:
+    AsyncCommand(builder_type &builder)
+    {
+        builder.add_argument(Value, TEXT("Value")).required();
+    }
+
+    ookii::task<int> run_async() override
+    {
+        ThreadId = std::this_thread::get_id();
+        co_return co_await Double(Value);
+    }
+
+    static ookii::task<int> Double(int value)
+    {
+        if (value < 0)
+        {
+            throw std::invalid_argument("negative");
+        }
+
+        co_return value * 2;
+    }
+
+    int Value{};
+    std::thread::id ThreadId;
+};
+
+class EchoCommand : public ookii::basic_command<ookii::tchar_t>
+{
+public:
+    EchoCommand(builder_type &builder)
+    {
+        builder
+            .add_argument(Text, TEXT("Text")).positional().required()
+            .add_argument(ExitCode, TEXT("ExitCode"))
+            .add_argument(Delay, TEXT("Delay"))
+            .add_argument(Throw, TEXT("Throw"));
+    }
+
+    int run() override
+    {
+        auto running = ++Running;
+        auto max = MaxRunning.load();
+        while (running > max && !MaxRunning.compare_exchange_weak(max, running))
+        {
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{Delay});
+        --Running;
+        if (Throw)
+        {
+            throw std::runtime_error("failed");
+        }
+
+        auto &stream = ExitCode == 0 ? ookii::console_stream<ookii::tchar_t>::cout() : ookii::console_stream<ookii::tchar_t>::cerr();
+        stream << Text << std::endl;
+        return ExitCode;
+    }
+
+    static ookii::tstring name()
+    {
+        return TEXT("Echo");
+    }
+
+    ookii::tstring Text;
+    int ExitCode{};
+    int Delay{};
+    bool Throw{};
+
+    // The number of instances running at once, used to check the order of scripts.
+    static inline std::atomic<int> Running{};
+    static inline std::atomic<int> MaxRunning{};
+};
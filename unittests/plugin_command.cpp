@@ -0,0 +1,27 @@
+// A shared library with a command that is loaded by basic_command_manager::add_plugin_command()
+// in SubcommandTests.cpp. The library doesn't share the definitions in console.cpp, so it has its
+// own copy of the platform functions.
+#define OOKII_PLATFORM_DEFINITION
+#include <ookii/command_line.h>
+
+class PluginCommand : public ookii::command
+{
+public:
+    PluginCommand(builder_type &builder)
+    {
+        builder.add_argument(_value, "Value").required();
+    }
+
+    int run() override
+    {
+        return _value * 2;
+    }
+
+private:
+    int _value{};
+};
+
+extern "C" ookii::command *CreatePluginCommand(ookii::parser_builder &builder)
+{
+    return new PluginCommand{builder};
+}